@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "avlbst.h"
+#include "art_map.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// ArtMap against AVLTree on random inserts, lookups and removes, for
+// uint64_t keys and for string keys that share a common prefix.
+//
+// usage: art-bench [keys ...]    (default: 1000000)
+
+template<typename Map, typename Key>
+void run(const string& name, const vector<Key>& keys)
+{
+    Map map;
+    BenchTimer timer;
+    for(size_t i = 0; i < keys.size(); i++) {
+        map.insert(make_pair(keys[i], i));
+    }
+    double insertSeconds = timer.seconds();
+    timer.restart();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < keys.size(); i++) {
+        sum += map.find(keys[i])->second;
+    }
+    double findSeconds = timer.seconds();
+    timer.restart();
+    for(typename Map::iterator it = map.begin(); it != map.end(); ++it) {
+        sum += it->second;
+    }
+    double scanSeconds = timer.seconds();
+    benchSink(sum);
+    timer.restart();
+    for(size_t i = 0; i < keys.size(); i++) {
+        map.remove(keys[i]);
+    }
+    double removeSeconds = timer.seconds();
+
+    cout << keys.size() << " keys\t" << name
+         << "\tinsert " << insertSeconds << " s"
+         << "\tfind " << findSeconds << " s"
+         << "\tscan " << scanSeconds << " s"
+         << "\tremove " << removeSeconds << " s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeUniformKeys<uint64_t>(sizes[s], 0, UINT64_MAX, 1);
+        run<AVLTree<uint64_t, uint64_t> >("avl u64", keys);
+        run<ArtMap<uint64_t, uint64_t> >("art u64", keys);
+
+        vector<string> names;
+        for(size_t i = 0; i < keys.size(); i++) {
+            names.push_back("user:" + to_string(keys[i] % 1000000000000ULL));
+        }
+        run<AVLTree<string, uint64_t> >("avl string", names);
+        run<ArtMap<string, uint64_t> >("art string", names);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include "art_map.h"
+
+using namespace std;
+
+// Checks that a map holds exactly the contents of expected, in order.
+template<typename Map, typename Model>
+bool sameContents(const Map& art, const Model& expected)
+{
+    typename Model::const_iterator exp = expected.begin();
+    for(typename Map::iterator it = art.begin(); it != art.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+// Checks find and lower_bound for key against the model.
+template<typename Map, typename Model, typename Key>
+bool sameLookups(const Map& art, const Model& expected, const Key& key)
+{
+    typename Model::const_iterator exp = expected.lower_bound(key);
+    typename Map::iterator lb = art.lower_bound(key);
+    bool boundOk = exp == expected.end() ? lb == art.end() : (lb != art.end() && lb->first == exp->first);
+    bool found = art.find(key) != art.end();
+    return boundOk && found == (expected.count(key) > 0);
+}
+
+// Random updates on a small key range, so nodes grow and shrink through
+// every size.
+template<typename Key>
+bool randomUpdates(Key (*makeKey)(int), int range, unsigned seed)
+{
+    ArtMap<Key, int> art;
+    map<Key, int> model;
+    srand(seed);
+    bool ok = art.empty() && art.begin() == art.end();
+    for(int i = 0; i < 40000; i++) {
+        Key key = makeKey(rand() % range);
+        int op = rand() % 3;
+        if(op == 0) {
+            art.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else if(op == 1) {
+            art.remove(key);
+            model.erase(key);
+        }
+        else {
+            ok = ok && sameLookups(art, model, key);
+        }
+        if(i % 1000 == 0) {
+            ok = ok && sameContents(art, model);
+        }
+    }
+    ok = ok && sameContents(art, model);
+    while(!model.empty()) {
+        art.remove(model.begin()->first);
+        model.erase(model.begin());
+    }
+    return ok && art.empty() && art.begin() == art.end();
+}
+
+uint64_t spreadKey(int i)
+{
+    // low bytes vary most, high bytes share long prefixes
+    return (uint64_t(i % 7) << 56) | (uint64_t(i) * 2654435761u % 100003);
+}
+
+int signedKey(int i)
+{
+    return i - 500;
+}
+
+string stringKey(int i)
+{
+    // prefixes of each other, and embedded zero bytes
+    string key = "k";
+    for(int j = 0; j < i % 5; j++) {
+        key += char('a' + (i / 5) % 3);
+    }
+    if(i % 11 == 0) {
+        key += '\0';
+    }
+    if(i % 13 == 0) {
+        key += char(0xFF);
+    }
+    return key + to_string(i / 15);
+}
+
+int main(int argc, char *argv[])
+{
+    cout << "Integer keys match: " << randomUpdates<uint64_t>(spreadKey, 100003, 45) << endl;
+    cout << "Signed keys match: " << randomUpdates<int>(signedKey, 1000, 46) << endl;
+    cout << "String keys match: " << randomUpdates<string>(stringKey, 3000, 47) << endl;
+
+    ArtMap<string, int> names;
+    names.insert(make_pair(string("apple"), 1));
+    names.insert(make_pair(string("app"), 2));
+    names.insert(make_pair(string(""), 3));
+    names.insert(make_pair(string("app"), 4));
+    bool threw = false;
+    try {
+        names["ap"];
+    }
+    catch(out_of_range&) {
+        threw = true;
+    }
+    cout << "operator[] and lower_bound: "
+         << (threw && names["app"] == 4 && names[""] == 3
+             && names.lower_bound("apo")->first == "app"
+             && names.lower_bound("appl")->first == "apple"
+             && names.lower_bound("b") == names.end()) << endl;
+    return 0;
+}
@@ -0,0 +1,987 @@
+#ifndef ART_MAP_H
+#define ART_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+* Turns keys into byte strings for the radix tree. The bytes must sort
+* (as unsigned bytes, lexicographically) in the same order as the keys,
+* and no key's bytes may be a prefix of another key's.
+*
+* Integers are stored big-endian with the sign bit flipped, so that all
+* keys of one type have the same length and compare like the numbers.
+*/
+template <typename T>
+struct RadixKey
+{
+    static_assert(std::is_integral<T>::value,
+                  "no RadixKey for this type: specialize RadixKey<T>");
+
+    static void encode(const T& key, std::string& out)
+    {
+        typedef typename std::make_unsigned<T>::type Unsigned;
+        Unsigned bits = static_cast<Unsigned>(key);
+        if (std::is_signed<T>::value)
+        {
+            bits ^= Unsigned(1) << (sizeof(T) * 8 - 1);
+        }
+        for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+        }
+    }
+};
+
+/**
+* Strings end in the two bytes 0x00 0x00, and a zero byte inside the
+* string is written as 0x00 0x01. That keeps the order and makes a
+* string never a prefix of a longer one.
+*/
+template <>
+struct RadixKey<std::string>
+{
+    static void encode(const std::string& key, std::string& out)
+    {
+        for (size_t i = 0; i < key.size(); ++i)
+        {
+            out.push_back(key[i]);
+            if (key[i] == 0)
+            {
+                out.push_back(1);
+            }
+        }
+        out.push_back(0);
+        out.push_back(0);
+    }
+};
+
+/**
+* An ordered map stored as an adaptive radix tree (ART).
+*
+* Keys are turned into byte strings by KeyCodec and the tree branches on
+* one byte per level, so a lookup visits at most one node per key byte
+* whatever the number of keys, and compares the whole key only once, at
+* the leaf. Inner nodes come in four sizes (4, 16, 48 and 256 children)
+* and grow or shrink with their fan-out, so sparse levels stay small.
+* Runs of bytes shared by every key below a node are stored in the node
+* (path compression) instead of as a chain of one-child nodes.
+*
+* The leaves are also linked in key order, which makes iteration a list
+* walk. The interface follows BinarySearchTree.
+*/
+template <typename Key, typename Value, typename KeyCodec = RadixKey<Key> >
+class ArtMap
+{
+private:
+    struct Leaf;
+
+public:
+    ArtMap();
+    ~ArtMap();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    bool empty() const;
+
+    /**
+    * An iterator over the items in key order.
+    */
+    class iterator
+    {
+    public:
+        iterator() : current_(nullptr)
+        {
+
+        }
+
+        std::pair<const Key, Value>& operator*() const
+        {
+            return current_->item_;
+        }
+        std::pair<const Key, Value>* operator->() const
+        {
+            return &current_->item_;
+        }
+
+        bool operator==(const iterator& rhs) const
+        {
+            return current_ == rhs.current_;
+        }
+        bool operator!=(const iterator& rhs) const
+        {
+            return current_ != rhs.current_;
+        }
+
+        iterator& operator++()
+        {
+            current_ = current_->next_;
+            return *this;
+        }
+
+    private:
+        friend class ArtMap<Key, Value, KeyCodec>;
+        explicit iterator(Leaf* leaf) : current_(leaf)
+        {
+
+        }
+
+        Leaf* current_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    Value& operator[](const Key& key);
+    Value const & operator[](const Key& key) const;
+
+private:
+    enum NodeType { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+    struct ArtNode
+    {
+        explicit ArtNode(NodeType type) : type_(type)
+        {
+
+        }
+
+        NodeType type_;
+    };
+
+    struct Leaf : ArtNode
+    {
+        Leaf(const std::string& bytes, const std::pair<const Key, Value>& item) :
+            ArtNode(LEAF), bytes_(bytes), item_(item), prev_(nullptr), next_(nullptr)
+        {
+
+        }
+
+        std::string bytes_;     // the encoded key
+        std::pair<const Key, Value> item_;
+        Leaf* prev_;
+        Leaf* next_;
+    };
+
+    struct Inner : ArtNode
+    {
+        explicit Inner(NodeType type) : ArtNode(type), count_(0)
+        {
+
+        }
+
+        int count_;
+        std::string prefix_;    // bytes shared by every key below, after the parent's branch byte
+    };
+
+    // Node4 and Node16 keep their branch bytes sorted.
+    struct Node4 : Inner
+    {
+        Node4() : Inner(NODE4)
+        {
+
+        }
+
+        uint8_t keys_[4];
+        ArtNode* children_[4];
+    };
+
+    struct Node16 : Inner
+    {
+        Node16() : Inner(NODE16)
+        {
+
+        }
+
+        uint8_t keys_[16];
+        ArtNode* children_[16];
+    };
+
+    // Node48 maps a byte to 1 + the slot of its child, or 0 for none.
+    struct Node48 : Inner
+    {
+        Node48() : Inner(NODE48)
+        {
+            std::memset(index_, 0, sizeof(index_));
+        }
+
+        uint8_t index_[256];
+        ArtNode* children_[48];
+    };
+
+    struct Node256 : Inner
+    {
+        Node256() : Inner(NODE256)
+        {
+            std::memset(children_, 0, sizeof(children_));
+        }
+
+        ArtNode* children_[256];
+    };
+
+    static std::string encode(const Key& key);
+    static ArtNode** findChild(Inner* node, uint8_t byte);
+    static ArtNode* nextChild(Inner* node, int after);
+    static Leaf* minimum(ArtNode* node);
+    static size_t prefixMismatch(const Inner* node, const std::string& bytes, size_t depth);
+    static void addChild(ArtNode** slot, uint8_t byte, ArtNode* child);
+    static void removeChild(ArtNode** slot, uint8_t byte);
+    static void destroy(ArtNode* node);
+
+    Leaf* findLeaf(const std::string& bytes) const;
+    static Leaf* lowerBoundHelper(ArtNode* node, const std::string& bytes, size_t depth);
+    static Leaf* removeHelper(ArtNode** slot, const std::string& bytes, size_t depth);
+    void linkBefore(Leaf* leaf, Leaf* next);
+
+    ArtMap(const ArtMap&);
+    ArtMap& operator=(const ArtMap&);
+
+    ArtNode* root_;
+    Leaf* head_;    // the smallest leaf
+    Leaf* tail_;    // the largest leaf
+};
+
+template<typename Key, typename Value, typename KeyCodec>
+ArtMap<Key, Value, KeyCodec>::ArtMap() :
+    root_(nullptr),
+    head_(nullptr),
+    tail_(nullptr)
+{
+
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+ArtMap<Key, Value, KeyCodec>::~ArtMap()
+{
+    clear();
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::clear()
+{
+    destroy(root_);
+    root_ = nullptr;
+    head_ = nullptr;
+    tail_ = nullptr;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+bool ArtMap<Key, Value, KeyCodec>::empty() const
+{
+    return root_ == nullptr;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+std::string ArtMap<Key, Value, KeyCodec>::encode(const Key& key)
+{
+    std::string bytes;
+    KeyCodec::encode(key, bytes);
+    return bytes;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::destroy(ArtNode* node)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+    if (node->type_ == LEAF)
+    {
+        delete static_cast<Leaf*>(node);
+        return;
+    }
+    switch (node->type_)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            destroy(n->children_[i]);
+        }
+        delete n;
+        return;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            destroy(n->children_[i]);
+        }
+        delete n;
+        return;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            destroy(n->children_[i]);
+        }
+        delete n;
+        return;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            destroy(n->children_[byte]);
+        }
+        delete n;
+        return;
+    }
+    }
+}
+
+/**
+* Returns the slot holding the child for byte, or nullptr if there is none.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::ArtNode** ArtMap<Key, Value, KeyCodec>::findChild(Inner* node, uint8_t byte)
+{
+    switch (node->type_)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            if (n->keys_[i] == byte)
+            {
+                return &n->children_[i];
+            }
+        }
+        return nullptr;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            if (n->keys_[i] == byte)
+            {
+                return &n->children_[i];
+            }
+        }
+        return nullptr;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        return n->index_[byte] != 0 ? &n->children_[n->index_[byte] - 1] : nullptr;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        return n->children_[byte] != nullptr ? &n->children_[byte] : nullptr;
+    }
+    }
+}
+
+/**
+* Returns the child with the smallest branch byte greater than after
+* (pass -1 for the first child), or nullptr.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::ArtNode* ArtMap<Key, Value, KeyCodec>::nextChild(Inner* node, int after)
+{
+    switch (node->type_)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            if (n->keys_[i] > after)
+            {
+                return n->children_[i];
+            }
+        }
+        return nullptr;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for (int i = 0; i < n->count_; ++i)
+        {
+            if (n->keys_[i] > after)
+            {
+                return n->children_[i];
+            }
+        }
+        return nullptr;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        for (int byte = after + 1; byte < 256; ++byte)
+        {
+            if (n->index_[byte] != 0)
+            {
+                return n->children_[n->index_[byte] - 1];
+            }
+        }
+        return nullptr;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        for (int byte = after + 1; byte < 256; ++byte)
+        {
+            if (n->children_[byte] != nullptr)
+            {
+                return n->children_[byte];
+            }
+        }
+        return nullptr;
+    }
+    }
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::Leaf* ArtMap<Key, Value, KeyCodec>::minimum(ArtNode* node)
+{
+    while (node != nullptr && node->type_ != LEAF)
+    {
+        node = nextChild(static_cast<Inner*>(node), -1);
+    }
+    return static_cast<Leaf*>(node);
+}
+
+/**
+* Returns how many bytes of the node's prefix match bytes from depth on.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+size_t ArtMap<Key, Value, KeyCodec>::prefixMismatch(const Inner* node, const std::string& bytes, size_t depth)
+{
+    size_t i = 0;
+    while (i < node->prefix_.size() && depth + i < bytes.size() && node->prefix_[i] == bytes[depth + i])
+    {
+        ++i;
+    }
+    return i;
+}
+
+/**
+* Adds child under byte to the inner node in *slot, replacing the node
+* with the next larger kind if it is full.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::addChild(ArtNode** slot, uint8_t byte, ArtNode* child)
+{
+    Inner* node = static_cast<Inner*>(*slot);
+    switch (node->type_)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        if (n->count_ < 4)
+        {
+            int i = n->count_;
+            for (; i > 0 && n->keys_[i - 1] > byte; --i)
+            {
+                n->keys_[i] = n->keys_[i - 1];
+                n->children_[i] = n->children_[i - 1];
+            }
+            n->keys_[i] = byte;
+            n->children_[i] = child;
+            ++n->count_;
+            return;
+        }
+        Node16* grown = new Node16();
+        grown->prefix_.swap(n->prefix_);
+        grown->count_ = n->count_;
+        std::memcpy(grown->keys_, n->keys_, sizeof(n->keys_));
+        std::memcpy(grown->children_, n->children_, sizeof(n->children_));
+        delete n;
+        *slot = grown;
+        addChild(slot, byte, child);
+        return;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        if (n->count_ < 16)
+        {
+            int i = n->count_;
+            for (; i > 0 && n->keys_[i - 1] > byte; --i)
+            {
+                n->keys_[i] = n->keys_[i - 1];
+                n->children_[i] = n->children_[i - 1];
+            }
+            n->keys_[i] = byte;
+            n->children_[i] = child;
+            ++n->count_;
+            return;
+        }
+        Node48* grown = new Node48();
+        grown->prefix_.swap(n->prefix_);
+        grown->count_ = n->count_;
+        for (int i = 0; i < n->count_; ++i)
+        {
+            grown->index_[n->keys_[i]] = i + 1;
+            grown->children_[i] = n->children_[i];
+        }
+        delete n;
+        *slot = grown;
+        addChild(slot, byte, child);
+        return;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        if (n->count_ < 48)
+        {
+            n->children_[n->count_] = child;
+            n->index_[byte] = ++n->count_;
+            return;
+        }
+        Node256* grown = new Node256();
+        grown->prefix_.swap(n->prefix_);
+        grown->count_ = n->count_;
+        for (int b = 0; b < 256; ++b)
+        {
+            if (n->index_[b] != 0)
+            {
+                grown->children_[b] = n->children_[n->index_[b] - 1];
+            }
+        }
+        delete n;
+        *slot = grown;
+        addChild(slot, byte, child);
+        return;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        n->children_[byte] = child;
+        ++n->count_;
+        return;
+    }
+    }
+}
+
+/**
+* Drops the child under byte from the inner node in *slot, replacing the
+* node with the next smaller kind once it is sparse enough. A Node4 left
+* with one child is merged into that child.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::removeChild(ArtNode** slot, uint8_t byte)
+{
+    Inner* node = static_cast<Inner*>(*slot);
+    switch (node->type_)
+    {
+    case NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        int i = 0;
+        while (n->keys_[i] != byte)
+        {
+            ++i;
+        }
+        for (--n->count_; i < n->count_; ++i)
+        {
+            n->keys_[i] = n->keys_[i + 1];
+            n->children_[i] = n->children_[i + 1];
+        }
+        if (n->count_ == 1)
+        {
+            ArtNode* child = n->children_[0];
+            if (child->type_ != LEAF)
+            {
+                Inner* inner = static_cast<Inner*>(child);
+                inner->prefix_ = n->prefix_ + static_cast<char>(n->keys_[0]) + inner->prefix_;
+            }
+            delete n;
+            *slot = child;
+        }
+        return;
+    }
+    case NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        int i = 0;
+        while (n->keys_[i] != byte)
+        {
+            ++i;
+        }
+        for (--n->count_; i < n->count_; ++i)
+        {
+            n->keys_[i] = n->keys_[i + 1];
+            n->children_[i] = n->children_[i + 1];
+        }
+        if (n->count_ <= 3)
+        {
+            Node4* shrunk = new Node4();
+            shrunk->prefix_.swap(n->prefix_);
+            shrunk->count_ = n->count_;
+            std::memcpy(shrunk->keys_, n->keys_, n->count_);
+            std::memcpy(shrunk->children_, n->children_, n->count_ * sizeof(ArtNode*));
+            delete n;
+            *slot = shrunk;
+        }
+        return;
+    }
+    case NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        int freed = n->index_[byte] - 1;
+        n->index_[byte] = 0;
+        --n->count_;
+        if (freed != n->count_)
+        {
+            // move the last child into the freed slot
+            for (int b = 0; b < 256; ++b)
+            {
+                if (n->index_[b] == n->count_ + 1)
+                {
+                    n->index_[b] = freed + 1;
+                    n->children_[freed] = n->children_[n->count_];
+                    break;
+                }
+            }
+        }
+        if (n->count_ <= 12)
+        {
+            Node16* shrunk = new Node16();
+            shrunk->prefix_.swap(n->prefix_);
+            for (int b = 0; b < 256; ++b)
+            {
+                if (n->index_[b] != 0)
+                {
+                    shrunk->keys_[shrunk->count_] = b;
+                    shrunk->children_[shrunk->count_++] = n->children_[n->index_[b] - 1];
+                }
+            }
+            delete n;
+            *slot = shrunk;
+        }
+        return;
+    }
+    default:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        n->children_[byte] = nullptr;
+        --n->count_;
+        if (n->count_ <= 37)
+        {
+            Node48* shrunk = new Node48();
+            shrunk->prefix_.swap(n->prefix_);
+            for (int b = 0; b < 256; ++b)
+            {
+                if (n->children_[b] != nullptr)
+                {
+                    shrunk->children_[shrunk->count_] = n->children_[b];
+                    shrunk->index_[b] = ++shrunk->count_;
+                }
+            }
+            delete n;
+            *slot = shrunk;
+        }
+        return;
+    }
+    }
+}
+
+/**
+* Returns the leaf holding exactly bytes, or nullptr.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::Leaf* ArtMap<Key, Value, KeyCodec>::findLeaf(const std::string& bytes) const
+{
+    ArtNode* node = root_;
+    size_t depth = 0;
+    while (node != nullptr && node->type_ != LEAF)
+    {
+        Inner* inner = static_cast<Inner*>(node);
+        if (prefixMismatch(inner, bytes, depth) != inner->prefix_.size())
+        {
+            return nullptr;
+        }
+        depth += inner->prefix_.size();
+        if (depth >= bytes.size())
+        {
+            return nullptr;
+        }
+        ArtNode** slot = findChild(inner, bytes[depth]);
+        node = slot != nullptr ? *slot : nullptr;
+        ++depth;
+    }
+    Leaf* leaf = static_cast<Leaf*>(node);
+    return leaf != nullptr && leaf->bytes_ == bytes ? leaf : nullptr;
+}
+
+/**
+* Returns the first leaf below node whose bytes are not less than bytes,
+* or nullptr if every leaf below node is smaller.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::Leaf* ArtMap<Key, Value, KeyCodec>::lowerBoundHelper(ArtNode* node, const std::string& bytes, size_t depth)
+{
+    if (node->type_ == LEAF)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        return leaf->bytes_.compare(bytes) >= 0 ? leaf : nullptr;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    size_t matched = prefixMismatch(inner, bytes, depth);
+    if (matched < inner->prefix_.size())
+    {
+        if (depth + matched >= bytes.size() ||
+            static_cast<uint8_t>(inner->prefix_[matched]) > static_cast<uint8_t>(bytes[depth + matched]))
+        {
+            return minimum(node);
+        }
+        return nullptr;
+    }
+    depth += inner->prefix_.size();
+    if (depth >= bytes.size())
+    {
+        return minimum(node);
+    }
+    uint8_t byte = bytes[depth];
+    ArtNode** slot = findChild(inner, byte);
+    if (slot != nullptr)
+    {
+        Leaf* leaf = lowerBoundHelper(*slot, bytes, depth + 1);
+        if (leaf != nullptr)
+        {
+            return leaf;
+        }
+    }
+    return minimum(nextChild(inner, byte));
+}
+
+/**
+* Puts leaf into the ordered list just before next (at the end if next
+* is nullptr).
+*/
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::linkBefore(Leaf* leaf, Leaf* next)
+{
+    Leaf* prev = next != nullptr ? next->prev_ : tail_;
+    leaf->prev_ = prev;
+    leaf->next_ = next;
+    if (prev != nullptr)
+    {
+        prev->next_ = leaf;
+    }
+    else
+    {
+        head_ = leaf;
+    }
+    if (next != nullptr)
+    {
+        next->prev_ = leaf;
+    }
+    else
+    {
+        tail_ = leaf;
+    }
+}
+
+/*
+ * If key is already in the map, its value is overwritten.
+ */
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    std::string bytes = encode(keyValuePair.first);
+    Leaf* next = root_ != nullptr ? lowerBoundHelper(root_, bytes, 0) : nullptr;
+    if (next != nullptr && next->bytes_ == bytes)
+    {
+        next->item_.second = keyValuePair.second;
+        return;
+    }
+    Leaf* leaf = new Leaf(bytes, keyValuePair);
+    ArtNode** slot = &root_;
+    size_t depth = 0;
+    while (true)
+    {
+        ArtNode* node = *slot;
+        if (node == nullptr)
+        {
+            *slot = leaf;
+            break;
+        }
+        if (node->type_ == LEAF)
+        {
+            // two leaves: branch where their bytes first differ
+            const std::string& other = static_cast<Leaf*>(node)->bytes_;
+            size_t split = depth;
+            while (other[split] == bytes[split])
+            {
+                ++split;
+            }
+            Node4* branch = new Node4();
+            branch->prefix_.assign(bytes, depth, split - depth);
+            *slot = branch;
+            addChild(slot, other[split], node);
+            addChild(slot, bytes[split], leaf);
+            break;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        size_t matched = prefixMismatch(inner, bytes, depth);
+        if (matched < inner->prefix_.size())
+        {
+            // the key leaves the compressed path: branch inside it
+            Node4* branch = new Node4();
+            branch->prefix_.assign(inner->prefix_, 0, matched);
+            uint8_t innerByte = inner->prefix_[matched];
+            inner->prefix_.erase(0, matched + 1);
+            *slot = branch;
+            addChild(slot, innerByte, inner);
+            addChild(slot, bytes[depth + matched], leaf);
+            break;
+        }
+        depth += inner->prefix_.size();
+        ArtNode** child = findChild(inner, bytes[depth]);
+        if (child == nullptr)
+        {
+            addChild(slot, bytes[depth], leaf);
+            break;
+        }
+        slot = child;
+        ++depth;
+    }
+    linkBefore(leaf, next);
+}
+
+/**
+* Unlinks the leaf holding bytes from the subtree in *slot, shrinking
+* nodes on the way back up, and returns it (or nullptr if absent).
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::Leaf* ArtMap<Key, Value, KeyCodec>::removeHelper(ArtNode** slot, const std::string& bytes, size_t depth)
+{
+    ArtNode* node = *slot;
+    if (node->type_ == LEAF)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        if (leaf->bytes_ != bytes)
+        {
+            return nullptr;
+        }
+        *slot = nullptr;
+        return leaf;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    if (prefixMismatch(inner, bytes, depth) != inner->prefix_.size())
+    {
+        return nullptr;
+    }
+    depth += inner->prefix_.size();
+    if (depth >= bytes.size())
+    {
+        return nullptr;
+    }
+    uint8_t byte = bytes[depth];
+    ArtNode** child = findChild(inner, byte);
+    if (child == nullptr)
+    {
+        return nullptr;
+    }
+    Leaf* leaf = removeHelper(child, bytes, depth + 1);
+    if (leaf != nullptr && *child == nullptr)
+    {
+        removeChild(slot, byte);
+    }
+    return leaf;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+void ArtMap<Key, Value, KeyCodec>::remove(const Key& key)
+{
+    if (root_ == nullptr)
+    {
+        return;
+    }
+    Leaf* leaf = removeHelper(&root_, encode(key), 0);
+    if (leaf == nullptr)
+    {
+        return;
+    }
+    if (leaf->prev_ != nullptr)
+    {
+        leaf->prev_->next_ = leaf->next_;
+    }
+    else
+    {
+        head_ = leaf->next_;
+    }
+    if (leaf->next_ != nullptr)
+    {
+        leaf->next_->prev_ = leaf->prev_;
+    }
+    else
+    {
+        tail_ = leaf->prev_;
+    }
+    delete leaf;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::iterator ArtMap<Key, Value, KeyCodec>::begin() const
+{
+    return iterator(head_);
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::iterator ArtMap<Key, Value, KeyCodec>::end() const
+{
+    return iterator(nullptr);
+}
+
+/**
+* Returns an iterator to the item with the given key, or end().
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::iterator ArtMap<Key, Value, KeyCodec>::find(const Key& key) const
+{
+    return iterator(findLeaf(encode(key)));
+}
+
+/**
+* Returns an iterator to the first item whose key is not less than key.
+*/
+template<typename Key, typename Value, typename KeyCodec>
+typename ArtMap<Key, Value, KeyCodec>::iterator ArtMap<Key, Value, KeyCodec>::lower_bound(const Key& key) const
+{
+    if (root_ == nullptr)
+    {
+        return end();
+    }
+    return iterator(lowerBoundHelper(root_, encode(key), 0));
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns the value associated with the key
+ */
+template<typename Key, typename Value, typename KeyCodec>
+Value& ArtMap<Key, Value, KeyCodec>::operator[](const Key& key)
+{
+    Leaf* leaf = findLeaf(encode(key));
+    if(leaf == NULL) throw std::out_of_range("Invalid key");
+    return leaf->item_.second;
+}
+
+template<typename Key, typename Value, typename KeyCodec>
+Value const & ArtMap<Key, Value, KeyCodec>::operator[](const Key& key) const
+{
+    Leaf* leaf = findLeaf(encode(key));
+    if(leaf == NULL) throw std::out_of_range("Invalid key");
+    return leaf->item_.second;
+}
+
+#endif
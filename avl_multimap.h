@@ -0,0 +1,226 @@
+#ifndef AVL_MULTIMAP_H
+#define AVL_MULTIMAP_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "avlbst.h"
+
+/**
+* An AVLTree that keeps every item inserted, duplicate keys included.
+* Each item is its own node; items with equal keys sit next to each
+* other in iteration order, oldest first, so no per-key container is
+* needed.
+*
+* equal_range and count find the first item of a key in O(log n) and
+* walk its k items from there. erase(iterator) removes the one item it
+* points to, leaving its duplicates alone. find and operator[] return
+* the oldest item of a key. The batch updates keep every item too, so
+* none of this depends on which class the tree is reached through.
+*/
+template <class Key, class Value>
+class AVLMultiMap : public AVLTree<Key, Value>
+{
+public:
+    typedef typename AVLTree<Key, Value>::iterator iterator;
+
+    virtual void insert(const std::pair<const Key, Value>& new_item) override;
+    virtual void remove(const Key& key) override;
+    virtual void insertBatch(const std::vector<std::pair<Key, Value> >& batch) override;
+    virtual void removeBatch(const std::vector<Key>& keys) override;
+    virtual bool duplicateKeys() const override;
+
+    size_t count(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    iterator upper_bound(const Key& key) const;
+    std::pair<iterator, iterator> equal_range(const Key& key) const;
+};
+
+/*
+ * Unlike AVLTree::insert, an equal key never overwrites: the new item
+ * goes after every item already there with that key.
+ */
+template<class Key, class Value>
+void AVLMultiMap<Key, Value>::insert(const std::pair<const Key, Value>& new_item)
+{
+    AVLNode<Key, Value>* parent = nullptr;
+    AVLNode<Key, Value>* cur = static_cast<AVLNode<Key, Value>*>(this->root_);
+    while (cur != nullptr)
+    {
+        parent = cur;
+        cur = new_item.first < cur->getKey() ? cur->getLeft() : cur->getRight();
+    }
+    AVLNode<Key, Value>* node = this->createNode(new_item.first, new_item.second, parent);
+    if (parent == nullptr)
+    {
+        this->root_ = node;
+    }
+    else if (new_item.first < parent->getKey())
+    {
+        parent->setLeft(node);
+    }
+    else
+    {
+        parent->setRight(node);
+    }
+    this->insertRebalance(node);
+}
+
+/**
+* Removes every item with the given key.
+*/
+template<class Key, class Value>
+void AVLMultiMap<Key, Value>::remove(const Key& key)
+{
+    std::pair<iterator, iterator> range = equal_range(key);
+    this->erase(range.first, range.second);
+}
+
+/**
+* Inserts every item of batch, duplicates included, each after the items
+* already there with its key; equal keys within the batch keep their
+* order. The items go in one at a time, as the batch merge of AVLTree
+* would overwrite rather than add.
+*/
+template<class Key, class Value>
+void AVLMultiMap<Key, Value>::insertBatch(const std::vector<std::pair<Key, Value> >& batch)
+{
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        insert(batch[i]);
+    }
+}
+
+/**
+* Removes every item with any of the keys in keys.
+*/
+template<class Key, class Value>
+void AVLMultiMap<Key, Value>::removeBatch(const std::vector<Key>& keys)
+{
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        remove(keys[i]);
+    }
+}
+
+/**
+* Tells find, operator[], findMany and readTree that equal keys are
+* expected, and that lookups should return the oldest item.
+*/
+template<class Key, class Value>
+bool AVLMultiMap<Key, Value>::duplicateKeys() const
+{
+    return true;
+}
+
+template<class Key, class Value>
+size_t AVLMultiMap<Key, Value>::count(const Key& key) const
+{
+    size_t n = 0;
+    for (iterator it = lower_bound(key); it != this->end() && !(key < it->first); ++it)
+    {
+        ++n;
+    }
+    return n;
+}
+
+/**
+* Returns an iterator to the first item whose key is not less than key.
+*/
+template<class Key, class Value>
+typename AVLMultiMap<Key, Value>::iterator AVLMultiMap<Key, Value>::lower_bound(const Key& key) const
+{
+    Node<Key, Value>* found = nullptr;
+    for (Node<Key, Value>* cur = this->root_; cur != nullptr; )
+    {
+        if (cur->getKey() < key)
+        {
+            cur = cur->getRight();
+        }
+        else
+        {
+            found = cur;
+            cur = cur->getLeft();
+        }
+    }
+    return this->iteratorAt(found);
+}
+
+/**
+* Returns an iterator to the first item whose key is greater than key.
+*/
+template<class Key, class Value>
+typename AVLMultiMap<Key, Value>::iterator AVLMultiMap<Key, Value>::upper_bound(const Key& key) const
+{
+    Node<Key, Value>* found = nullptr;
+    for (Node<Key, Value>* cur = this->root_; cur != nullptr; )
+    {
+        if (key < cur->getKey())
+        {
+            found = cur;
+            cur = cur->getLeft();
+        }
+        else
+        {
+            cur = cur->getRight();
+        }
+    }
+    return this->iteratorAt(found);
+}
+
+/**
+* Returns the items with the given key as [first, second). The two
+* bounds share one descent down to the first node with the key, then
+* part ways below it.
+*/
+template<class Key, class Value>
+std::pair<typename AVLMultiMap<Key, Value>::iterator, typename AVLMultiMap<Key, Value>::iterator>
+AVLMultiMap<Key, Value>::equal_range(const Key& key) const
+{
+    Node<Key, Value>* upper = nullptr;
+    Node<Key, Value>* cur = this->root_;
+    while (cur != nullptr)
+    {
+        if (cur->getKey() < key)
+        {
+            cur = cur->getRight();
+        }
+        else if (key < cur->getKey())
+        {
+            upper = cur;
+            cur = cur->getLeft();
+        }
+        else
+        {
+            Node<Key, Value>* lower = cur;
+            for (Node<Key, Value>* left = cur->getLeft(); left != nullptr; )
+            {
+                if (left->getKey() < key)
+                {
+                    left = left->getRight();
+                }
+                else
+                {
+                    lower = left;
+                    left = left->getLeft();
+                }
+            }
+            for (Node<Key, Value>* right = cur->getRight(); right != nullptr; )
+            {
+                if (key < right->getKey())
+                {
+                    upper = right;
+                    right = right->getLeft();
+                }
+                else
+                {
+                    right = right->getRight();
+                }
+            }
+            return std::make_pair(this->iteratorAt(lower), this->iteratorAt(upper));
+        }
+    }
+    return std::make_pair(this->iteratorAt(upper), this->iteratorAt(upper));
+}
+
+#endif
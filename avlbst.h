@@ -1,10 +1,11 @@
-#ifndef RBBST_H
-#define RBBST_H
+#ifndef AVLBST_H
+#define AVLBST_H
 
 #include <iostream>
 #include <exception>
 #include <cstdlib>
 #include <algorithm>
+#include <vector>
 #include "bst.h"
 
 struct KeyError { };
@@ -130,22 +131,64 @@ template <class Key, class Value>
 class AVLTree : public BinarySearchTree<Key, Value>
 {
 public:
+    AVLTree();
     virtual void insert (const std::pair<const Key, Value> &new_item); // TODO
     virtual void remove(const Key& key);  // TODO
+    virtual void insertBatch(const std::vector<std::pair<Key, Value> >& batch);
+    virtual void removeBatch(const std::vector<Key>& keys);
+    virtual void eraseRange(const Key& lo, const Key& hi);
+    size_t rotations() const;
 protected:
     virtual void nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2);
+    virtual AVLNode<Key, Value>* createNode(const Key& key, const Value& value, AVLNode<Key, Value>* parent);
+    virtual Node<Key, Value>* createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels) override;
+    virtual void removeNode(Node<Key, Value>* node) override;
 
     // Add helper functions here
     AVLNode<Key, Value>* predecessor(AVLNode<Key, Value>* current);
-    void rightRotate(AVLNode<Key, Value>* node); 
-    void leftRotate(AVLNode<Key, Value>* node);
+    virtual void rightRotate(AVLNode<Key, Value>* node);
+    virtual void leftRotate(AVLNode<Key, Value>* node);
     void removeHelper(const Key& key, int8_t& diff, AVLNode<Key, Value>* current, AVLNode<Key, Value>** parent);
+    void unlinkNode(AVLNode<Key, Value>* current, int8_t& diff, AVLNode<Key, Value>** parentLoc);
     Node<Key, Value>* insertHelper(Node<Key, Value>* cur, Node<Key, Value>* parent, AVLNode<Key, Value>** loc, const std::pair<const Key, Value>& keyValuePair);
     void insertFix(AVLNode<Key, Value>* parent, AVLNode<Key, Value>* node);
+    void insertRebalance(AVLNode<Key, Value>* node);
     void removeFix (AVLNode<Key, Value>* node, int8_t diff);
 
+    // Batch helpers. They work on detached subtrees whose heights are
+    // passed along, so no height is ever recomputed from scratch. Every
+    // node they relink goes through link, which tells childrenChanged.
+    static int subtreeHeight(AVLNode<Key, Value>* node);
+    static int leftHeight(AVLNode<Key, Value>* node, int height);
+    static int rightHeight(AVLNode<Key, Value>* node, int height);
+    AVLNode<Key, Value>* link(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height);
+    AVLNode<Key, Value>* rebalance(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height);
+    AVLNode<Key, Value>* join(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height);
+    AVLNode<Key, Value>* splitLast(AVLNode<Key, Value>* node, int h, AVLNode<Key, Value>*& last, int& height);
+    AVLNode<Key, Value>* split(AVLNode<Key, Value>* node, int h, const Key& key, AVLNode<Key, Value>*& greater, int& greaterHeight, int& height);
+    AVLNode<Key, Value>* insertBatchHelper(AVLNode<Key, Value>* node, int h, std::vector<std::pair<Key, Value> >& batch, size_t lo, size_t hi, int& height);
+    AVLNode<Key, Value>* removeBatchHelper(AVLNode<Key, Value>* node, int h, const std::vector<Key>& keys, size_t lo, size_t hi, int& height);
+
+    size_t rotations_;  // single rotations done by insert and remove, for measuring
 };
 
+template<class Key, class Value>
+AVLTree<Key, Value>::AVLTree() :
+    rotations_(0)
+{
+
+}
+
+/**
+* Returns how many single rotations insert and remove have done so far.
+* A double rotation counts as two.
+*/
+template<class Key, class Value>
+size_t AVLTree<Key, Value>::rotations() const
+{
+    return rotations_;
+}
+
 
 template<class Key, class Value>
 void AVLTree<Key, Value>::rightRotate(AVLNode<Key, Value>* node)
@@ -153,6 +196,7 @@ void AVLTree<Key, Value>::rightRotate(AVLNode<Key, Value>* node)
     AVLNode<Key, Value>* leftChild=node->getLeft(); //take the left child 
     AVLNode<Key, Value>* parent=node->getParent(); //get the parent
     AVLNode<Key, Value>* gradRightChild=leftChild->getRight(); //get the child's right child 
+    ++rotations_;
     if (node==this->root_) //node is the root node 
     {
         this->root_=leftChild; 
@@ -185,6 +229,7 @@ void AVLTree<Key, Value>::leftRotate(AVLNode<Key, Value>* node)
     AVLNode<Key, Value>* rightChild=node->getRight(); //take the right child 
     AVLNode<Key, Value>* parent=node->getParent(); //get the parent
     AVLNode<Key, Value>* gradLeftChild=rightChild->getLeft(); //get the child's left child 
+    ++rotations_;
     if (node==this->root_) //node is the root node 
     {
         this->root_=rightChild; 
@@ -320,7 +365,7 @@ void AVLTree<Key, Value>::insert (const std::pair<const Key, Value> &new_item)
     // TODO (Complete)
     if (this->root_==nullptr) 
     {
-        this->root_ = new AVLNode <Key, Value> (new_item.first, new_item.second, nullptr);
+        this->root_ = createNode(new_item.first, new_item.second, nullptr);
         //this->root_->setBalance(0);
 
         return; 
@@ -329,26 +374,40 @@ void AVLTree<Key, Value>::insert (const std::pair<const Key, Value> &new_item)
     insertHelper(this->root_, nullptr, &insertLoc, new_item); 
     if (insertLoc!=nullptr)
     {
-        AVLNode<Key, Value>* parent=insertLoc->getParent(); 
-        if (parent->getBalance()==-1 || parent->getBalance()==1)
+        insertRebalance(insertLoc);
+    }
+
+}
+
+/**
+* Updates the balances above node, just linked in as a leaf, and rotates
+* where they get out of range.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::insertRebalance(AVLNode<Key, Value>* node)
+{
+    AVLNode<Key, Value>* parent=node->getParent(); 
+    if (parent==nullptr)
+    {
+        return; 
+    }
+    if (parent->getBalance()==-1 || parent->getBalance()==1)
+    {
+        parent->setBalance(0); 
+    }
+    else if (parent->getBalance()==0)
+    {
+        if (parent->getLeft()==node) //update balance to -1 
         {
-            parent->setBalance(0); 
+            parent->updateBalance(-1); 
+
         }
-        else if (parent->getBalance()==0)
+        else if (parent->getRight()==node) //update balance to 1 
         {
-            if (parent->getLeft()==insertLoc) //update balance to -1 
-            {
-                parent->updateBalance(-1); 
-
-            }
-            else if (parent->getRight()==insertLoc) //update balance to 1 
-            {
-                parent->updateBalance(1);
-            }
-            insertFix(parent, insertLoc); 
+            parent->updateBalance(1);
         }
+        insertFix(parent, node); 
     }
-
 }
 
 template<class Key, class Value> 
@@ -356,7 +415,7 @@ Node<Key, Value>* AVLTree<Key, Value>::insertHelper(Node<Key, Value>* cur, Node<
 {
     if (cur==nullptr)
     {
-        *loc = new AVLNode<Key, Value>(keyValuePair.first, keyValuePair.second, nullptr); 
+        *loc = createNode(keyValuePair.first, keyValuePair.second, nullptr); 
         (*loc)->setParent(parent);
         return *loc;
     }
@@ -413,7 +472,7 @@ void AVLTree<Key, Value>:: removeFix (AVLNode<Key, Value>* node, int8_t diff)
         return; 
     }
     AVLNode<Key, Value>* parent= node->getParent(); 
-    int8_t ndiff; 
+    int8_t ndiff = 0; // only read when parent is not NULL
     if (parent!=nullptr)
     {
         if (parent->getLeft()==node)
@@ -560,65 +619,76 @@ void AVLTree<Key, Value>:: removeHelper(const Key& key, int8_t& diff, AVLNode<Ke
         } 
     }
     if(current) {
-        if(current->getLeft() == nullptr || current->getRight() == nullptr) {
-            AVLNode<Key, Value>* parent = current->getParent();
-            AVLNode<Key, Value>* child = current->getLeft() ? current->getLeft() : current->getRight();
-            if(current->getParent() && current) 
+        unlinkNode(current, diff, parentLoc);
+    }
+}
+
+/**
+* Takes current out of the tree and frees it, swapping it with its
+* predecessor first if it has two children. Leaves in diff and
+* *parentLoc what removeFix needs to rebalance.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::unlinkNode(AVLNode<Key, Value>* current, int8_t& diff, AVLNode<Key, Value>** parentLoc)
+{
+    if(current->getLeft() == nullptr || current->getRight() == nullptr) {
+        AVLNode<Key, Value>* parent = current->getParent();
+        AVLNode<Key, Value>* child = current->getLeft() ? current->getLeft() : current->getRight();
+        if(current->getParent() && current) 
+        {
+            if (parent->getLeft()==current)
             {
-                if (parent->getLeft()==current)
-                {
-                    diff=1;
-                }
-                else if (parent->getRight()==current)
-                {
-                    diff=-1; 
-                }
+                diff=1;
             }
-            if(current->getLeft() == nullptr && current->getRight()==nullptr) //no children case 
-            { 
-                if(current != this->root_) 
+            else if (parent->getRight()==current)
+            {
+                diff=-1; 
+            }
+        }
+        if(current->getLeft() == nullptr && current->getRight()==nullptr) //no children case 
+        { 
+            if(current != this->root_) 
+            {
+                if (current==parent->getLeft())
                 {
-                    if (current==parent->getLeft())
-                    {
-                        parent->setLeft(nullptr);
-                    }
-                    else if (current==parent->getRight())
-                    {
-                        parent->setRight(nullptr);
-                    }
-                } 
-                else 
+                    parent->setLeft(nullptr);
+                }
+                else if (current==parent->getRight())
                 {
-                    this->root_ = nullptr;
+                    parent->setRight(nullptr);
                 }
             } 
             else 
             {
-                if(current != this->root_) 
+                this->root_ = nullptr;
+            }
+        } 
+        else 
+        {
+            if(current != this->root_) 
+            {
+                child->setParent(parent);
+                if (current==parent->getLeft())
                 {
-                    child->setParent(parent);
-                    if (current==parent->getLeft())
-                    {
-                        parent->setLeft(child);
-                    }
-                    else if (current==parent->getRight())
-                    {
-                        parent->setRight(child);
-                    }
-                } 
-                else 
+                    parent->setLeft(child);
+                }
+                else if (current==parent->getRight())
                 {
-                    child->setParent(nullptr);
-                    this->root_ = child;
+                    parent->setRight(child);
                 }
             } 
-            *parentLoc = parent;
-            delete current;
-        } else {
-            AVLNode<Key, Value>* pred = predecessor(current);
-            nodeSwap(pred, current);
-            removeHelper(key, diff, current, parentLoc);
-        }
+            else 
+            {
+                child->setParent(nullptr);
+                this->root_ = child;
+            }
+        } 
+        *parentLoc = parent;
+        this->destroyNode(current);
+    } else {
+        AVLNode<Key, Value>* pred = predecessor(current);
+        nodeSwap(pred, current);
+        unlinkNode(current, diff, parentLoc);
     }
 }
 
@@ -631,6 +701,387 @@ void AVLTree<Key, Value>:: remove(const Key& key)
     removeFix(parent, diff);
 }
 
+/**
+* Removes node itself, without searching for its key, and rebalances.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::removeNode(Node<Key, Value>* node)
+{
+    int8_t diff = 0;
+    AVLNode<Key, Value>* parent = nullptr;
+    unlinkNode(static_cast<AVLNode<Key, Value>*>(node), diff, &parent);
+    removeFix(parent, diff);
+}
+
+/**
+* Allocates a node for insert. Trees that manage their own node memory
+* override this together with destroyNode.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::createNode(const Key& key, const Value& value, AVLNode<Key, Value>* parent)
+{
+    return new AVLNode<Key, Value>(key, value, parent);
+}
+
+/**
+* Gives buildSorted nodes from createNode, with their balance already set.
+*/
+template<class Key, class Value>
+Node<Key, Value>* AVLTree<Key, Value>::createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels)
+{
+    AVLNode<Key, Value>* node = createNode(keyValuePair.first, keyValuePair.second, nullptr);
+    node->setBalance(balance);
+    return node;
+}
+
+/*
+  ------------------------------------------------------------------
+  Batched updates. A sorted batch is merged into the tree in one
+  recursive descent: the batch is split around each node's key, the
+  two halves go down the two children, and a child the batch does not
+  reach is not visited at all. On the way back up every touched node
+  is re-joined with its new children, which rebalances it once, so the
+  cost is O(m log(n/m + 1)) for m keys rather than m separate descents
+  each followed by insertFix/removeFix.
+  ------------------------------------------------------------------
+*/
+
+/**
+* Inserts every item of batch; like insert, an existing key gets the new
+* value. If a key appears more than once the last occurrence wins.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::insertBatch(const std::vector<std::pair<Key, Value> >& batch)
+{
+    std::vector<std::pair<Key, Value> > sorted(batch.begin(), batch.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) { return a.first < b.first; });
+    // keep the last item of each run of equal keys
+    size_t kept = 0;
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        if (i + 1 < sorted.size() && !(sorted[i].first < sorted[i + 1].first))
+        {
+            continue;
+        }
+        if (kept != i)
+        {
+            sorted[kept] = sorted[i];
+        }
+        ++kept;
+    }
+    sorted.resize(kept);
+
+    AVLNode<Key, Value>* root = static_cast<AVLNode<Key, Value>*>(this->root_);
+    int height;
+    this->root_ = insertBatchHelper(root, subtreeHeight(root), sorted, 0, sorted.size(), height);
+    if (this->root_ != nullptr)
+    {
+        this->root_->setParent(nullptr);
+    }
+}
+
+/**
+* Removes every key in keys that is in the tree.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::removeBatch(const std::vector<Key>& keys)
+{
+    std::vector<Key> sorted(keys.begin(), keys.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+        [](const Key& a, const Key& b) { return !(a < b) && !(b < a); }), sorted.end());
+
+    AVLNode<Key, Value>* root = static_cast<AVLNode<Key, Value>*>(this->root_);
+    int height;
+    this->root_ = removeBatchHelper(root, subtreeHeight(root), sorted, 0, sorted.size(), height);
+    if (this->root_ != nullptr)
+    {
+        this->root_->setParent(nullptr);
+    }
+}
+
+/**
+* Removes every key k with lo <= k < hi. The tree is split at lo and
+* again at hi, the middle piece is freed in one linear pass with no
+* rebalancing, and the two outer pieces are joined back together. The
+* splits and the join each cost O(log n), so removing k keys costs
+* O(log n + k) instead of k descents each followed by removeFix.
+* Every node on the split and join spines is relinked through link, so
+* trees with per-subtree data see it through childrenChanged.
+*/
+template<class Key, class Value>
+void AVLTree<Key, Value>::eraseRange(const Key& lo, const Key& hi)
+{
+    if (!(lo < hi))
+    {
+        return;
+    }
+    AVLNode<Key, Value>* root = static_cast<AVLNode<Key, Value>*>(this->root_);
+    AVLNode<Key, Value>* rest;
+    AVLNode<Key, Value>* greater;
+    int lessHeight, restHeight, middleHeight, greaterHeight;
+    AVLNode<Key, Value>* less = split(root, subtreeHeight(root), lo, rest, restHeight, lessHeight);
+    AVLNode<Key, Value>* middle = split(rest, restHeight, hi, greater, greaterHeight, middleHeight);
+    this->clearHelper(middle);
+
+    if (less == nullptr)
+    {
+        this->root_ = greater;
+    }
+    else
+    {
+        AVLNode<Key, Value>* last;
+        int height;
+        AVLNode<Key, Value>* front = splitLast(less, lessHeight, last, restHeight);
+        this->root_ = join(front, restHeight, last, greater, greaterHeight, height);
+    }
+    if (this->root_ != nullptr)
+    {
+        this->root_->setParent(nullptr);
+    }
+}
+
+/**
+* The height of a subtree, found by following the taller side down.
+*/
+template<class Key, class Value>
+int AVLTree<Key, Value>::subtreeHeight(AVLNode<Key, Value>* node)
+{
+    int height = 0;
+    while (node != nullptr)
+    {
+        ++height;
+        node = node->getBalance() < 0 ? node->getLeft() : node->getRight();
+    }
+    return height;
+}
+
+/**
+* The height of the left subtree of a node of the given height.
+*/
+template<class Key, class Value>
+int AVLTree<Key, Value>::leftHeight(AVLNode<Key, Value>* node, int height)
+{
+    return height - 1 - (node->getBalance() > 0 ? 1 : 0);
+}
+
+/**
+* The height of the right subtree of a node of the given height.
+*/
+template<class Key, class Value>
+int AVLTree<Key, Value>::rightHeight(AVLNode<Key, Value>* node, int height)
+{
+    return height - 1 - (node->getBalance() < 0 ? 1 : 0);
+}
+
+/**
+* Makes left and right the children of node, whose heights lh and rh
+* differ by at most one, and sets height to the height of the result.
+* Children are always linked before their new parent.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::link(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height)
+{
+    node->setLeft(left);
+    node->setRight(right);
+    if (left != nullptr)
+    {
+        left->setParent(node);
+    }
+    if (right != nullptr)
+    {
+        right->setParent(node);
+    }
+    node->setBalance(rh - lh);
+    height = std::max(lh, rh) + 1;
+    this->childrenChanged(node);
+    return node;
+}
+
+/**
+* Like link, but the heights may differ by two, in which case a single or
+* double rotation is done on the way. Returns the root of the result.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::rebalance(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height)
+{
+    int h;
+    if (rh > lh + 1)
+    {
+        AVLNode<Key, Value>* inner = right->getLeft();
+        AVLNode<Key, Value>* outer = right->getRight();
+        int ih = leftHeight(right, rh);
+        int oh = rightHeight(right, rh);
+        if (ih <= oh) //zig-zig case
+        {
+            AVLNode<Key, Value>* lower = link(left, lh, node, inner, ih, h);
+            return link(lower, h, right, outer, oh, height);
+        }
+        int h2; //zig-zag case
+        AVLNode<Key, Value>* lower = link(left, lh, node, inner->getLeft(), leftHeight(inner, ih), h);
+        AVLNode<Key, Value>* upper = link(inner->getRight(), rightHeight(inner, ih), right, outer, oh, h2);
+        return link(lower, h, inner, upper, h2, height);
+    }
+    if (lh > rh + 1)
+    {
+        AVLNode<Key, Value>* inner = left->getRight();
+        AVLNode<Key, Value>* outer = left->getLeft();
+        int ih = rightHeight(left, lh);
+        int oh = leftHeight(left, lh);
+        if (ih <= oh) //zig-zig case
+        {
+            AVLNode<Key, Value>* lower = link(inner, ih, node, right, rh, h);
+            return link(outer, oh, left, lower, h, height);
+        }
+        int h2; //zig-zag case
+        AVLNode<Key, Value>* lower = link(inner->getRight(), rightHeight(inner, ih), node, right, rh, h);
+        AVLNode<Key, Value>* upper = link(outer, oh, left, inner->getLeft(), leftHeight(inner, ih), h2);
+        return link(upper, h2, inner, lower, h, height);
+    }
+    return link(left, lh, node, right, rh, height);
+}
+
+/**
+* Joins left, node and right, where every key of left is less than
+* node's and every key of right greater, into one balanced subtree.
+* The shorter side is hung from the spine of the taller one at the
+* matching height, and the spine is rebalanced on the way back up, so
+* the cost is proportional to the height difference.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::join(AVLNode<Key, Value>* left, int lh, AVLNode<Key, Value>* node, AVLNode<Key, Value>* right, int rh, int& height)
+{
+    int h;
+    if (lh > rh + 1)
+    {
+        AVLNode<Key, Value>* spine = join(left->getRight(), rightHeight(left, lh), node, right, rh, h);
+        return rebalance(left->getLeft(), leftHeight(left, lh), left, spine, h, height);
+    }
+    if (rh > lh + 1)
+    {
+        AVLNode<Key, Value>* spine = join(left, lh, node, right->getLeft(), leftHeight(right, rh), h);
+        return rebalance(spine, h, right, right->getRight(), rightHeight(right, rh), height);
+    }
+    return link(left, lh, node, right, rh, height);
+}
+
+/**
+* Detaches the node with the largest key from the subtree at node, of
+* height h. Returns the rest, rebalanced, with its height in height.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::splitLast(AVLNode<Key, Value>* node, int h, AVLNode<Key, Value>*& last, int& height)
+{
+    if (node->getRight() == nullptr)
+    {
+        last = node;
+        height = h - 1;
+        return node->getLeft();
+    }
+    int rh;
+    AVLNode<Key, Value>* rest = splitLast(node->getRight(), rightHeight(node, h), last, rh);
+    return join(node->getLeft(), leftHeight(node, h), node, rest, rh, height);
+}
+
+/**
+* Splits the subtree at node, of height h, into the keys less than key,
+* which are returned, and the rest, which go in greater. Each node on
+* the search path is joined onto the side it belongs to on the way back
+* up, and the joins' costs telescope to O(h) in all.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::split(AVLNode<Key, Value>* node, int h, const Key& key, AVLNode<Key, Value>*& greater, int& greaterHeight, int& height)
+{
+    if (node == nullptr)
+    {
+        greater = nullptr;
+        greaterHeight = 0;
+        height = 0;
+        return nullptr;
+    }
+    AVLNode<Key, Value>* left = node->getLeft();
+    AVLNode<Key, Value>* right = node->getRight();
+    int lh = leftHeight(node, h);
+    int rh = rightHeight(node, h);
+    AVLNode<Key, Value>* rest;
+    int restHeight;
+    if (node->getKey() < key)
+    {
+        rest = split(right, rh, key, greater, greaterHeight, restHeight);
+        return join(left, lh, node, rest, restHeight, height);
+    }
+    AVLNode<Key, Value>* less = split(left, lh, key, rest, restHeight, height);
+    greater = join(rest, restHeight, node, right, rh, greaterHeight);
+    return less;
+}
+
+/**
+* Merges batch[lo, hi), sorted and free of duplicates, into the subtree
+* at node of height h. Returns the new subtree, with its height in height.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::insertBatchHelper(AVLNode<Key, Value>* node, int h, std::vector<std::pair<Key, Value> >& batch, size_t lo, size_t hi, int& height)
+{
+    if (lo == hi)
+    {
+        height = h;
+        return node;
+    }
+    if (node == nullptr)
+    {
+        typename std::vector<std::pair<Key, Value> >::iterator first = batch.begin() + lo;
+        height = this->builtHeight(hi - lo);
+        return static_cast<AVLNode<Key, Value>*>(this->buildHelper(first, hi - lo, height));
+    }
+    size_t mid = std::lower_bound(batch.begin() + lo, batch.begin() + hi, node->getKey(),
+        [](const std::pair<Key, Value>& item, const Key& key) { return item.first < key; }) - batch.begin();
+    size_t next = mid;
+    if (mid < hi && !(node->getKey() < batch[mid].first))
+    {
+        node->setValue(batch[mid].second);
+        ++next;
+    }
+    int lh, rh;
+    AVLNode<Key, Value>* left = insertBatchHelper(node->getLeft(), leftHeight(node, h), batch, lo, mid, lh);
+    AVLNode<Key, Value>* right = insertBatchHelper(node->getRight(), rightHeight(node, h), batch, next, hi, rh);
+    return join(left, lh, node, right, rh, height);
+}
+
+/**
+* Removes the keys in keys[lo, hi), sorted and free of duplicates, from
+* the subtree at node of height h. Returns the new subtree, with its
+* height in height.
+*/
+template<class Key, class Value>
+AVLNode<Key, Value>* AVLTree<Key, Value>::removeBatchHelper(AVLNode<Key, Value>* node, int h, const std::vector<Key>& keys, size_t lo, size_t hi, int& height)
+{
+    if (lo == hi || node == nullptr)
+    {
+        height = h;
+        return node;
+    }
+    size_t mid = std::lower_bound(keys.begin() + lo, keys.begin() + hi, node->getKey()) - keys.begin();
+    bool found = mid < hi && !(node->getKey() < keys[mid]);
+    int lh, rh;
+    AVLNode<Key, Value>* left = removeBatchHelper(node->getLeft(), leftHeight(node, h), keys, lo, mid, lh);
+    AVLNode<Key, Value>* right = removeBatchHelper(node->getRight(), rightHeight(node, h), keys, found ? mid + 1 : mid, hi, rh);
+    if (!found)
+    {
+        return join(left, lh, node, right, rh, height);
+    }
+    this->destroyNode(node);
+    if (left == nullptr)
+    {
+        height = rh;
+        return right;
+    }
+    AVLNode<Key, Value>* last;
+    int restHeight;
+    AVLNode<Key, Value>* rest = splitLast(left, lh, last, restHeight);
+    return join(rest, restHeight, last, right, rh, height);
+}
+
 template<class Key, class Value>
 void AVLTree<Key, Value>::nodeSwap( AVLNode<Key,Value>* n1, AVLNode<Key,Value>* n2)
 {
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "balanced_bst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Insert bursts into the eager (AVL) and relaxed (scapegoat) balancing
+// policies: restructuring work per insert, p50/p99 insert latency, the
+// final height, and what that height costs lookups.
+//
+// usage: balance-bench [keys ...]    (default: 1000000)
+
+// Exposes the height of a tree of either policy.
+template<typename Tree>
+class MeasuredTree : public Tree
+{
+public:
+    int height() const
+    {
+        return this->getHeight(this->root_);
+    }
+};
+
+size_t restructured(const AVLTree<uint64_t, uint64_t>& tree)
+{
+    return tree.rotations();
+}
+
+size_t restructured(const ScapegoatTree<uint64_t, uint64_t>& tree)
+{
+    return tree.rebuiltNodes();
+}
+
+template<typename Policy>
+void run(const string& name, const string& order, const vector<uint64_t>& keys)
+{
+    MeasuredTree<BalancedTree<uint64_t, uint64_t, Policy> > tree;
+    vector<double> latencies(keys.size());
+    BenchTimer total;
+    for(size_t i = 0; i < keys.size(); i++) {
+        BenchTimer timer;
+        tree.insert(make_pair(keys[i], keys[i]));
+        latencies[i] = timer.nanoseconds();
+    }
+    double insertSeconds = total.seconds();
+    sort(latencies.begin(), latencies.end());
+
+    vector<uint64_t> lookups = makeUniformKeys<uint64_t>(keys.size(), 0, keys.size() - 1, 2);
+    total.restart();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < lookups.size(); i++) {
+        sum += tree.find(lookups[i])->second;
+    }
+    double findSeconds = total.seconds();
+    benchSink(sum);
+
+    cout << keys.size() << " keys " << order << "\t" << name
+         << "\tinsert " << insertSeconds << " s"
+         << "\trestructured/op " << double(restructured(tree)) / keys.size()
+         << "\tp50 " << latencies[latencies.size() / 2] << " ns"
+         << "\tp99 " << latencies[latencies.size() * 99 / 100] << " ns"
+         << "\theight " << tree.height()
+         << "\tfind " << findSeconds << " s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    cout << "restructured/op is rotations for eager, relinked nodes for relaxed" << endl;
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> random = makeShuffledKeys<uint64_t>(sizes[s], 1);
+        vector<uint64_t> ascending(random);
+        sort(ascending.begin(), ascending.end());
+        run<EagerBalance>("eager", "random", random);
+        run<RelaxedBalance>("relaxed", "random", random);
+        run<EagerBalance>("eager", "ascending", ascending);
+        run<RelaxedBalance>("relaxed", "ascending", ascending);
+    }
+    return 0;
+}
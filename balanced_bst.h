@@ -0,0 +1,46 @@
+#ifndef BALANCED_BST_H
+#define BALANCED_BST_H
+
+#include "avlbst.h"
+#include "scapegoat_bst.h"
+
+/**
+* Balancing policies for BalancedTree.
+*
+* EagerBalance restores the AVL height bound after every update with
+* rotations, which keeps lookups as short as possible. RelaxedBalance
+* lets updates leave the tree out of shape and repairs it in amortized
+* bulk rebuilds (a scapegoat tree), which suits write-heavy bursts where
+* rotations would dominate the cost of an insert.
+*/
+struct EagerBalance
+{
+    template <typename Key, typename Value>
+    struct Tree
+    {
+        typedef AVLTree<Key, Value> type;
+    };
+};
+
+struct RelaxedBalance
+{
+    template <typename Key, typename Value>
+    struct Tree
+    {
+        typedef ScapegoatTree<Key, Value> type;
+    };
+};
+
+/**
+* A balanced search tree with the balancing policy chosen at compile time:
+*
+*     BalancedTree<int, std::string> eager;
+*     BalancedTree<int, std::string, RelaxedBalance> relaxed;
+*
+* Both are BinarySearchTrees, so code written against the base class
+* works with either.
+*/
+template <typename Key, typename Value, typename Policy = EagerBalance>
+using BalancedTree = typename Policy::template Tree<Key, Value>::type;
+
+#endif
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Ingest of 10K-key batches into an AVLTree: one insert/remove per key
+// against insertBatch/removeBatch.
+//
+// usage: batch-bench [keys ...]    (default: 1000000; the tree's final size)
+
+const size_t batchSize = 10000;
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1);
+
+        BenchTimer timer;
+        AVLTree<uint64_t, uint64_t> single;
+        for(size_t i = 0; i < keys.size(); i++) {
+            single.insert(make_pair(keys[i], keys[i]));
+        }
+        double insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < keys.size(); i++) {
+            single.remove(keys[i]);
+        }
+        double removeSeconds = timer.seconds();
+
+        timer.restart();
+        AVLTree<uint64_t, uint64_t> batched;
+        vector<pair<uint64_t, uint64_t> > batch;
+        for(size_t i = 0; i < keys.size(); i += batchSize) {
+            batch.clear();
+            for(size_t j = i; j < keys.size() && j < i + batchSize; j++) {
+                batch.push_back(make_pair(keys[j], keys[j]));
+            }
+            batched.insertBatch(batch);
+        }
+        double insertBatchSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < keys.size(); i += batchSize) {
+            size_t end = i + batchSize < keys.size() ? i + batchSize : keys.size();
+            batched.removeBatch(vector<uint64_t>(keys.begin() + i, keys.begin() + end));
+        }
+        double removeBatchSeconds = timer.seconds();
+        benchSink(batched.empty());
+
+        cout << keys.size() << " keys\tinsert " << insertSeconds << " s"
+             << "\tinsertBatch " << insertBatchSeconds << " s"
+             << "\tremove " << removeSeconds << " s"
+             << "\tremoveBatch " << removeBatchSeconds << " s" << endl;
+    }
+    return 0;
+}
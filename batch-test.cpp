@@ -0,0 +1,124 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include "avlbst.h"
+
+using namespace std;
+
+// An AVLTree that can check its stored balances against real heights.
+class CheckedAVLTree : public AVLTree<int, int>
+{
+public:
+    bool balancesValid() const
+    {
+        int height;
+        return check(static_cast<AVLNode<int, int>*>(root_), nullptr, height);
+    }
+
+private:
+    static bool check(AVLNode<int, int>* node, AVLNode<int, int>* parent, int& height)
+    {
+        if(node == nullptr) {
+            height = 0;
+            return true;
+        }
+        int lh, rh;
+        bool ok = node->getParent() == parent
+                  && check(node->getLeft(), node, lh) && check(node->getRight(), node, rh);
+        height = max(lh, rh) + 1;
+        return ok && node->getBalance() == rh - lh && abs(rh - lh) <= 1;
+    }
+};
+
+// Checks that an AVLTree holds exactly the contents of expected.
+bool sameContents(const AVLTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(AVLTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedAVLTree at;
+    map<int,int> model;
+    srand(109);
+    bool ok = true;
+    for(int round = 0; round < 300; round++) {
+        // batch sizes from one key up to several times the tree size
+        int size = 1 + rand() % (round % 10 == 0 ? 2000 : 50);
+        int range = 1 + rand() % 5000;
+        if(rand() % 3) {
+            vector<pair<int, int> > batch;
+            for(int i = 0; i < size; i++) {
+                int key = rand() % range;
+                batch.push_back(make_pair(key, round * 10000 + i));
+                model[key] = round * 10000 + i;
+            }
+            at.insertBatch(batch);
+        }
+        else {
+            vector<int> keys;
+            for(int i = 0; i < size; i++) {
+                int key = rand() % range;
+                keys.push_back(key);
+                model.erase(key);
+            }
+            at.removeBatch(keys);
+        }
+        ok = ok && sameContents(at, model) && at.balancesValid();
+    }
+    cout << "Batches match: " << ok << endl;
+
+    // ordinary updates must keep working on a tree built by batches
+    for(int i = 0; i < 5000; i++) {
+        int key = rand() % 5000;
+        if(i % 2) {
+            at.remove(key);
+            model.erase(key);
+        }
+        else {
+            at.insert(make_pair(key, i));
+            model[key] = i;
+        }
+    }
+    cout << "Single updates after batches: " << (sameContents(at, model) && at.balancesValid()) << endl;
+
+    // range erases, empty and reversed ranges included
+    for(int i = 0; i < 5000; i++) {
+        int key = rand() % 5000;
+        at.insert(make_pair(key, i));
+        model[key] = i;
+    }
+    ok = true;
+    for(int round = 0; round < 200; round++) {
+        int lo = rand() % 5200 - 100;
+        int hi = lo + rand() % (round % 10 == 0 ? 3000 : 100) - 5;
+        at.eraseRange(lo, hi);
+        if(lo < hi) {
+            model.erase(model.lower_bound(lo), model.lower_bound(hi));
+        }
+        ok = ok && sameContents(at, model) && at.balancesValid();
+        if(round % 20 == 0) {
+            for(int i = 0; i < 500; i++) {
+                int key = rand() % 5000;
+                at.insert(make_pair(key, i));
+                model[key] = i;
+            }
+        }
+    }
+    cout << "Range erases match: " << ok << endl;
+
+    vector<int> all;
+    for(map<int,int>::iterator it = model.begin(); it != model.end(); ++it) {
+        all.push_back(it->first);
+    }
+    at.removeBatch(all);
+    cout << "Remove everything: " << at.empty() << endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Shared helpers for the *-bench.cpp programs.
+
+/**
+* A wall-clock stopwatch that starts running when it is constructed.
+*/
+class BenchTimer
+{
+public:
+    BenchTimer() : start_(std::chrono::steady_clock::now())
+    {
+
+    }
+
+    void restart()
+    {
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    double seconds() const
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+        return elapsed.count();
+    }
+
+    double nanoseconds() const
+    {
+        return seconds() * 1e9;
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+* Returns count distinct keys 0, stride, 2*stride, ... in a random order.
+* A stride greater than one leaves gaps so that lookups of keys which
+* are not in the tree can be generated easily.
+*/
+template<typename IntType>
+std::vector<IntType> makeShuffledKeys(size_t count, uint32_t seed, IntType stride = 1)
+{
+    std::vector<IntType> keys(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = static_cast<IntType>(i) * stride;
+    }
+    std::mt19937 randEngine(seed);
+    std::shuffle(keys.begin(), keys.end(), randEngine);
+    return keys;
+}
+
+/**
+* Returns count keys drawn uniformly (with duplicates) from [min, max].
+*/
+template<typename IntType>
+std::vector<IntType> makeUniformKeys(size_t count, IntType min, IntType max, uint32_t seed)
+{
+    std::mt19937_64 randEngine(seed);
+    std::uniform_int_distribution<IntType> distributor(min, max);
+    std::vector<IntType> keys;
+    keys.reserve(count);
+    while (keys.size() < count)
+    {
+        keys.push_back(distributor(randEngine));
+    }
+    return keys;
+}
+
+/**
+* Returns count ranks in [0, universe) drawn from a Zipf distribution
+* with exponent skew: rank r comes up in proportion to 1 / (r + 1)^skew,
+* so rank 0 is the hottest. Map ranks through a shuffled key list to
+* spread the hot keys over the key space.
+*/
+template<typename IntType>
+std::vector<IntType> makeZipfKeys(size_t count, size_t universe, double skew, uint32_t seed)
+{
+    std::vector<double> cdf(universe);
+    double total = 0;
+    for (size_t r = 0; r < universe; ++r)
+    {
+        total += 1 / std::pow(static_cast<double>(r + 1), skew);
+        cdf[r] = total;
+    }
+    std::mt19937_64 randEngine(seed);
+    std::uniform_real_distribution<double> distributor(0, total);
+    std::vector<IntType> keys;
+    keys.reserve(count);
+    while (keys.size() < count)
+    {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), distributor(randEngine)) - cdf.begin();
+        keys.push_back(static_cast<IntType>(rank < universe ? rank : universe - 1));
+    }
+    return keys;
+}
+
+/**
+* Keeps the optimizer from discarding a benchmark result.
+*/
+template<typename T>
+inline void benchSink(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
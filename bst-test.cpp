@@ -1,5 +1,6 @@
 #include <iostream>
 #include <map>
+#include <vector>
 #include "bst.h"
 #include "avlbst.h"
 
@@ -44,5 +45,22 @@ int main(int argc, char *argv[])
     cout << "Erasing b" << endl;
     at.remove('b');
 
+    // findMany must agree with find, including for missing keys
+    AVLTree<int,int> big;
+    vector<int> keys;
+    for(int i = 0; i < 1000; i++) {
+        big.insert(std::make_pair((i * 7919) % 1000 * 2, i));
+    }
+    for(int i = -3; i < 2003; i++) {
+        keys.push_back(i);
+    }
+    vector<AVLTree<int,int>::iterator> found;
+    big.findMany(keys, found);
+    bool same = found.size() == keys.size();
+    for(size_t i = 0; same && i < keys.size(); i++) {
+        same = found[i] == big.find(keys[i]);
+    }
+    cout << "\nfindMany matches find: " << same << endl;
+
     return 0;
 }
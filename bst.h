@@ -5,6 +5,10 @@
 #include <exception>
 #include <cstdlib>
 #include <utility>
+#include <vector>
+#if __cplusplus >= 202002L
+#include "coro_find.h"
+#endif
 
 
 /**
@@ -30,6 +34,8 @@ public:
     virtual Node<Key, Value>* getParent() const;
     virtual Node<Key, Value>* getLeft() const;
     virtual Node<Key, Value>* getRight() const;
+    Node<Key, Value>* loadLeft() const;
+    Node<Key, Value>* loadRight() const;
 
     void setParent(Node<Key, Value>* parent);
     void setLeft(Node<Key, Value>* left);
@@ -145,31 +151,52 @@ Node<Key, Value>* Node<Key, Value>::getRight() const
     return right_;
 }
 
+/**
+* An acquire load of the left child, for readers that walk the tree
+* while a writer relinks it. A node reached this way is fully built,
+* since the setters publish links with release stores.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* Node<Key, Value>::loadLeft() const
+{
+    return __atomic_load_n(&left_, __ATOMIC_ACQUIRE);
+}
+
+/**
+* An acquire load of the right child, as for loadLeft.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* Node<Key, Value>::loadRight() const
+{
+    return __atomic_load_n(&right_, __ATOMIC_ACQUIRE);
+}
+
 /**
 * A setter for setting the parent of a node.
 */
 template<typename Key, typename Value>
 void Node<Key, Value>::setParent(Node<Key, Value>* parent)
 {
-    parent_ = parent;
+    __atomic_store_n(&parent_, parent, __ATOMIC_RELEASE);
 }
 
 /**
-* A setter for setting the left child of a node.
+* A setter for setting the left child of a node. The link is stored
+* atomically (a plain store on x86) so loadLeft never sees a torn one.
 */
 template<typename Key, typename Value>
 void Node<Key, Value>::setLeft(Node<Key, Value>* left)
 {
-    left_ = left;
+    __atomic_store_n(&left_, left, __ATOMIC_RELEASE);
 }
 
 /**
-* A setter for setting the right child of a node.
+* A setter for setting the right child of a node, stored like setLeft.
 */
 template<typename Key, typename Value>
 void Node<Key, Value>::setRight(Node<Key, Value>* right)
 {
-    right_ = right;
+    __atomic_store_n(&right_, right, __ATOMIC_RELEASE);
 }
 
 /**
@@ -202,6 +229,10 @@ public:
     bool isBalanced() const; //TODO
     void print() const;
     bool empty() const;
+    virtual bool duplicateKeys() const;
+
+    template<typename InputIterator>
+    void buildSorted(InputIterator first, size_t count);
 
     template<typename PPKey, typename PPValue>
     friend void prettyPrintBST(BinarySearchTree<PPKey, PPValue> & tree);
@@ -233,6 +264,12 @@ public:
     iterator begin() const;
     iterator end() const;
     iterator find(const Key& key) const;
+    iterator erase(iterator pos);
+    iterator erase(iterator first, iterator last);
+    void findMany(const std::vector<Key>& keys, std::vector<iterator>& results) const;
+#if __cplusplus >= 202002L
+    void findInterleaved(const std::vector<Key>& keys, std::vector<iterator>& results, size_t lanes = 16) const;
+#endif
     Value& operator[](const Key& key);
     Value const & operator[](const Key& key) const;
 
@@ -247,15 +284,26 @@ protected:
     // Provided helper functions
     virtual void printRoot (Node<Key, Value> *r) const;
     virtual void nodeSwap( Node<Key,Value>* n1, Node<Key,Value>* n2);
+    virtual void destroyNode(Node<Key, Value>* node);
+    virtual void removeNode(Node<Key, Value>* node);
+    virtual Node<Key, Value>* createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels);
+    virtual void childrenChanged(Node<Key, Value>* node);
 
     // Add helper functions here
     Node<Key, Value>* insertHelper(Node<Key, Value>* cur, Node<Key, Value>* parent, const std::pair<const Key, Value> &keyValuePair);
     void removeHelper(Node<Key, Value>* node, const Key& key);
     void clearHelper(Node<Key, Value>* node);
+    template<typename InputIterator>
+    Node<Key, Value>* buildHelper(InputIterator& next, size_t count, int levels);
+    static int builtHeight(size_t count);
     Node<Key, Value>* findHelper(Node<Key, Value>* cur, const Key& key) const;
+#if __cplusplus >= 202002L
+    LookupTask<Node<Key, Value>*> findCoroutine(const Key& key) const;
+#endif
     int getHeight(Node<Key, Value>* cur) const;
     bool balanceHelper(Node<Key, Value>* cur) const;
     static Node<Key, Value>* successor(Node<Key, Value>* current);
+    static iterator iteratorAt(Node<Key, Value>* node);
 
 
 protected:
@@ -458,6 +506,18 @@ bool BinarySearchTree<Key, Value>::empty() const
     return root_ == NULL;
 }
 
+/**
+* Returns true for trees that keep every item inserted, with equal keys
+* side by side, oldest first. Lookups in such a tree return the oldest
+* item of a key, which means following the search down past the first
+* match; this tree holds one item per key.
+*/
+template<class Key, class Value>
+bool BinarySearchTree<Key, Value>::duplicateKeys() const
+{
+    return false;
+}
+
 template<typename Key, typename Value>
 void BinarySearchTree<Key, Value>::print() const
 {
@@ -500,6 +560,200 @@ BinarySearchTree<Key, Value>::find(const Key & k) const
     return it;
 }
 
+/**
+* Gives derived trees, which cannot use the iterator constructor, an
+* iterator to one of their nodes.
+*/
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator
+BinarySearchTree<Key, Value>::iteratorAt(Node<Key, Value>* node)
+{
+    return iterator(node);
+}
+
+/**
+* Removes the item at pos, which must not be end(), without searching
+* for its key again, and returns an iterator to the item after it.
+* Iterators to other items stay valid: a removal may move nodes, but
+* never frees any node but pos's.
+*/
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator
+BinarySearchTree<Key, Value>::erase(iterator pos)
+{
+    iterator next = pos;
+    ++next;
+    removeNode(pos.current_);
+    return next;
+}
+
+/**
+* Removes the items in [first, last) and returns last.
+*/
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator
+BinarySearchTree<Key, Value>::erase(iterator first, iterator last)
+{
+    while (first != last)
+    {
+        first = erase(first);
+    }
+    return last;
+}
+
+/**
+* Looks up every key in keys and stores find(keys[i]) in results[i].
+*
+* A single lookup waits for one cache miss per level. Here up to
+* findLanes lookups descend together, one level each per round, and
+* each prefetches the next node it will visit, so the misses of
+* different keys overlap instead of following each other. A lane whose
+* lookup is done takes the next key right away.
+*/
+template<class Key, class Value>
+void BinarySearchTree<Key, Value>::findMany(const std::vector<Key>& keys, std::vector<iterator>& results) const
+{
+    static const size_t findLanes = 16;
+    bool oldest = duplicateKeys();
+    results.resize(keys.size());
+    Node<Key, Value>* current[findLanes];
+    Node<Key, Value>* found[findLanes];     // the oldest match so far, with duplicates
+    size_t slot[findLanes];
+    size_t next = 0;
+    size_t lanes = 0;
+    while (lanes < findLanes && next < keys.size())
+    {
+        current[lanes] = root_;
+        found[lanes] = nullptr;
+        slot[lanes++] = next++;
+    }
+    while (lanes > 0)
+    {
+        for (size_t i = 0; i < lanes; )
+        {
+            Node<Key, Value>* node = current[i];
+            const Key& key = keys[slot[i]];
+            bool match = node != nullptr && node->getKey() == key;
+            if (node == nullptr || (match && !oldest))
+            {
+                results[slot[i]] = iterator(match ? node : found[i]);
+                if (next < keys.size())
+                {
+                    current[i] = root_;
+                    found[i] = nullptr;
+                    slot[i++] = next++;
+                }
+                else
+                {
+                    // retire the lane; the last one moves into its place
+                    --lanes;
+                    current[i] = current[lanes];
+                    found[i] = found[lanes];
+                    slot[i] = slot[lanes];
+                }
+                continue;
+            }
+            if (match)
+            {
+                found[i] = node;
+                node = node->getLeft();
+            }
+            else
+            {
+                node = node->getKey() > key ? node->getLeft() : node->getRight();
+            }
+            // a node may straddle two cache lines
+            __builtin_prefetch(node);
+            __builtin_prefetch(reinterpret_cast<const char*>(node) + sizeof(Node<Key, Value>) - 1);
+            current[i++] = node;
+        }
+    }
+}
+
+#if __cplusplus >= 202002L
+/**
+* The same search as findHelper, written as a coroutine that suspends
+* after prefetching each node it moves to.
+*/
+template<class Key, class Value>
+LookupTask<Node<Key, Value>*> BinarySearchTree<Key, Value>::findCoroutine(const Key& key) const
+{
+    bool oldest = duplicateKeys();
+    Node<Key, Value>* found = nullptr;
+    Node<Key, Value>* cur = root_;
+    while (cur != nullptr)
+    {
+        if (cur->getKey() == key)
+        {
+            if (!oldest)
+            {
+                co_return cur;
+            }
+            found = cur;
+            cur = cur->getLeft();
+        }
+        else
+        {
+            cur = cur->getKey() > key ? cur->getLeft() : cur->getRight();
+        }
+        __builtin_prefetch(cur);
+        __builtin_prefetch(reinterpret_cast<const char*>(cur) + sizeof(Node<Key, Value>) - 1);
+        co_await std::suspend_always();
+    }
+    co_return found;
+}
+
+/**
+* Does what findMany does with one findCoroutine per key: up to lanes
+* lookups are in flight, and a round-robin scheduler resumes each in
+* turn, so that one lookup's cache miss is hidden behind the work of the
+* others. A lanes of 0 is taken as 1. Only available in C++20 builds.
+*/
+template<class Key, class Value>
+void BinarySearchTree<Key, Value>::findInterleaved(const std::vector<Key>& keys, std::vector<iterator>& results, size_t lanes) const
+{
+    if (lanes == 0)
+    {
+        lanes = 1;
+    }
+    results.resize(keys.size());
+    std::vector<LookupTask<Node<Key, Value>*> > tasks;
+    std::vector<size_t> slot;
+    size_t next = 0;
+    while (tasks.size() < lanes && next < keys.size())
+    {
+        tasks.push_back(findCoroutine(keys[next]));
+        slot.push_back(next++);
+    }
+    while (!tasks.empty())
+    {
+        for (size_t i = 0; i < tasks.size(); )
+        {
+            tasks[i].resume();
+            if (!tasks[i].done())
+            {
+                ++i;
+                continue;
+            }
+            results[slot[i]] = iterator(tasks[i].result());
+            if (next < keys.size())
+            {
+                tasks[i] = findCoroutine(keys[next]);
+                slot[i++] = next++;
+            }
+            else
+            {
+                // retire the lane; the last one moves into its place
+                tasks[i] = std::move(tasks.back());
+                slot[i] = slot.back();
+                tasks.pop_back();
+                slot.pop_back();
+            }
+        }
+    }
+}
+#endif
+
 /**
  * @precondition The key exists in the map
  * Returns the value associated with the key
@@ -575,11 +829,22 @@ void BinarySearchTree<Key, Value>::removeHelper(Node<Key, Value>* node, const Ke
     {
         return; 
     } 
+    // not the virtual call: derived trees build their removeNode on this one
+    BinarySearchTree<Key, Value>::removeNode(ptr);
+}
+
+/**
+* Takes node out of the tree and frees it. Derived trees that keep
+* extra invariants override this, so that erase keeps them too.
+*/
+template<class Key, class Value>
+void BinarySearchTree<Key, Value>::removeNode(Node<Key, Value>* ptr)
+{
     Node<Key,Value>* parent=ptr->getParent(); //get this key's parent
     if (ptr->getLeft()!=nullptr && ptr->getRight()!=nullptr) //case3: n has both children 
     {
         nodeSwap(predecessor(ptr), ptr);
-        removeHelper(ptr, key); 
+        BinarySearchTree<Key, Value>::removeNode(ptr); 
     }
     else if (ptr->getLeft()==nullptr && ptr->getRight()==nullptr) //case1: no children 
     {
@@ -599,7 +864,7 @@ void BinarySearchTree<Key, Value>::removeHelper(Node<Key, Value>* node, const Ke
                 parent->setLeft(nullptr); 
             }
         }
-        delete ptr; 
+        destroyNode(ptr); 
     }
     else if (ptr->getLeft()==nullptr && ptr->getRight()!=nullptr) //case2: 1 child-right child 
     {
@@ -623,7 +888,7 @@ void BinarySearchTree<Key, Value>::removeHelper(Node<Key, Value>* node, const Ke
                 rightChild->setParent(parent); 
             }
         }
-        delete ptr;
+        destroyNode(ptr);
     }
     else if (ptr->getLeft()!=nullptr && ptr->getRight()==nullptr) //case2: n has only left child  
     {
@@ -647,7 +912,7 @@ void BinarySearchTree<Key, Value>::removeHelper(Node<Key, Value>* node, const Ke
                 leftChild->setParent(parent); 
             }
         }
-        delete ptr;   
+        destroyNode(ptr);   
     }
 
 }
@@ -701,22 +966,117 @@ void BinarySearchTree<Key, Value>::clear()
 {
     // TODO
     clearHelper(root_); 
-
+    root_ = nullptr;
 }
 
+/**
+* Frees the subtree at node. It works from an explicit stack rather
+* than recursing, because trees that do not bound their height (a splay
+* tree after ascending inserts, a plain BST) can be chains a million
+* nodes long. The stack holds at most one pending right child per level
+* of the left spine, so it stays small for balanced trees.
+*/
 template<typename Key, typename Value> 
 void BinarySearchTree<Key, Value>::clearHelper(Node<Key, Value>* node)
 {
-    if (node==nullptr)
+    std::vector<Node<Key, Value>*> pending;
+    while (node != nullptr || !pending.empty())
     {
-        return; 
+        if (node == nullptr)
+        {
+            node = pending.back();
+            pending.pop_back();
+        }
+        Node<Key, Value>* left = node->getLeft();
+        if (node->getRight() != nullptr)
+        {
+            pending.push_back(node->getRight());
+        }
+        destroyNode(node);
+        node = left;
     }
-    clearHelper(node->getLeft());
-    clearHelper(node->getRight()); 
-    remove(node->getKey()); 
 }
 
 
+/**
+* Replaces the contents of the tree with the count items starting at
+* first, which must be in strictly ascending key order, or only
+* non-descending for a tree with duplicateKeys, where equal keys keep
+* their order and so the first stays the oldest. The items are
+* linked into a perfectly balanced shape in one pass, in linear time,
+* without searching or rebalancing. If reading an item throws, the
+* tree is left empty.
+*/
+template<typename Key, typename Value>
+template<typename InputIterator>
+void BinarySearchTree<Key, Value>::buildSorted(InputIterator first, size_t count)
+{
+    clear();
+    root_ = buildHelper(first, count, builtHeight(count));
+}
+
+/**
+* The height of a subtree that buildHelper makes of count items.
+*/
+template<typename Key, typename Value>
+int BinarySearchTree<Key, Value>::builtHeight(size_t count)
+{
+    int height = 0;
+    for (; count > 0; count /= 2)
+    {
+        ++height;
+    }
+    return height;
+}
+
+/**
+* Builds a subtree of the next count items and returns its root. The
+* left side gets the smaller half, so each node leans right by at most
+* one level. levels counts the levels from this subtree's root down to
+* the bottom of the whole built tree; pass builtHeight(count) at the top.
+*/
+template<typename Key, typename Value>
+template<typename InputIterator>
+Node<Key, Value>* BinarySearchTree<Key, Value>::buildHelper(InputIterator& next, size_t count, int levels)
+{
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    size_t leftCount = (count - 1) / 2;
+    size_t rightCount = count - 1 - leftCount;
+    Node<Key, Value>* left = buildHelper(next, leftCount, levels - 1);
+    Node<Key, Value>* node = nullptr;
+    Node<Key, Value>* right = nullptr;
+    try
+    {
+        node = createBuiltNode(*next, builtHeight(rightCount) - builtHeight(leftCount), levels);
+        ++next;
+        right = buildHelper(next, rightCount, levels - 1);
+    }
+    catch (...)
+    {
+        clearHelper(left);
+        if (node != nullptr)
+        {
+            destroyNode(node);
+        }
+        throw;
+    }
+    node->setLeft(left);
+    node->setRight(right);
+    if (left != nullptr)
+    {
+        left->setParent(node);
+    }
+    if (right != nullptr)
+    {
+        right->setParent(node);
+    }
+    childrenChanged(node);
+    return node;
+}
+
 /**
 * A helper function to find the smallest node in the tree.
 */
@@ -740,26 +1100,31 @@ BinarySearchTree<Key, Value>::getSmallestNode() const
 /**
 * Helper function to find a node with given key, k and
 * return a pointer to it or NULL if no item with that key
-* exists
+* exists; the oldest one if the tree keeps duplicate keys. A loop
+* rather than recursion, so that a tree of unbounded height cannot
+* overflow the stack.
 */
 template<typename Key, typename Value>  //I add it 
 Node<Key, Value>* BinarySearchTree<Key, Value>::findHelper(Node<Key, Value>* cur, const Key& key) const {
-    if (cur==nullptr)
+    bool oldest = duplicateKeys();
+    Node<Key, Value>* found = nullptr;
+    while (cur != nullptr)
     {
-        return cur; 
-    }
-    else if (cur->getKey()==key)
-    {
-        return cur; 
-    }
-    else if (cur->getKey()>key)
-    {
-        return findHelper(cur->getLeft(), key);
-    }
-    else 
-    {
-        return findHelper(cur->getRight(), key); 
+        if (cur->getKey() == key)
+        {
+            if (!oldest)
+            {
+                return cur;
+            }
+            found = cur;    // older duplicates can only be to the left
+            cur = cur->getLeft();
+        }
+        else
+        {
+            cur = cur->getKey() > key ? cur->getLeft() : cur->getRight();
+        }
     }
+    return found;
 }
 template<typename Key, typename Value>
 Node<Key, Value>* BinarySearchTree<Key, Value>::internalFind(const Key& key) const
@@ -898,6 +1263,40 @@ void BinarySearchTree<Key, Value>::nodeSwap( Node<Key,Value>* n1, Node<Key,Value
 
 }
 
+/**
+* Frees a node that remove has unlinked from the tree. Trees whose nodes
+* may still be read concurrently override this to defer the delete.
+*/
+template<typename Key, typename Value>
+void BinarySearchTree<Key, Value>::destroyNode(Node<Key, Value>* node)
+{
+    delete node;
+}
+
+/**
+* Creates an unlinked node for buildSorted. balance is the height of the
+* node's right subtree minus that of its left, and levels counts the
+* levels from the node down to the bottom of the built tree (1 for the
+* bottom level), for trees that need either.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* BinarySearchTree<Key, Value>::createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels)
+{
+    return new Node<Key, Value>(keyValuePair.first, keyValuePair.second, nullptr);
+}
+
+/**
+* Called once node has its final children, when buildSorted links them
+* and when a derived tree relinks a node in bulk, always after the same
+* call for the children themselves. For trees that keep data about each
+* subtree on its root; there is none here.
+*/
+template<typename Key, typename Value>
+void BinarySearchTree<Key, Value>::childrenChanged(Node<Key, Value>* node)
+{
+
+}
+
 /**
  * Lastly, we are providing you with a print function,
    BinarySearchTree::printRoot().
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "btree.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Lookup and scan throughput of BTree against AVLTree.
+//
+// usage: btree-bench [keys ...]     (default: 1000000)
+// e.g.   btree-bench 1000000 10000000 100000000
+
+template<typename Tree>
+void measure(const char* name, const vector<uint64_t>& keys, const vector<uint64_t>& probes)
+{
+    BenchTimer timer;
+    Tree tree;
+    for(size_t i = 0; i < keys.size(); i++) {
+        tree.insert(make_pair(keys[i], keys[i]));
+    }
+    double buildSeconds = timer.seconds();
+
+    timer.restart();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < probes.size(); i++) {
+        typename Tree::iterator it = tree.find(probes[i]);
+        if(it != tree.end()) {
+            sum += it->second;
+        }
+    }
+    double lookupSeconds = timer.seconds();
+
+    timer.restart();
+    for(typename Tree::iterator it = tree.begin(); it != tree.end(); ++it) {
+        sum += it->second;
+    }
+    double scanSeconds = timer.seconds();
+    benchSink(sum);
+
+    cout << name << "\t" << keys.size()
+         << "\tbuild " << buildSeconds << " s"
+         << "\tlookup " << probes.size() / lookupSeconds / 1e6 << " M/s"
+         << "\tscan " << keys.size() / scanSeconds / 1e6 << " M/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1, 2);
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(1000000, 0, 2 * sizes[s] - 1, 2);
+        measure<AVLTree<uint64_t, uint64_t> >("AVLTree", keys, probes);
+        measure<BTree<uint64_t, uint64_t> >("BTree", keys, probes);
+    }
+    return 0;
+}
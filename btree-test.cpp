@@ -0,0 +1,109 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <type_traits>
+#include "btree.h"
+
+using namespace std;
+
+// Checks that in-order iteration over the tree matches expected.
+template<typename Tree, typename K, typename V>
+bool sameContents(const Tree& tree, const map<K, V>& expected)
+{
+    typename map<K, V>::const_iterator exp = expected.begin();
+    for(typename Tree::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end() && tree.size() == expected.size();
+}
+
+// Random inserts and removes against std::map, with small nodes so that
+// splits, borrows and merges all happen.
+template<typename Tree>
+bool randomOps(Tree& tree, int ops, int range)
+{
+    typedef typename remove_const<typename remove_reference<decltype(tree.begin()->first)>::type>::type Key;
+    map<Key, int> model;
+    for(int i = 0; i < ops; i++) {
+        Key key = rand() % range;
+        if(rand() % 3 == 0) {
+            tree.remove(key);
+            model.erase(key);
+        }
+        else {
+            tree.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        if(i % 500 == 0 && !sameContents(tree, model)) {
+            return false;
+        }
+    }
+    for(Key key = 0; key < Key(range); key++) {
+        bool inTree = tree.find(key) != tree.end();
+        if(inTree != (model.count(key) > 0) || (inTree && tree[key] != model[key])) {
+            return false;
+        }
+        typename Tree::iterator lb = tree.lower_bound(key);
+        typename map<Key, int>::iterator mlb = model.lower_bound(key);
+        if((lb == tree.end()) != (mlb == model.end()) || (mlb != model.end() && lb->first != mlb->first)) {
+            return false;
+        }
+    }
+    while(!model.empty()) {
+        tree.remove(model.begin()->first);
+        model.erase(model.begin());
+    }
+    return tree.empty() && tree.begin() == tree.end();
+}
+
+int main(int argc, char *argv[])
+{
+    srand(104);
+    BTree<int, int, 3> tiny;
+    cout << "B=3 random ops: " << randomOps(tiny, 20000, 2000) << endl;
+    BTree<int, int, 4> small;
+    cout << "B=4 random ops: " << randomOps(small, 20000, 2000) << endl;
+    BTree<int, int> wide;
+    cout << "Default B random ops: " << randomOps(wide, 50000, 5000) << endl;
+
+    // Every search kernel the CPU has must give the same answers
+    const char* kernelNames[] = { "scalar", "SSE4.2", "AVX2" };
+    SearchKernel kernels[] = { SCALAR_SEARCH, SSE42_SEARCH, AVX2_SEARCH };
+    for(int k = 0; k < 3; k++) {
+        if(!KeySearch<uint64_t>::setKernel(kernels[k]) || !KeySearch<uint32_t>::setKernel(kernels[k])) {
+            cout << kernelNames[k] << " kernel: not supported" << endl;
+            continue;
+        }
+        BTree<uint64_t, int> wide64;
+        BTree<uint32_t, int> wide32;
+        BTree<uint64_t, int, 5> odd64;
+        bool ok = randomOps(wide64, 20000, 3000) && randomOps(wide32, 20000, 3000) && randomOps(odd64, 20000, 3000);
+        uint64_t big[] = { 1, 5, UINT64_MAX - 1, UINT64_MAX };
+        ok = ok && KeySearch<uint64_t>::countLess(big, 4, UINT64_MAX) == 3
+                && KeySearch<uint64_t>::countLessEqual(big, 4, UINT64_MAX) == 4
+                && KeySearch<uint64_t>::countLess(big, 4, 0) == 0
+                && KeySearch<uint64_t>::countLessEqual(big, 4, 5) == 2;
+        cout << kernelNames[k] << " kernel: " << ok << endl;
+    }
+
+    BTree<string, string, 4> names;
+    map<string, string> nameModel;
+    for(int i = 0; i < 300; i++) {
+        string key = "key" + to_string(rand() % 200);
+        names.insert(make_pair(key, to_string(i)));
+        nameModel[key] = to_string(i);
+    }
+    for(int i = 0; i < 100; i++) {
+        string key = "key" + to_string(rand() % 200);
+        names.remove(key);
+        nameModel.erase(key);
+    }
+    cout << "String keys: " << sameContents(names, nameModel) << endl;
+    names.clear();
+    cout << "Cleared: " << names.empty() << endl;
+    return 0;
+}
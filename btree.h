@@ -0,0 +1,710 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simd_search.h"
+
+/**
+* The default BTree fan-out: as many keys as fit, next to the node
+* header, in the fewest whole cache lines that hold at least four keys.
+* That is 7 keys of 8 bytes or 14 of 4 bytes in one line.
+*/
+template <class Key>
+struct BTreeFanout
+{
+    static const size_t header = 8;     // BNode's count_ and leaf_, padded
+    static const size_t lines = (4 * sizeof(Key) + header + 63) / 64;
+    static const int value = static_cast<int>((lines * 64 - header) / sizeof(Key));
+};
+
+/**
+* A B+-tree with the same map interface as BinarySearchTree: insert,
+* remove, find, operator[] and an in-order iterator.
+*
+* A binary tree pays a cache miss per level. Here every node holds up to
+* B keys in one contiguous array, and nodes start on a 64-byte cache line.
+* By default B is chosen so that the keys and the node header fill whole
+* lines (one line for keys of up to 8 bytes). The child pointers of an
+* inner node, and the items of a leaf, follow in lines of their own, so
+* each level of a lookup reads the key line and then the line holding the
+* one pointer or item it needs: about 2 log_B(n) lines instead of
+* log_2(n) nodes. Items live only in the
+* leaves, which are chained left to right, so in-order scans read
+* consecutive slots instead of climbing parents.
+*
+* Inner nodes route with separator keys: child i holds the keys in
+* [keys_[i-1], keys_[i]). Every node but the root holds at least B/2
+* keys, which bounds the height by log_{B/2}(n) + 1.
+*
+* Searching inside a node goes through KeySearch (simd_search.h), which
+* uses vectorized compare-and-count kernels for uint32_t and uint64_t keys.
+*/
+template <class Key, class Value, int B = BTreeFanout<Key>::value>
+class BTree
+{
+private:
+    static_assert(B >= 3, "BTree nodes need room for at least three keys");
+    static const int minKeys_ = B / 2;
+
+    typedef std::pair<const Key, Value> Item;
+
+    struct alignas(64) BNode
+    {
+        explicit BNode(bool leaf) : count_(0), leaf_(leaf)
+        {
+
+        }
+
+        // Plain new only guarantees 16-byte alignment before C++17.
+        static void* operator new(size_t size)
+        {
+            void* ptr;
+            if (posix_memalign(&ptr, 64, size) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+        static void operator delete(void* ptr)
+        {
+            free(ptr);
+        }
+
+        Key keys_[B];
+        int count_;
+        bool leaf_;
+    };
+
+    static_assert(sizeof(BNode) % 64 == 0, "BTree nodes must be whole cache lines");
+    static_assert(B != BTreeFanout<Key>::value || sizeof(BNode) == BTreeFanout<Key>::lines * 64,
+        "the default fan-out must fill its cache lines with keys and header");
+
+    struct Inner : public BNode
+    {
+        Inner() : BNode(false)
+        {
+
+        }
+
+        BNode* children_[B + 1];
+    };
+
+    /**
+    * Keys are kept apart from the items so that searching a leaf reads
+    * only the key array. Items are constructed in place as they come and go.
+    */
+    struct Leaf : public BNode
+    {
+        Leaf() : BNode(true), next_(nullptr)
+        {
+
+        }
+
+        Item* item(int i)
+        {
+            return reinterpret_cast<Item*>(&items_[i]);
+        }
+
+        typename std::aligned_storage<sizeof(Item), alignof(Item)>::type items_[B];
+        Leaf* next_;
+    };
+
+public:
+    BTree();
+    ~BTree();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    bool empty() const;
+    size_t size() const;
+
+    /**
+    * An iterator for traversing the items in key order.
+    */
+    class iterator
+    {
+    public:
+        iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class BTree<Key, Value, B>;
+        iterator(Leaf* leaf, int index);
+
+        Leaf* leaf_;
+        int index_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    Value& operator[](const Key& key);
+    Value const & operator[](const Key& key) const;
+
+protected:
+    static int countLess(const Key* keys, int count, const Key& key);
+    static int countLessEqual(const Key* keys, int count, const Key& key);
+
+    Leaf* findLeaf(const Key& key) const;
+    bool insertHelper(BNode* node, const Item& keyValuePair, Key& upKey, BNode*& upNode);
+    bool removeHelper(BNode* node, const Key& key);
+    void fixChild(Inner* parent, int i);
+    void clearHelper(BNode* node);
+
+    static void moveItem(Leaf* dst, int dstIndex, Leaf* src, int srcIndex);
+    static void shiftItems(Leaf* leaf, int from, int by);
+
+    BNode* root_;
+    size_t size_;
+};
+
+/*
+-----------------------------------------------------
+Begin implementations for the BTree::iterator class.
+-----------------------------------------------------
+*/
+
+template<class Key, class Value, int B>
+BTree<Key, Value, B>::iterator::iterator() :
+    leaf_(nullptr),
+    index_(0)
+{
+
+}
+
+template<class Key, class Value, int B>
+BTree<Key, Value, B>::iterator::iterator(Leaf* leaf, int index) :
+    leaf_(leaf),
+    index_(index)
+{
+
+}
+
+template<class Key, class Value, int B>
+std::pair<const Key, Value>& BTree<Key, Value, B>::iterator::operator*() const
+{
+    return *leaf_->item(index_);
+}
+
+template<class Key, class Value, int B>
+std::pair<const Key, Value>* BTree<Key, Value, B>::iterator::operator->() const
+{
+    return leaf_->item(index_);
+}
+
+template<class Key, class Value, int B>
+bool BTree<Key, Value, B>::iterator::operator==(const iterator& rhs) const
+{
+    return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+}
+
+template<class Key, class Value, int B>
+bool BTree<Key, Value, B>::iterator::operator!=(const iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+* Advances to the next slot, moving on to the next leaf at the end of this one.
+*/
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::iterator& BTree<Key, Value, B>::iterator::operator++()
+{
+    if (++index_ == leaf_->count_)
+    {
+        leaf_ = leaf_->next_;
+        index_ = 0;
+    }
+    return *this;
+}
+
+/*
+---------------------------------------------------
+End implementations for the BTree::iterator class.
+---------------------------------------------------
+*/
+
+template<class Key, class Value, int B>
+BTree<Key, Value, B>::BTree() :
+    root_(new Leaf()),
+    size_(0)
+{
+
+}
+
+template<class Key, class Value, int B>
+BTree<Key, Value, B>::~BTree()
+{
+    clearHelper(root_);
+}
+
+template<class Key, class Value, int B>
+bool BTree<Key, Value, B>::empty() const
+{
+    return size_ == 0;
+}
+
+template<class Key, class Value, int B>
+size_t BTree<Key, Value, B>::size() const
+{
+    return size_;
+}
+
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::clear()
+{
+    clearHelper(root_);
+    root_ = new Leaf();
+    size_ = 0;
+}
+
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::clearHelper(BNode* node)
+{
+    if (node->leaf_)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        for (int i = 0; i < leaf->count_; ++i)
+        {
+            leaf->item(i)->~Item();
+        }
+        delete leaf;
+        return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for (int i = 0; i <= inner->count_; ++i)
+    {
+        clearHelper(inner->children_[i]);
+    }
+    delete inner;
+}
+
+/**
+* Returns how many of the sorted keys are less than key: the slot key
+* belongs in within a leaf.
+*/
+template<class Key, class Value, int B>
+int BTree<Key, Value, B>::countLess(const Key* keys, int count, const Key& key)
+{
+    return KeySearch<Key>::countLess(keys, count, key);
+}
+
+/**
+* Returns how many of the sorted keys are less than or equal to key: the
+* child of an inner node that key routes to.
+*/
+template<class Key, class Value, int B>
+int BTree<Key, Value, B>::countLessEqual(const Key* keys, int count, const Key& key)
+{
+    return KeySearch<Key>::countLessEqual(keys, count, key);
+}
+
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::Leaf* BTree<Key, Value, B>::findLeaf(const Key& key) const
+{
+    BNode* node = root_;
+    while (!node->leaf_)
+    {
+        Inner* inner = static_cast<Inner*>(node);
+        node = inner->children_[countLessEqual(inner->keys_, inner->count_, key)];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::iterator BTree<Key, Value, B>::begin() const
+{
+    BNode* node = root_;
+    while (!node->leaf_)
+    {
+        node = static_cast<Inner*>(node)->children_[0];
+    }
+    if (node->count_ == 0)
+    {
+        return end();
+    }
+    return iterator(static_cast<Leaf*>(node), 0);
+}
+
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::iterator BTree<Key, Value, B>::end() const
+{
+    return iterator();
+}
+
+/**
+* Returns an iterator to the item with the given key, k
+* or the end iterator if k does not exist in the tree
+*/
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::iterator BTree<Key, Value, B>::find(const Key& key) const
+{
+    Leaf* leaf = findLeaf(key);
+    int i = countLess(leaf->keys_, leaf->count_, key);
+    if (i < leaf->count_ && leaf->keys_[i] == key)
+    {
+        return iterator(leaf, i);
+    }
+    return end();
+}
+
+/**
+* Returns an iterator to the first item whose key is not less than key,
+* or the end iterator if there is none.
+*/
+template<class Key, class Value, int B>
+typename BTree<Key, Value, B>::iterator BTree<Key, Value, B>::lower_bound(const Key& key) const
+{
+    Leaf* leaf = findLeaf(key);
+    int i = countLess(leaf->keys_, leaf->count_, key);
+    if (i == leaf->count_)
+    {
+        // separators may be stale, so the answer can start the next leaf
+        leaf = leaf->next_;
+        i = 0;
+    }
+    return leaf == nullptr ? end() : iterator(leaf, i);
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns the value associated with the key
+ */
+template<class Key, class Value, int B>
+Value& BTree<Key, Value, B>::operator[](const Key& key)
+{
+    iterator it = find(key);
+    if(it == end()) throw std::out_of_range("Invalid key");
+    return it->second;
+}
+
+template<class Key, class Value, int B>
+Value const & BTree<Key, Value, B>::operator[](const Key& key) const
+{
+    iterator it = find(key);
+    if(it == end()) throw std::out_of_range("Invalid key");
+    return it->second;
+}
+
+/**
+* Moves the item in src slot srcIndex into the empty dst slot dstIndex.
+*/
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::moveItem(Leaf* dst, int dstIndex, Leaf* src, int srcIndex)
+{
+    Item* from = src->item(srcIndex);
+    new (dst->item(dstIndex)) Item(from->first, std::move(from->second));
+    from->~Item();
+    dst->keys_[dstIndex] = src->keys_[srcIndex];
+}
+
+/**
+* Shifts the items from slot from to the end of the leaf by slots to the
+* right (by > 0) or left (by < 0). The slots shifted into must be empty.
+* The count is left to the caller.
+*/
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::shiftItems(Leaf* leaf, int from, int by)
+{
+    if (by > 0)
+    {
+        for (int i = leaf->count_ - 1; i >= from; --i)
+        {
+            moveItem(leaf, i + by, leaf, i);
+        }
+    }
+    else
+    {
+        for (int i = from; i < leaf->count_; ++i)
+        {
+            moveItem(leaf, i + by, leaf, i);
+        }
+    }
+}
+
+/**
+* Inserts into the subtree at node. If node had to split, returns true
+* with the new right sibling in upNode and its separator in upKey.
+* Recall: If key is already in the tree, you should
+* overwrite the current value with the updated value.
+*/
+template<class Key, class Value, int B>
+bool BTree<Key, Value, B>::insertHelper(BNode* node, const Item& keyValuePair, Key& upKey, BNode*& upNode)
+{
+    if (node->leaf_)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        int pos = countLess(leaf->keys_, leaf->count_, keyValuePair.first);
+        if (pos < leaf->count_ && leaf->keys_[pos] == keyValuePair.first)
+        {
+            leaf->item(pos)->second = keyValuePair.second;
+            return false;
+        }
+        Leaf* target = leaf;
+        bool split = false;
+        if (leaf->count_ == B)
+        {
+            // split first, then insert into whichever half the key belongs to
+            Leaf* right = new Leaf();
+            int mid = B / 2;
+            for (int i = mid; i < B; ++i)
+            {
+                moveItem(right, i - mid, leaf, i);
+            }
+            right->count_ = B - mid;
+            leaf->count_ = mid;
+            right->next_ = leaf->next_;
+            leaf->next_ = right;
+            if (pos >= mid)
+            {
+                target = right;
+                pos -= mid;
+            }
+            upNode = right;
+            split = true;
+        }
+        shiftItems(target, pos, 1);
+        new (target->item(pos)) Item(keyValuePair);
+        target->keys_[pos] = keyValuePair.first;
+        ++target->count_;
+        ++size_;
+        if (split)
+        {
+            upKey = static_cast<Leaf*>(upNode)->keys_[0];
+        }
+        return split;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    int i = countLessEqual(inner->keys_, inner->count_, keyValuePair.first);
+    Key childKey;
+    BNode* childNode;
+    if (!insertHelper(inner->children_[i], keyValuePair, childKey, childNode))
+    {
+        return false;
+    }
+    Inner* target = inner;
+    bool split = false;
+    if (inner->count_ == B)
+    {
+        // keys_[mid] moves up; the right half takes everything after it
+        Inner* right = new Inner();
+        int mid = B / 2;
+        upKey = inner->keys_[mid];
+        for (int j = mid + 1; j < B; ++j)
+        {
+            right->keys_[j - mid - 1] = inner->keys_[j];
+        }
+        for (int j = mid + 1; j <= B; ++j)
+        {
+            right->children_[j - mid - 1] = inner->children_[j];
+        }
+        right->count_ = B - mid - 1;
+        inner->count_ = mid;
+        if (i > mid)
+        {
+            target = right;
+            i -= mid + 1;
+        }
+        upNode = right;
+        split = true;
+    }
+    for (int j = target->count_; j > i; --j)
+    {
+        target->keys_[j] = target->keys_[j - 1];
+        target->children_[j + 1] = target->children_[j];
+    }
+    target->keys_[i] = childKey;
+    target->children_[i + 1] = childNode;
+    ++target->count_;
+    return split;
+}
+
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    Key upKey;
+    BNode* upNode;
+    if (insertHelper(root_, keyValuePair, upKey, upNode))
+    {
+        Inner* root = new Inner();
+        root->keys_[0] = upKey;
+        root->children_[0] = root_;
+        root->children_[1] = upNode;
+        root->count_ = 1;
+        root_ = root;
+    }
+}
+
+/**
+* Refills parent's child i after it dropped below minKeys_, by borrowing
+* from a sibling that can spare a key or else merging with one.
+*/
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::fixChild(Inner* parent, int i)
+{
+    BNode* child = parent->children_[i];
+    BNode* left = i > 0 ? parent->children_[i - 1] : nullptr;
+    BNode* right = i < parent->count_ ? parent->children_[i + 1] : nullptr;
+
+    if (left != nullptr && left->count_ > minKeys_) // borrow from the left sibling
+    {
+        if (child->leaf_)
+        {
+            Leaf* to = static_cast<Leaf*>(child);
+            Leaf* from = static_cast<Leaf*>(left);
+            shiftItems(to, 0, 1);
+            moveItem(to, 0, from, from->count_ - 1);
+            parent->keys_[i - 1] = to->keys_[0];
+        }
+        else
+        {
+            Inner* to = static_cast<Inner*>(child);
+            Inner* from = static_cast<Inner*>(left);
+            for (int j = to->count_; j > 0; --j)
+            {
+                to->keys_[j] = to->keys_[j - 1];
+            }
+            for (int j = to->count_ + 1; j > 0; --j)
+            {
+                to->children_[j] = to->children_[j - 1];
+            }
+            to->keys_[0] = parent->keys_[i - 1];
+            to->children_[0] = from->children_[from->count_];
+            parent->keys_[i - 1] = from->keys_[from->count_ - 1];
+        }
+        ++child->count_;
+        --left->count_;
+        return;
+    }
+    if (right != nullptr && right->count_ > minKeys_) // borrow from the right sibling
+    {
+        if (child->leaf_)
+        {
+            Leaf* to = static_cast<Leaf*>(child);
+            Leaf* from = static_cast<Leaf*>(right);
+            moveItem(to, to->count_, from, 0);
+            shiftItems(from, 1, -1);
+            parent->keys_[i] = from->keys_[0];
+        }
+        else
+        {
+            Inner* to = static_cast<Inner*>(child);
+            Inner* from = static_cast<Inner*>(right);
+            to->keys_[to->count_] = parent->keys_[i];
+            to->children_[to->count_ + 1] = from->children_[0];
+            parent->keys_[i] = from->keys_[0];
+            for (int j = 0; j + 1 < from->count_; ++j)
+            {
+                from->keys_[j] = from->keys_[j + 1];
+            }
+            for (int j = 0; j < from->count_; ++j)
+            {
+                from->children_[j] = from->children_[j + 1];
+            }
+        }
+        ++child->count_;
+        --right->count_;
+        return;
+    }
+
+    // merge the right node of the pair into the left one
+    int sep = left != nullptr ? i - 1 : i;
+    BNode* into = parent->children_[sep];
+    BNode* gone = parent->children_[sep + 1];
+    if (into->leaf_)
+    {
+        Leaf* to = static_cast<Leaf*>(into);
+        Leaf* from = static_cast<Leaf*>(gone);
+        for (int j = 0; j < from->count_; ++j)
+        {
+            moveItem(to, to->count_ + j, from, j);
+        }
+        to->count_ += from->count_;
+        to->next_ = from->next_;
+        delete from;
+    }
+    else
+    {
+        Inner* to = static_cast<Inner*>(into);
+        Inner* from = static_cast<Inner*>(gone);
+        to->keys_[to->count_] = parent->keys_[sep];
+        for (int j = 0; j < from->count_; ++j)
+        {
+            to->keys_[to->count_ + 1 + j] = from->keys_[j];
+        }
+        for (int j = 0; j <= from->count_; ++j)
+        {
+            to->children_[to->count_ + 1 + j] = from->children_[j];
+        }
+        to->count_ += from->count_ + 1;
+        delete from;
+    }
+    for (int j = sep; j + 1 < parent->count_; ++j)
+    {
+        parent->keys_[j] = parent->keys_[j + 1];
+    }
+    for (int j = sep + 1; j < parent->count_; ++j)
+    {
+        parent->children_[j] = parent->children_[j + 1];
+    }
+    --parent->count_;
+}
+
+/**
+* Removes key from the subtree at node. Returns true if node is left
+* with fewer than minKeys_ keys, for the caller to fix.
+*/
+template<class Key, class Value, int B>
+bool BTree<Key, Value, B>::removeHelper(BNode* node, const Key& key)
+{
+    if (node->leaf_)
+    {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        int pos = countLess(leaf->keys_, leaf->count_, key);
+        if (pos == leaf->count_ || !(leaf->keys_[pos] == key))
+        {
+            return false;
+        }
+        leaf->item(pos)->~Item();
+        shiftItems(leaf, pos + 1, -1);
+        --leaf->count_;
+        --size_;
+        return leaf->count_ < minKeys_;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    int i = countLessEqual(inner->keys_, inner->count_, key);
+    if (removeHelper(inner->children_[i], key))
+    {
+        fixChild(inner, i);
+    }
+    return inner->count_ < minKeys_;
+}
+
+template<class Key, class Value, int B>
+void BTree<Key, Value, B>::remove(const Key& key)
+{
+    removeHelper(root_, key);
+    if (!root_->leaf_ && root_->count_ == 0)
+    {
+        Inner* oldRoot = static_cast<Inner*>(root_);
+        root_ = oldRoot->children_[0];
+        delete oldRoot;
+    }
+}
+
+#endif
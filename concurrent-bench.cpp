@@ -0,0 +1,157 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "avlbst.h"
+#include "concurrent_avlbst.h"
+#include "skiplist_map.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Throughput of the concurrent trees against an AVLTree behind one
+// global mutex:
+//   - read-mostly: 95% lookups / 5% insert-or-remove, ConcurrentAVLTree
+//     and SkipListMap
+//   - write-heavy: 50% lookups / 50% insert-or-remove, with
+//     ConcurrentAVLTree (one writer at a time), LockCouplingScapegoatTree and
+//     SkipListMap (lock-free), and how many rebuilds, each of which stalls
+//     the whole lock-coupling tree, loading the keys and then the mix set
+//     off
+//
+// usage: concurrent-bench [keys] [ops per thread] [max threads]
+
+/**
+* The baseline: every call takes the same lock.
+*/
+class MutexAVLTree
+{
+public:
+    void insert(const pair<const uint64_t, uint64_t>& keyValuePair)
+    {
+        lock_guard<mutex> lock(mutex_);
+        tree_.insert(keyValuePair);
+    }
+    void remove(uint64_t key)
+    {
+        lock_guard<mutex> lock(mutex_);
+        tree_.remove(key);
+    }
+    bool find(uint64_t key, uint64_t& value)
+    {
+        lock_guard<mutex> lock(mutex_);
+        AVLTree<uint64_t, uint64_t>::iterator it = tree_.find(key);
+        if (it == tree_.end())
+        {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+private:
+    mutex mutex_;
+    AVLTree<uint64_t, uint64_t> tree_;
+};
+
+template<typename Tree>
+double runMix(Tree& tree, uint64_t keys, size_t opsPerThread, unsigned threads, unsigned writeEvery)
+{
+    vector<thread> workers;
+    BenchTimer timer;
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.push_back(thread([&tree, keys, opsPerThread, t, writeEvery]()
+        {
+            vector<uint64_t> picks = makeUniformKeys<uint64_t>(opsPerThread, 0, 2 * keys - 1, 1000 + t);
+            uint64_t found = 0;
+            for (size_t i = 0; i < opsPerThread; ++i)
+            {
+                uint64_t key = picks[i];
+                if (i % writeEvery == 0)
+                {
+                    if (key & 1)
+                    {
+                        tree.remove(key & ~uint64_t(1));
+                    }
+                    else
+                    {
+                        tree.insert(make_pair(key, key));
+                    }
+                }
+                else
+                {
+                    uint64_t value;
+                    found += tree.find(key, value);
+                }
+            }
+            benchSink(found);
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t)
+    {
+        workers[t].join();
+    }
+    return threads * opsPerThread / timer.seconds() / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t keys = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+    size_t ops = argc > 2 ? strtoull(argv[2], NULL, 10) : 500000;
+    unsigned maxThreads = argc > 3 ? atoi(argv[3]) : thread::hardware_concurrency();
+    if (maxThreads == 0)
+    {
+        maxThreads = 1;
+    }
+
+    vector<uint64_t> initial = makeShuffledKeys<uint64_t>(keys, 1, 2);
+    cout << "keys=" << keys << " ops/thread=" << ops << endl;
+    cout << "read-mostly (95/5)" << endl;
+    cout << "threads\tmutex Mops/s\tseqlock Mops/s\tskip list Mops/s" << endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        MutexAVLTree locked;
+        ConcurrentAVLTree<uint64_t, uint64_t> optimistic;
+        SkipListMap<uint64_t, uint64_t> skipList;
+        for (size_t i = 0; i < initial.size(); ++i)
+        {
+            locked.insert(make_pair(initial[i], initial[i]));
+            optimistic.insert(make_pair(initial[i], initial[i]));
+            skipList.insert(make_pair(initial[i], initial[i]));
+        }
+        double lockedRate = runMix(locked, keys, ops, threads, 20);
+        double optimisticRate = runMix(optimistic, keys, ops, threads, 20);
+        double skipListRate = runMix(skipList, keys, ops, threads, 20);
+        cout << threads << "\t" << lockedRate << "\t\t" << optimisticRate
+             << "\t\t" << skipListRate << endl;
+    }
+
+    cout << "write-heavy (50/50)" << endl;
+    cout << "threads\tmutex Mops/s\tseqlock Mops/s\tlock-coupling Mops/s\tskip list Mops/s\tload rebuilds\tmix rebuilds" << endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        MutexAVLTree locked;
+        ConcurrentAVLTree<uint64_t, uint64_t> optimistic;
+        LockCouplingScapegoatTree<uint64_t, uint64_t> coupled;
+        SkipListMap<uint64_t, uint64_t> skipList;
+        for (size_t i = 0; i < initial.size(); ++i)
+        {
+            locked.insert(make_pair(initial[i], initial[i]));
+            optimistic.insert(make_pair(initial[i], initial[i]));
+            coupled.insert(make_pair(initial[i], initial[i]));
+            skipList.insert(make_pair(initial[i], initial[i]));
+        }
+        double lockedRate = runMix(locked, keys, ops, threads, 2);
+        double optimisticRate = runMix(optimistic, keys, ops, threads, 2);
+        size_t loadRebuilds = coupled.rebuilds();
+        double coupledRate = runMix(coupled, keys, ops, threads, 2);
+        double skipListRate = runMix(skipList, keys, ops, threads, 2);
+        cout << threads << "\t" << lockedRate << "\t\t" << optimisticRate
+             << "\t\t" << coupledRate << "\t\t\t" << skipListRate
+             << "\t\t" << loadRebuilds << "\t\t" << coupled.rebuilds() - loadRebuilds << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include "concurrent_avlbst.h"
+
+using namespace std;
+
+const int writers = 4;
+const int readers = 4;
+const int keysPerWriter = 2000;
+const int stableKeys = 500;
+
+// Single-threaded updates against a std::map, and operator[] on a miss.
+template<typename Tree>
+bool singleThreaded(unsigned seed)
+{
+    Tree tree;
+    map<int, int> model;
+    srand(seed);
+    bool ok = tree.empty();
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 2000;
+        int op = rand() % 3;
+        if(op == 0) {
+            tree.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else if(op == 1) {
+            tree.remove(key);
+            model.erase(key);
+        }
+        else {
+            int value = -1;
+            bool found = tree.find(key, value);
+            ok = ok && found == (model.count(key) > 0) && (!found || value == model[key])
+                 && tree.contains(key) == found;
+        }
+    }
+    bool threw = false;
+    try {
+        tree[-1];
+    }
+    catch(out_of_range&) {
+        threw = true;
+    }
+    return ok && threw && tree.empty() == model.empty();
+}
+
+// Writers own disjoint keys (key % writers) and check every lookup of
+// their own keys against a private model, while also flipping the
+// values of a set of stable keys between -key and -3 * key. Readers
+// look the stable keys up throughout: each must always be there, with
+// one of its two values, and keys nobody inserts must never show up.
+// At the end the tree must hold exactly the union of the models.
+template<typename Tree, typename Value, typename MakeValue>
+bool racingUpdates(MakeValue makeValue)
+{
+    Tree tree;
+    for(int key = -stableKeys; key < 0; key++) {
+        tree.insert(make_pair(key, makeValue(-key)));
+    }
+    vector<map<int, Value> > models(writers);
+    atomic<bool> writing(true);
+    atomic<int> failures(0);
+    vector<thread> threads;
+    for(int t = 0; t < writers; t++) {
+        threads.push_back(thread([&, t]() {
+            unsigned seed = 26 + t;
+            map<int, Value>& model = models[t];
+            for(int i = 0; i < 30000; i++) {
+                int key = (rand_r(&seed) % keysPerWriter) * writers + t;
+                int op = rand_r(&seed) % 4;
+                if(op == 0) {
+                    tree.insert(make_pair(key, makeValue(i)));
+                    model[key] = makeValue(i);
+                }
+                else if(op == 1) {
+                    tree.remove(key);
+                    model.erase(key);
+                }
+                else if(op == 2) {
+                    Value value = Value();
+                    bool found = tree.find(key, value);
+                    if(found != (model.count(key) > 0) || (found && !(value == model[key]))) {
+                        failures++;
+                    }
+                }
+                else {
+                    int stable = -1 - rand_r(&seed) % stableKeys;
+                    tree.insert(make_pair(stable, makeValue(i % 2 ? -stable : -3 * stable)));
+                }
+            }
+        }));
+    }
+    for(int r = 0; r < readers; r++) {
+        threads.push_back(thread([&, r]() {
+            unsigned seed = 126 + r;
+            while(writing.load()) {
+                int stable = -1 - rand_r(&seed) % stableKeys;
+                Value value = Value();
+                if(!tree.find(stable, value) || !(value == makeValue(-stable) || value == makeValue(-3 * stable))) {
+                    failures++;
+                }
+                if(tree.contains(writers * keysPerWriter + rand_r(&seed) % 1000)) {
+                    failures++;
+                }
+            }
+        }));
+    }
+    for(int t = 0; t < writers; t++) {
+        threads[t].join();
+    }
+    writing.store(false);
+    for(size_t t = writers; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    bool ok = failures.load() == 0;
+    for(int t = 0; t < writers; t++) {
+        for(int key = t; key < writers * keysPerWriter; key += writers) {
+            Value value = Value();
+            bool found = tree.find(key, value);
+            ok = ok && found == (models[t].count(key) > 0) && (!found || value == models[t][key]);
+        }
+    }
+    return ok;
+}
+
+int intValue(int i)
+{
+    return i;
+}
+
+// Long enough not to fit the small-string buffer, so a torn copy shows.
+string stringValue(int i)
+{
+    return string(40, 'a' + i % 26) + to_string(i);
+}
+
+int main(int argc, char *argv[])
+{
+    cout << "ConcurrentAVLTree single-threaded: "
+         << singleThreaded<ConcurrentAVLTree<int, int> >(26) << endl;
+    cout << "ConcurrentAVLTree racing updates: "
+         << racingUpdates<ConcurrentAVLTree<int, int>, int>(intValue) << endl;
+    cout << "ConcurrentAVLTree string values: "
+         << racingUpdates<ConcurrentAVLTree<int, string>, string>(stringValue) << endl;
+    cout << "LockCouplingScapegoatTree single-threaded: "
+         << singleThreaded<LockCouplingScapegoatTree<int, int> >(27) << endl;
+    cout << "LockCouplingScapegoatTree racing updates: "
+         << racingUpdates<LockCouplingScapegoatTree<int, int>, int>(intValue) << endl;
+    cout << "LockCouplingScapegoatTree string values: "
+         << racingUpdates<LockCouplingScapegoatTree<int, string>, string>(stringValue) << endl;
+    return 0;
+}
@@ -0,0 +1,849 @@
+#ifndef CONCURRENT_AVLBST_H
+#define CONCURRENT_AVLBST_H
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+#include <type_traits>
+#include "avlbst.h"
+#include "epoch.h"
+
+/**
+* A thread-safe wrapper around AVLTree for read-mostly workloads.
+*
+* Writers are serialized by a mutex and go through the normal
+* AVLTree::insert/remove (and therefore insertFix/removeFix).
+* Readers never lock and never write shared memory: they walk the tree
+* optimistically and validate the walk against a sequence counter (a
+* seqlock), retrying if a writer ran at the same time.
+*
+* Optimistic readers may be in the middle of a walk while a writer links
+* in a new node, rotates or unlinks a node, so those writes run alongside
+* them. Links are read with acquire loads (Node::loadLeft/loadRight) and
+* written with release stores, and the root is published through an
+* atomic, so a walk never races with a relink. Unlinked nodes are handed
+* to the EpochManager rather than deleted, and readers walk inside an
+* EpochGuard, so a reader never touches freed memory. The guard is also
+* how readers register: only overwriting the value of an existing key
+* waits for in-flight readers, through EpochManager::synchronize. Keys
+* and values that are not trivially copyable are never read
+* optimistically; every write waits for readers in that case.
+*
+* Lookups copy the value out instead of returning a reference, since a
+* reference could be invalidated by the next writer. Do not call the
+* tree from inside an EpochGuard of your own: a write may wait for it.
+*/
+template <class Key, class Value>
+class ConcurrentAVLTree
+{
+public:
+    ConcurrentAVLTree();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+    Value operator[](const Key& key) const;
+    bool empty() const;
+
+private:
+    // Gives the wrapper access to the protected root_ and internalFind, and
+    // defers freeing removed nodes until no reader can hold them.
+    class Tree : public AVLTree<Key, Value>
+    {
+        friend class ConcurrentAVLTree<Key, Value>;
+    protected:
+        void destroyNode(Node<Key, Value>* node) override
+        {
+            EpochManager::instance().retire(node);
+        }
+    };
+
+    static const bool optimisticSafe_ =
+        std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value;
+
+    // No AVL tree reachable in memory is taller than this, so a longer walk
+    // means the reader raced with a rotation and has to retry.
+    static const int maxWalk_ = 128;
+
+    void beginWrite(bool destructive);
+    void endWrite();
+    bool tryWalk(const Key& key, Value* value, bool& found) const;
+    bool walk(const Key& key, Value* value) const;
+
+    Tree tree_;
+    std::mutex writeMutex_;
+    std::atomic<unsigned long> seq_;
+    std::atomic<Node<Key, Value>*> root_;   // tree_.root_ as of the last finished write
+};
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::ConcurrentAVLTree() :
+    seq_(0),
+    root_(nullptr)
+{
+
+}
+
+/**
+* Marks a write as in progress. Readers that start from now on will wait,
+* readers already walking the tree will fail validation. A destructive write
+* (one that changes data a reader may be copying) additionally waits until
+* every reader that started before it has left its guard.
+*/
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::beginWrite(bool destructive)
+{
+    seq_.fetch_add(1);
+    if (destructive || !optimisticSafe_)
+    {
+        EpochManager::instance().synchronize();
+    }
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::endWrite()
+{
+    root_.store(tree_.root_, std::memory_order_release);
+    seq_.fetch_add(1, std::memory_order_release);
+}
+
+/**
+* One optimistic walk towards key, inside its own EpochGuard. Returns
+* false if a writer got in the way and the walk has to be retried;
+* otherwise found says whether the key is there and, if value is not
+* NULL, the value of a matching node has been copied into it.
+*
+* The guard is entered before the sequence number is read, so a writer
+* that waits for readers either sees this one or makes it fail here.
+*/
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::tryWalk(const Key& key, Value* value, bool& found) const
+{
+    EpochGuard guard;
+    unsigned long seq = seq_.load();
+    if ((seq & 1) != 0)
+    {
+        return false;
+    }
+    Node<Key, Value>* cur = root_.load(std::memory_order_acquire);
+    int steps = 0;
+    while (cur != nullptr && steps < maxWalk_)
+    {
+        if (cur->getKey() == key)
+        {
+            break;
+        }
+        cur = cur->getKey() > key ? cur->loadLeft() : cur->loadRight();
+        ++steps;
+    }
+    found = cur != nullptr && steps < maxWalk_;
+    if (found && value != nullptr)
+    {
+        *value = cur->getValue();
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq_.load(std::memory_order_relaxed) == seq;
+}
+
+/**
+* Looks up key without taking any lock. While a write is in progress the
+* reader waits outside its guard, so that a writer waiting for readers to
+* leave is never blocked by one waiting for it.
+*/
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::walk(const Key& key, Value* value) const
+{
+    bool found;
+    while (!tryWalk(key, value, found))
+    {
+        while ((seq_.load(std::memory_order_relaxed) & 1) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    return found;
+}
+
+/**
+* Inserts or overwrites a key. Overwriting an existing key changes a value a
+* reader may be copying, so it waits for readers first.
+*/
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    bool overwrite = tree_.internalFind(keyValuePair.first) != nullptr;
+    beginWrite(overwrite);
+    tree_.insert(keyValuePair);
+    endWrite();
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::remove(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (tree_.internalFind(key) == nullptr)
+    {
+        return;
+    }
+    beginWrite(false);
+    tree_.remove(key);
+    endWrite();
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::clear()
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    beginWrite(false);
+    tree_.clear();
+    endWrite();
+}
+
+/**
+* Copies the value stored under key into value and returns true,
+* or returns false if the key is not in the tree.
+*/
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::find(const Key& key, Value& value) const
+{
+    return walk(key, &value);
+}
+
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::contains(const Key& key) const
+{
+    return walk(key, nullptr);
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns a copy of the value associated with the key
+ */
+template<class Key, class Value>
+Value ConcurrentAVLTree<Key, Value>::operator[](const Key& key) const
+{
+    Value value;
+    if (!walk(key, &value)) throw std::out_of_range("Invalid key");
+    return value;
+}
+
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::empty() const
+{
+    return root_.load(std::memory_order_acquire) == nullptr;
+}
+
+/**
+* A concurrent binary search tree in which many writers can work at once.
+* It is kept balanced the way a ScapegoatTree is, by rebuilding subtrees,
+* not by AVL rotations; the nodes are AVLNodes only so that a rebuilt
+* subtree records its balance.
+*
+* Every node carries its own shared/exclusive lock and operations descend
+* with lock coupling (hand-over-hand): the child is locked before the
+* parent is released. The descent takes shared locks, so lookups never
+* wait on each other, not even at the root; a writer takes the exclusive
+* lock only on the one node it changes, so writers in disjoint subtrees
+* never wait on each other either. The root pointer itself is published
+* with a compare-and-swap and is only ever replaced by a rebuild.
+* Rebalancing is deferred rather than done on every update:
+*   - insert links a new leaf without rotating,
+*   - remove only marks the node as deleted (a tombstone).
+* When an insert lands too deep, the smallest weight-unbalanced subtree
+* above it (its scapegoat) is rebuilt, which keeps the height logarithmic
+* at O(log n) amortized cost. When tombstones make up half the nodes the
+* whole tree is rebuilt. rebalance() does the same on demand, e.g. from a
+* maintenance thread.
+*
+* Every rebuild, however small the subtree, holds the structure lock
+* exclusively: it waits for all operations in flight and stalls every
+* reader and writer until it is done. With random keys the depth bound
+* (log base 1/0.7 of n, plus one) sits below the depth a random tree
+* reaches now and then, so such stalls are a regular part of insert-heavy
+* work, not a rare event; rebuilds() counts them.
+*/
+template <class Key, class Value>
+class LockCouplingScapegoatTree
+{
+public:
+    LockCouplingScapegoatTree();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void rebalance();
+    size_t rebuilds() const;
+
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+    Value operator[](const Key& key) const;
+    bool empty() const;
+
+private:
+    /**
+    * A reader-writer spin lock, one word per node. Held shared by every
+    * descent and exclusively only by the writer changing the node. A
+    * waiting writer keeps new sharers out, so it cannot be starved.
+    */
+    class NodeLock
+    {
+    public:
+        NodeLock() : state_(0)
+        {
+
+        }
+        void lockShared()
+        {
+            while (true)
+            {
+                int state = state_.load(std::memory_order_relaxed);
+                if (state >= 0 && (state & writerWaiting_) == 0
+                    && state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+                {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+        void unlockShared()
+        {
+            state_.fetch_sub(1, std::memory_order_release);
+        }
+        void lock()
+        {
+            while (true)
+            {
+                int state = state_.load(std::memory_order_relaxed);
+                if ((state == 0 || state == writerWaiting_)
+                    && state_.compare_exchange_weak(state, -1, std::memory_order_acquire))
+                {
+                    return;
+                }
+                if (state > 0 && (state & writerWaiting_) == 0)
+                {
+                    state_.compare_exchange_weak(state, state | writerWaiting_, std::memory_order_relaxed);
+                }
+                std::this_thread::yield();
+            }
+        }
+        void unlock()
+        {
+            state_.store(0, std::memory_order_release);
+        }
+
+    private:
+        static const int writerWaiting_ = 1 << 30;
+
+        std::atomic<int> state_;    // sharers (plus writerWaiting_), or -1 when held exclusively
+    };
+
+    /**
+    * An AVLNode with a lock and a tombstone flag.
+    */
+    class LockNode : public AVLNode<Key, Value>
+    {
+    public:
+        LockNode(const Key& key, const Value& value, LockNode* parent) :
+            AVLNode<Key, Value>(key, value, parent), deleted_(false)
+        {
+
+        }
+        LockNode* getLeft() const override
+        {
+            return static_cast<LockNode*>(this->left_);
+        }
+        LockNode* getRight() const override
+        {
+            return static_cast<LockNode*>(this->right_);
+        }
+
+        NodeLock lock_;
+        bool deleted_;
+    };
+
+    // Gives the wrapper access to the protected root_.
+    class Tree : public AVLTree<Key, Value>
+    {
+        friend class LockCouplingScapegoatTree<Key, Value>;
+    };
+
+    /**
+    * Operations hold the structure lock shared; only rebalance()
+    * holds it exclusively, since it relinks every node. Sharers count
+    * themselves in one of several padded slots, picked per thread, so
+    * threads taking it shared do not all write the same cache line.
+    */
+    class StructureLock
+    {
+    public:
+        StructureLock() : exclusive_(false)
+        {
+            for (int i = 0; i < slots_; ++i)
+            {
+                slot_[i].sharers_.store(0);
+            }
+        }
+        void lockShared()
+        {
+            std::atomic<int>& sharers = slot_[threadSlot()].sharers_;
+            while (true)
+            {
+                while (exclusive_.load())
+                {
+                    std::this_thread::yield();
+                }
+                sharers.fetch_add(1);
+                if (!exclusive_.load())
+                {
+                    return;
+                }
+                sharers.fetch_sub(1);
+            }
+        }
+        void unlockShared()
+        {
+            slot_[threadSlot()].sharers_.fetch_sub(1, std::memory_order_release);
+        }
+        void lockExclusive()
+        {
+            exclusiveMutex_.lock();
+            exclusive_.store(true);
+            for (int i = 0; i < slots_; ++i)
+            {
+                while (slot_[i].sharers_.load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        void unlockExclusive()
+        {
+            exclusive_.store(false);
+            exclusiveMutex_.unlock();
+        }
+
+    private:
+        static const int slots_ = 64;
+
+        struct Slot
+        {
+            std::atomic<int> sharers_;
+            char pad_[64 - sizeof(std::atomic<int>)];
+        };
+
+        static int threadSlot()
+        {
+            static std::atomic<unsigned> threads(0);
+            static thread_local int slot = static_cast<int>(threads.fetch_add(1) % slots_);
+            return slot;
+        }
+
+        Slot slot_[slots_];
+        std::atomic<bool> exclusive_;
+        std::mutex exclusiveMutex_;
+    };
+
+    LockNode* loadRoot() const;
+    LockNode* lockedLookup(const Key& key) const;
+    bool tooDeep(int depth) const;
+    void rebuildAround(const Key& key);
+    void rebuild(LockNode* node);
+    size_t subtreeSize(LockNode* node) const;
+    void collectLive(LockNode* node, std::vector<LockNode*>& live);
+    LockNode* buildBalanced(std::vector<LockNode*>& live, int lo, int hi, LockNode* parent, int& height);
+
+    Tree tree_;     // tree_.root_ is read and written with atomic builtins
+    mutable StructureLock structure_;
+    std::atomic<size_t> live_;
+    std::atomic<size_t> tombstones_;
+    std::atomic<size_t> rebuilds_;  // rebuilds done, each a stall of the whole tree
+};
+
+template<class Key, class Value>
+LockCouplingScapegoatTree<Key, Value>::LockCouplingScapegoatTree() :
+    live_(0),
+    tombstones_(0),
+    rebuilds_(0)
+{
+
+}
+
+/**
+* Returns true if a node at the given depth (the root is depth 1) is
+* deeper than a tree whose subtrees are all 0.7-weight-balanced can be.
+*/
+template<class Key, class Value>
+bool LockCouplingScapegoatTree<Key, Value>::tooDeep(int depth) const
+{
+    double nodes = static_cast<double>(live_.load(std::memory_order_relaxed)
+        + tombstones_.load(std::memory_order_relaxed));
+    return depth > std::log(nodes + 1) / std::log(1 / 0.7) + 1;
+}
+
+template<class Key, class Value>
+typename LockCouplingScapegoatTree<Key, Value>::LockNode*
+LockCouplingScapegoatTree<Key, Value>::loadRoot() const
+{
+    return static_cast<LockNode*>(__atomic_load_n(&tree_.root_, __ATOMIC_ACQUIRE));
+}
+
+/**
+* Descends hand-over-hand and returns the node holding key, still locked
+* shared, or NULL if there is none. The caller holds the structure lock
+* shared, so the root can only change from NULL to a node meanwhile.
+*/
+template<class Key, class Value>
+typename LockCouplingScapegoatTree<Key, Value>::LockNode*
+LockCouplingScapegoatTree<Key, Value>::lockedLookup(const Key& key) const
+{
+    LockNode* cur = loadRoot();
+    if (cur == nullptr)
+    {
+        return nullptr;
+    }
+    cur->lock_.lockShared();
+    while (cur->getKey() != key)
+    {
+        LockNode* next = cur->getKey() > key ? cur->getLeft() : cur->getRight();
+        if (next == nullptr)
+        {
+            cur->lock_.unlockShared();
+            return nullptr;
+        }
+        next->lock_.lockShared();
+        cur->lock_.unlockShared();
+        cur = next;
+    }
+    return cur;
+}
+
+/*
+ * Recall: If key is already in the tree, you should
+ * overwrite the current value with the updated value.
+ *
+ * The descent holds shared locks. Only at the node to overwrite, or at
+ * the parent of the new leaf, is the lock traded for an exclusive one;
+ * the node cannot be unlinked in between (only a rebuild does that, and
+ * it needs the structure lock), but another writer may have hung a leaf
+ * there, so the step is looked at again.
+ */
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    structure_.lockShared();
+    LockNode* cur = loadRoot();
+    if (cur == nullptr)
+    {
+        LockNode* node = new LockNode(keyValuePair.first, keyValuePair.second, nullptr);
+        Node<Key, Value>* expected = nullptr;
+        if (__atomic_compare_exchange_n(&tree_.root_, &expected, node, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            live_.fetch_add(1);
+            structure_.unlockShared();
+            return;
+        }
+        delete node;
+        cur = static_cast<LockNode*>(expected);
+    }
+    cur->lock_.lockShared();
+    bool exclusive = false;
+    int depth = 1;
+    bool deep = false;
+    while (true)
+    {
+        bool found = cur->getKey() == keyValuePair.first;
+        bool goLeft = cur->getKey() > keyValuePair.first;
+        LockNode* next = found ? nullptr : (goLeft ? cur->getLeft() : cur->getRight());
+        if (next == nullptr && !exclusive)
+        {
+            cur->lock_.unlockShared();
+            cur->lock_.lock();
+            exclusive = true;
+            continue;
+        }
+        if (found)
+        {
+            cur->setValue(keyValuePair.second);
+            if (cur->deleted_)
+            {
+                cur->deleted_ = false;
+                tombstones_.fetch_sub(1);
+                live_.fetch_add(1);
+            }
+            cur->lock_.unlock();
+            break;
+        }
+        if (next == nullptr)
+        {
+            LockNode* leaf = new LockNode(keyValuePair.first, keyValuePair.second, cur);
+            if (goLeft)
+            {
+                cur->setLeft(leaf);
+            }
+            else
+            {
+                cur->setRight(leaf);
+            }
+            live_.fetch_add(1);
+            cur->lock_.unlock();
+            deep = tooDeep(depth + 1);
+            break;
+        }
+        next->lock_.lockShared();
+        if (exclusive)
+        {
+            cur->lock_.unlock();
+            exclusive = false;
+        }
+        else
+        {
+            cur->lock_.unlockShared();
+        }
+        cur = next;
+        ++depth;
+    }
+    structure_.unlockShared();
+    if (deep)
+    {
+        rebuildAround(keyValuePair.first);
+    }
+}
+
+/**
+* Marks the key as deleted. The node is unlinked by the next rebalance.
+*/
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::remove(const Key& key)
+{
+    structure_.lockShared();
+    LockNode* node = lockedLookup(key);
+    bool compact = false;
+    if (node != nullptr)
+    {
+        node->lock_.unlockShared();
+        node->lock_.lock();
+        if (!node->deleted_)
+        {
+            node->deleted_ = true;
+            size_t dead = tombstones_.fetch_add(1) + 1;
+            size_t alive = live_.fetch_sub(1) - 1;
+            compact = dead > alive;
+        }
+        node->lock_.unlock();
+    }
+    structure_.unlockShared();
+    if (compact)
+    {
+        rebalance();
+    }
+}
+
+template<class Key, class Value>
+size_t LockCouplingScapegoatTree<Key, Value>::subtreeSize(LockNode* node) const
+{
+    if (node == nullptr)
+    {
+        return 0;
+    }
+    return subtreeSize(node->getLeft()) + 1 + subtreeSize(node->getRight());
+}
+
+/**
+* Finds the scapegoat for the (too deep) node holding key: the lowest
+* ancestor with a child holding more than 0.7 of its nodes. That subtree
+* is rebuilt. Does nothing if other writers already fixed the path.
+*/
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::rebuildAround(const Key& key)
+{
+    structure_.lockExclusive();
+    LockNode* cur = loadRoot();
+    int depth = 1;
+    while (cur != nullptr && cur->getKey() != key)
+    {
+        cur = cur->getKey() > key ? cur->getLeft() : cur->getRight();
+        ++depth;
+    }
+    if (cur != nullptr && tooDeep(depth))
+    {
+        size_t size = subtreeSize(cur);
+        LockNode* parent = static_cast<LockNode*>(cur->getParent());
+        while (parent != nullptr)
+        {
+            LockNode* sibling = parent->getLeft() == cur ? parent->getRight() : parent->getLeft();
+            size_t parentSize = size + 1 + subtreeSize(sibling);
+            if (size > 0.7 * parentSize)
+            {
+                break;
+            }
+            cur = parent;
+            size = parentSize;
+            parent = static_cast<LockNode*>(cur->getParent());
+        }
+        rebuild(parent != nullptr ? parent : cur);
+    }
+    structure_.unlockExclusive();
+}
+
+/**
+* Rebuilds the subtree rooted at node into a balanced subtree, dropping
+* its tombstones. The caller holds the structure lock exclusively.
+*/
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::rebuild(LockNode* node)
+{
+    rebuilds_.fetch_add(1, std::memory_order_relaxed);
+    LockNode* parent = static_cast<LockNode*>(node->getParent());
+    bool isLeft = parent != nullptr && parent->getLeft() == node;
+    std::vector<LockNode*> live;
+    collectLive(node, live);
+    int height;
+    LockNode* top = buildBalanced(live, 0, static_cast<int>(live.size()), parent, height);
+    if (parent == nullptr)
+    {
+        __atomic_store_n(&tree_.root_, top, __ATOMIC_RELEASE);
+    }
+    else if (isLeft)
+    {
+        parent->setLeft(top);
+    }
+    else
+    {
+        parent->setRight(top);
+    }
+}
+
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::collectLive(LockNode* node, std::vector<LockNode*>& live)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+    LockNode* right = node->getRight();
+    collectLive(node->getLeft(), live);
+    if (node->deleted_)
+    {
+        tombstones_.fetch_sub(1, std::memory_order_relaxed);
+        delete node;
+    }
+    else
+    {
+        live.push_back(node);
+    }
+    collectLive(right, live);
+}
+
+/**
+* Links live[lo, hi) into a perfectly balanced subtree, sets the AVL
+* balance of every node and returns its root. height receives the
+* height of the subtree.
+*/
+template<class Key, class Value>
+typename LockCouplingScapegoatTree<Key, Value>::LockNode*
+LockCouplingScapegoatTree<Key, Value>::buildBalanced(std::vector<LockNode*>& live, int lo, int hi, LockNode* parent, int& height)
+{
+    if (lo >= hi)
+    {
+        height = 0;
+        return nullptr;
+    }
+    int mid = lo + (hi - lo) / 2;
+    LockNode* node = live[mid];
+    int leftHeight, rightHeight;
+    node->setParent(parent);
+    node->setLeft(buildBalanced(live, lo, mid, node, leftHeight));
+    node->setRight(buildBalanced(live, mid + 1, hi, node, rightHeight));
+    node->setBalance(rightHeight - leftHeight);
+    height = std::max(leftHeight, rightHeight) + 1;
+    return node;
+}
+
+/**
+* Drops tombstones and rebuilds the whole tree into a balanced one.
+* Waits for all in-flight operations and blocks new ones meanwhile.
+*/
+template<class Key, class Value>
+void LockCouplingScapegoatTree<Key, Value>::rebalance()
+{
+    structure_.lockExclusive();
+    if (loadRoot() != nullptr)
+    {
+        rebuild(loadRoot());
+    }
+    structure_.unlockExclusive();
+}
+
+/**
+* Copies the value stored under key into value and returns true,
+* or returns false if the key is not in the tree.
+*/
+template<class Key, class Value>
+bool LockCouplingScapegoatTree<Key, Value>::find(const Key& key, Value& value) const
+{
+    structure_.lockShared();
+    LockNode* node = lockedLookup(key);
+    bool found = false;
+    if (node != nullptr)
+    {
+        found = !node->deleted_;
+        if (found)
+        {
+            value = node->getValue();
+        }
+        node->lock_.unlockShared();
+    }
+    structure_.unlockShared();
+    return found;
+}
+
+template<class Key, class Value>
+bool LockCouplingScapegoatTree<Key, Value>::contains(const Key& key) const
+{
+    structure_.lockShared();
+    LockNode* node = lockedLookup(key);
+    bool found = false;
+    if (node != nullptr)
+    {
+        found = !node->deleted_;
+        node->lock_.unlockShared();
+    }
+    structure_.unlockShared();
+    return found;
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns a copy of the value associated with the key
+ */
+template<class Key, class Value>
+Value LockCouplingScapegoatTree<Key, Value>::operator[](const Key& key) const
+{
+    Value value;
+    if (!find(key, value)) throw std::out_of_range("Invalid key");
+    return value;
+}
+
+template<class Key, class Value>
+bool LockCouplingScapegoatTree<Key, Value>::empty() const
+{
+    return live_.load() == 0;
+}
+
+/**
+* The number of subtree and whole-tree rebuilds so far, for measuring:
+* each one blocked every other operation while it ran.
+*/
+template<class Key, class Value>
+size_t LockCouplingScapegoatTree<Key, Value>::rebuilds() const
+{
+    return rebuilds_.load(std::memory_order_relaxed);
+}
+
+#endif
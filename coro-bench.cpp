@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Point lookup throughput on one AVLTree much larger than the last-level
+// cache: the recursive find, findMany's group prefetching, and
+// findInterleaved's coroutines at several lane counts.
+//
+// usage: coro-bench [keys ...]    (default: 10000000)
+
+const size_t probeCount = 2000000;
+
+typedef AVLTree<uint64_t, uint64_t> Tree;
+
+double findRate(const Tree& tree, const vector<uint64_t>& probes)
+{
+    BenchTimer timer;
+    uint64_t sum = 0;
+    for(size_t i = 0; i < probes.size(); i++) {
+        Tree::iterator it = tree.find(probes[i]);
+        if(it != tree.end()) {
+            sum += it->second;
+        }
+    }
+    benchSink(sum);
+    return probes.size() / timer.seconds() / 1e6;
+}
+
+double summedRate(const Tree& tree, const vector<Tree::iterator>& results, double seconds)
+{
+    uint64_t sum = 0;
+    for(size_t i = 0; i < results.size(); i++) {
+        if(results[i] != tree.end()) {
+            sum += results[i]->second;
+        }
+    }
+    benchSink(sum);
+    return results.size() / seconds / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(10000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1, 2);
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(probeCount, 0, 2 * sizes[s] - 1, 2);
+        Tree tree;
+        for(size_t i = 0; i < keys.size(); i++) {
+            tree.insert(make_pair(keys[i], keys[i]));
+        }
+
+        cout << keys.size() << " keys\tfind " << findRate(tree, probes) << " M/s";
+        vector<Tree::iterator> results;
+        BenchTimer timer;
+        tree.findMany(probes, results);
+        cout << "\tfindMany " << summedRate(tree, results, timer.seconds()) << " M/s";
+        for(size_t lanes = 4; lanes <= 32; lanes *= 2) {
+            timer.restart();
+            tree.findInterleaved(probes, results, lanes);
+            cout << "\tcoroutines x" << lanes << " " << summedRate(tree, results, timer.seconds()) << " M/s";
+        }
+        cout << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <vector>
+#include "bst.h"
+#include "avlbst.h"
+#include "avl_multimap.h"
+
+using namespace std;
+
+// Checks findInterleaved against find on tree for every key in keys.
+template<typename Tree>
+bool sameAsFind(const Tree& tree, const vector<int>& keys, size_t lanes)
+{
+    vector<typename Tree::iterator> found;
+    tree.findInterleaved(keys, found, lanes);
+    bool same = found.size() == keys.size();
+    for(size_t i = 0; same && i < keys.size(); i++) {
+        same = found[i] == tree.find(keys[i]);
+    }
+    return same;
+}
+
+int main(int argc, char *argv[])
+{
+    AVLTree<int,int> at;
+    BinarySearchTree<int,int> bt;
+    vector<int> keys;
+    for(int i = 0; i < 1000; i++) {
+        at.insert(std::make_pair((i * 7919) % 1000 * 2, i));
+        bt.insert(std::make_pair((i * 7919) % 1000 * 2, i));
+    }
+    for(int i = -3; i < 2003; i++) {
+        keys.push_back(i);
+    }
+    cout << "AVLTree findInterleaved matches find: " << sameAsFind(at, keys, 16) << endl;
+    cout << "BinarySearchTree findInterleaved matches find: " << sameAsFind(bt, keys, 5) << endl;
+    cout << "One lane matches find: " << sameAsFind(at, keys, 1) << endl;
+    cout << "Zero lanes matches find: " << sameAsFind(at, keys, 0) << endl;
+
+    AVLMultiMap<int,int> mm;
+    for(int i = 0; i < 500; i++) {
+        mm.insert(std::make_pair(i % 7 * 3, i));
+    }
+    cout << "AVLMultiMap findInterleaved matches find: " << sameAsFind(mm, keys, 16) << endl;
+
+    AVLTree<int,int> none;
+    cout << "Empty tree matches find: " << sameAsFind(none, keys, 16) << endl;
+    return 0;
+}
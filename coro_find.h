@@ -0,0 +1,163 @@
+#ifndef CORO_FIND_H
+#define CORO_FIND_H
+
+#if __cplusplus < 202002L
+#error "coro_find.h needs C++20 (build with make cpp20)"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <vector>
+
+/**
+* The coroutine type of one interleaved lookup, which produces a Result.
+*
+* A lookup suspends right after it prefetches the next node it needs,
+* and a scheduler resumes other lookups while the cache line arrives.
+* The lookup starts suspended, so nothing runs until the first resume().
+*
+* Frames are recycled through a per-thread cache: every lookup of a
+* given kind has the same frame size, so a scheduler that keeps starting
+* new lookups does not go to the heap once the cache has warmed up.
+*/
+template <typename Result>
+class LookupTask
+{
+public:
+    struct promise_type
+    {
+        LookupTask get_return_object()
+        {
+            return LookupTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return std::suspend_always();
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return std::suspend_always();
+        }
+        void return_value(Result result)
+        {
+            result_ = result;
+        }
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+
+        Result result_;
+    };
+
+    LookupTask() : handle_(nullptr)
+    {
+
+    }
+    explicit LookupTask(std::coroutine_handle<promise_type> handle) : handle_(handle)
+    {
+
+    }
+    LookupTask(LookupTask&& other) noexcept : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+    LookupTask& operator=(LookupTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    ~LookupTask()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const
+    {
+        return handle_.done();
+    }
+    void resume()
+    {
+        handle_.resume();
+    }
+    Result result() const
+    {
+        return handle_.promise().result_;
+    }
+
+private:
+    LookupTask(const LookupTask&) = delete;
+    LookupTask& operator=(const LookupTask&) = delete;
+
+    /**
+    * Free frames of one size, kept per thread.
+    */
+    struct FrameCache
+    {
+        ~FrameCache()
+        {
+            for (size_t i = 0; i < frames_.size(); ++i)
+            {
+                ::operator delete(frames_[i]);
+            }
+        }
+
+        size_t size_ = 0;
+        std::vector<void*> frames_;
+    };
+
+    static FrameCache& frameCache()
+    {
+        static thread_local FrameCache cache;
+        return cache;
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template<typename Result>
+void* LookupTask<Result>::promise_type::operator new(size_t size)
+{
+    FrameCache& cache = frameCache();
+    if (cache.size_ == size && !cache.frames_.empty())
+    {
+        void* frame = cache.frames_.back();
+        cache.frames_.pop_back();
+        return frame;
+    }
+    return ::operator new(size);
+}
+
+template<typename Result>
+void LookupTask<Result>::promise_type::operator delete(void* frame, size_t size)
+{
+    FrameCache& cache = frameCache();
+    if (cache.size_ == 0)
+    {
+        cache.size_ = size;
+    }
+    if (cache.size_ == size && cache.frames_.size() < 1024)
+    {
+        cache.frames_.push_back(frame);
+        return;
+    }
+    ::operator delete(frame);
+}
+
+#endif
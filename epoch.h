@@ -0,0 +1,303 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+* Epoch-based memory reclamation for lock-free readers.
+*
+* A reader wraps each access to shared nodes in an EpochGuard. A writer
+* that unlinks a node hands it to retire() instead of deleting it. The
+* node goes onto the writer's own limbo list, tagged with the current
+* global epoch, and is freed only once every thread that was reading at
+* that time has left its guard (two epoch advances later). Readers never
+* touch freed memory, and writers never wait for readers: a slow reader
+* only delays reclamation.
+*
+* There is one process-wide manager, reached through instance().
+*/
+class EpochManager
+{
+public:
+    typedef void (*Deleter)(void*);
+
+    static EpochManager& instance();
+
+    void enter();
+    void exit();
+    void retire(void* ptr, Deleter deleter);
+    bool tryAdvance();
+    void synchronize();
+
+    template<typename T>
+    void retire(T* ptr);
+
+    ~EpochManager();
+
+private:
+    static const int epochs_ = 3;       // limbo lists needed for a two-epoch grace period
+    static const int advanceEvery_ = 64; // retirements between reclamation attempts
+
+    struct Retired
+    {
+        void* ptr_;
+        Deleter deleter_;
+    };
+
+    /**
+    * Per-thread state. Records are never freed; a record released by an
+    * exiting thread is picked up again by the next new thread.
+    */
+    struct ThreadRecord
+    {
+        ThreadRecord() : active_(0), inUse_(true), nesting_(0), retiredSince_(0), next_(nullptr)
+        {
+
+        }
+
+        std::atomic<uint64_t> active_;  // epoch the thread is reading in, 0 if quiescent
+        std::atomic<bool> inUse_;
+        int nesting_;
+        int retiredSince_;
+        uint64_t limboEpoch_[epochs_];
+        std::vector<Retired> limbo_[epochs_];
+        ThreadRecord* next_;
+    };
+
+    /**
+    * Releases the calling thread's record when the thread exits.
+    */
+    struct ThreadHandle
+    {
+        ThreadHandle() : record_(nullptr)
+        {
+
+        }
+        ~ThreadHandle();
+
+        ThreadRecord* record_;
+    };
+
+    EpochManager();
+    EpochManager(const EpochManager&);
+    EpochManager& operator=(const EpochManager&);
+
+    ThreadRecord* local();
+    void reclaim(ThreadRecord* record, uint64_t safeEpoch);
+
+    template<typename T>
+    static void deleteObject(void* ptr);
+
+    std::atomic<uint64_t> global_;
+    std::atomic<ThreadRecord*> records_;
+};
+
+/**
+* Marks the calling thread as reading shared nodes for its lifetime.
+* Guards may nest.
+*/
+class EpochGuard
+{
+public:
+    EpochGuard()
+    {
+        EpochManager::instance().enter();
+    }
+    ~EpochGuard()
+    {
+        EpochManager::instance().exit();
+    }
+
+private:
+    EpochGuard(const EpochGuard&);
+    EpochGuard& operator=(const EpochGuard&);
+};
+
+inline EpochManager& EpochManager::instance()
+{
+    static EpochManager manager;
+    return manager;
+}
+
+inline EpochManager::EpochManager() :
+    global_(epochs_),   // keeps global_ - 2 positive and 0 free for "quiescent"
+    records_(nullptr)
+{
+
+}
+
+/**
+* Frees everything still in limbo. By now no thread can be reading.
+*/
+inline EpochManager::~EpochManager()
+{
+    ThreadRecord* record = records_.load();
+    while (record != nullptr)
+    {
+        ThreadRecord* next = record->next_;
+        reclaim(record, UINT64_MAX);
+        delete record;
+        record = next;
+    }
+}
+
+inline EpochManager::ThreadHandle::~ThreadHandle()
+{
+    if (record_ != nullptr)
+    {
+        record_->active_.store(0);
+        record_->inUse_.store(false);
+    }
+}
+
+/**
+* Returns the calling thread's record, adopting a released one or
+* registering a new one on first use.
+*/
+inline EpochManager::ThreadRecord* EpochManager::local()
+{
+    static thread_local ThreadHandle handle;
+    if (handle.record_ != nullptr)
+    {
+        return handle.record_;
+    }
+    for (ThreadRecord* record = records_.load(); record != nullptr; record = record->next_)
+    {
+        bool expected = false;
+        if (!record->inUse_.load() && record->inUse_.compare_exchange_strong(expected, true))
+        {
+            handle.record_ = record;
+            return record;
+        }
+    }
+    ThreadRecord* record = new ThreadRecord();
+    for (int i = 0; i < epochs_; ++i)
+    {
+        record->limboEpoch_[i] = 0;
+    }
+    ThreadRecord* head = records_.load();
+    do
+    {
+        record->next_ = head;
+    }
+    while (!records_.compare_exchange_weak(head, record));
+    handle.record_ = record;
+    return record;
+}
+
+inline void EpochManager::enter()
+{
+    ThreadRecord* record = local();
+    if (record->nesting_++ == 0)
+    {
+        // seq_cst so that the announcement is visible before any node is read
+        record->active_.store(global_.load());
+    }
+}
+
+inline void EpochManager::exit()
+{
+    ThreadRecord* record = local();
+    if (--record->nesting_ == 0)
+    {
+        record->active_.store(0, std::memory_order_release);
+    }
+}
+
+/**
+* Advances the global epoch if every reading thread has caught up with it.
+* Returns whether it advanced.
+*/
+inline bool EpochManager::tryAdvance()
+{
+    uint64_t epoch = global_.load();
+    for (ThreadRecord* record = records_.load(); record != nullptr; record = record->next_)
+    {
+        uint64_t active = record->active_.load();
+        if (active != 0 && active != epoch)
+        {
+            return false;
+        }
+    }
+    return global_.compare_exchange_strong(epoch, epoch + 1);
+}
+
+/**
+* Waits until every thread that was inside a guard when it was called has
+* left it, by advancing the global epoch twice. A thread that enters a
+* guard meanwhile announces a newer epoch and is not waited for. The
+* caller must not be inside a guard itself.
+*/
+inline void EpochManager::synchronize()
+{
+    uint64_t target = global_.load() + 2;
+    while (global_.load() < target)
+    {
+        if (!tryAdvance())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+* Frees the record's limbo lists whose epoch is at most safeEpoch.
+*/
+inline void EpochManager::reclaim(ThreadRecord* record, uint64_t safeEpoch)
+{
+    for (int i = 0; i < epochs_; ++i)
+    {
+        if (record->limboEpoch_[i] > safeEpoch || record->limbo_[i].empty())
+        {
+            continue;
+        }
+        std::vector<Retired>& list = record->limbo_[i];
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            list[j].deleter_(list[j].ptr_);
+        }
+        list.clear();
+    }
+}
+
+/**
+* Defers deleter(ptr) until no reader can still hold ptr. The caller must
+* already have made ptr unreachable from the shared structure.
+*/
+inline void EpochManager::retire(void* ptr, Deleter deleter)
+{
+    ThreadRecord* record = local();
+    uint64_t epoch = global_.load();
+    int slot = epoch % epochs_;
+    if (record->limboEpoch_[slot] != epoch)
+    {
+        // the slot holds a list at least three epochs old: safe to free
+        reclaim(record, epoch - 2);
+        record->limboEpoch_[slot] = epoch;
+    }
+    Retired retired = { ptr, deleter };
+    record->limbo_[slot].push_back(retired);
+    if (++record->retiredSince_ >= advanceEvery_)
+    {
+        record->retiredSince_ = 0;
+        tryAdvance();
+        reclaim(record, global_.load() - 2);
+    }
+}
+
+template<typename T>
+void EpochManager::deleteObject(void* ptr)
+{
+    delete static_cast<T*>(ptr);
+}
+
+template<typename T>
+void EpochManager::retire(T* ptr)
+{
+    retire(ptr, &EpochManager::deleteObject<T>);
+}
+
+#endif
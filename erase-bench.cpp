@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bst.h"
+#include "avlbst.h"
+#include "rbbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// A filtered scan that deletes every other item, done with remove(key)
+// after the scan, as before erase existed, and with erase(iterator)
+// during the scan. Then a TTL sweep that drops the oldest half of an
+// AVLTree keyed by timestamp, with remove(key), removeBatch and
+// eraseRange.
+//
+// usage: erase-bench [keys ...]    (default: 1000000)
+
+template<typename Tree>
+void run(const string& name, const vector<uint64_t>& keys)
+{
+    Tree byKey, byIterator;
+    for(size_t i = 0; i < keys.size(); i++) {
+        byKey.insert(make_pair(keys[i], keys[i]));
+        byIterator.insert(make_pair(keys[i], keys[i]));
+    }
+
+    BenchTimer timer;
+    vector<uint64_t> doomed;
+    for(typename Tree::iterator it = byKey.begin(); it != byKey.end(); ++it) {
+        if(it->second % 2) {
+            doomed.push_back(it->first);
+        }
+    }
+    for(size_t i = 0; i < doomed.size(); i++) {
+        byKey.remove(doomed[i]);
+    }
+    double removeSeconds = timer.seconds();
+
+    timer.restart();
+    for(typename Tree::iterator it = byIterator.begin(); it != byIterator.end(); ) {
+        if(it->second % 2) {
+            it = byIterator.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    double eraseSeconds = timer.seconds();
+
+    cout << keys.size() << " keys\t" << name
+         << "\tscan + remove(key) " << removeSeconds << " s"
+         << "\terase during scan " << eraseSeconds << " s" << endl;
+}
+
+void ttlSweep(const vector<uint64_t>& keys)
+{
+    AVLTree<uint64_t, uint64_t> byKey, byBatch, byRange;
+    for(size_t i = 0; i < keys.size(); i++) {
+        byKey.insert(make_pair(keys[i], keys[i]));
+        byBatch.insert(make_pair(keys[i], keys[i]));
+        byRange.insert(make_pair(keys[i], keys[i]));
+    }
+    uint64_t cutoff = keys.size() / 2;
+
+    BenchTimer timer;
+    for(uint64_t key = 0; key < cutoff; key++) {
+        byKey.remove(key);
+    }
+    double removeSeconds = timer.seconds();
+
+    timer.restart();
+    vector<uint64_t> expired;
+    for(AVLTree<uint64_t, uint64_t>::iterator it = byBatch.begin(); it != byBatch.end() && it->first < cutoff; ++it) {
+        expired.push_back(it->first);
+    }
+    byBatch.removeBatch(expired);
+    double batchSeconds = timer.seconds();
+
+    timer.restart();
+    byRange.eraseRange(0, cutoff);
+    double rangeSeconds = timer.seconds();
+
+    cout << keys.size() << " keys\tavl ttl sweep of " << cutoff
+         << "\tremove(key) " << removeSeconds << " s"
+         << "\tremoveBatch " << batchSeconds << " s"
+         << "\teraseRange " << rangeSeconds << " s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1);
+        run<BinarySearchTree<uint64_t, uint64_t> >("bst", keys);
+        run<AVLTree<uint64_t, uint64_t> >("avl", keys);
+        run<RedBlackTree<uint64_t, uint64_t> >("red-black", keys);
+        ttlSweep(keys);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include "bst.h"
+#include "avlbst.h"
+#include "avl_multimap.h"
+#include "rbbst.h"
+#include "splay_bst.h"
+#include "treap_bst.h"
+#include "scapegoat_bst.h"
+
+using namespace std;
+
+// Checks that a tree holds exactly the contents of expected.
+bool sameContents(const BinarySearchTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(BinarySearchTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+// Erases while scanning, then erases ranges, checking what erase returns
+// and, for height-balanced trees, the balance after each step.
+template<typename Tree>
+bool eraseSweeps(unsigned seed, bool balanced)
+{
+    Tree tree;
+    map<int, int> model;
+    srand(seed);
+    for(int i = 0; i < 3000; i++) {
+        int key = rand() % 5000;
+        if(model.count(key)) {
+            continue; // distinct keys, so the multimap matches the model too
+        }
+        tree.insert(make_pair(key, i));
+        model[key] = i;
+    }
+    bool ok = true;
+
+    // drop every key divisible by 3 during one scan
+    for(typename Tree::iterator it = tree.begin(); it != tree.end(); ) {
+        if(it->first % 3 == 0) {
+            map<int, int>::iterator next = model.erase(model.find(it->first));
+            it = tree.erase(it);
+            ok = ok && (next == model.end() ? it == tree.end() : (it != tree.end() && it->first == next->first));
+        }
+        else {
+            ++it;
+        }
+    }
+    ok = ok && sameContents(tree, model) && (!balanced || tree.isBalanced());
+
+    // erase a range from the middle, then the first and last items
+    map<int, int>::iterator lo = model.lower_bound(1000);
+    map<int, int>::iterator hi = model.lower_bound(3000);
+    typename Tree::iterator last = tree.erase(tree.find(lo->first), tree.find(hi->first));
+    ok = ok && last->first == hi->first;
+    model.erase(lo, hi);
+    tree.erase(tree.begin());
+    model.erase(model.begin());
+    tree.erase(tree.find(model.rbegin()->first));
+    model.erase(model.rbegin()->first);
+    ok = ok && sameContents(tree, model) && (!balanced || tree.isBalanced());
+
+    ok = ok && tree.erase(tree.begin(), tree.end()) == tree.end();
+    return ok && tree.empty();
+}
+
+int main(int argc, char *argv[])
+{
+    cout << "BinarySearchTree erase: " << eraseSweeps<BinarySearchTree<int, int> >(49, false) << endl;
+    cout << "AVLTree erase: " << eraseSweeps<AVLTree<int, int> >(50, true) << endl;
+    cout << "AVLMultiMap erase: " << eraseSweeps<AVLMultiMap<int, int> >(51, true) << endl;
+    cout << "RedBlackTree erase: " << eraseSweeps<RedBlackTree<int, int> >(52, false) << endl;
+    cout << "SplayTree erase: " << eraseSweeps<SplayTree<int, int> >(53, false) << endl;
+    cout << "Treap erase: " << eraseSweeps<Treap<int, int> >(54, false) << endl;
+    cout << "ScapegoatTree erase: " << eraseSweeps<ScapegoatTree<int, int> >(55, false) << endl;
+    return 0;
+}
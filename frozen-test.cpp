@@ -0,0 +1,93 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include <string>
+#include "avlbst.h"
+#include "frozen_bst.h"
+
+using namespace std;
+
+// Checks that a FrozenTree iterates exactly the contents of expected.
+template<typename Key, typename Value>
+bool sameContents(const FrozenTree<Key, Value>& tree, const map<Key, Value>& expected)
+{
+    typename map<Key, Value>::const_iterator exp = expected.begin();
+    for(typename FrozenTree<Key, Value>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end() && tree.size() == expected.size();
+}
+
+// Checks find and lower_bound for every key in [lo, hi] against expected.
+bool sameLookups(const FrozenTree<int, int>& tree, const map<int, int>& expected, int lo, int hi)
+{
+    for(int key = lo; key <= hi; key++) {
+        map<int, int>::const_iterator exp = expected.lower_bound(key);
+        FrozenTree<int, int>::iterator it = tree.lower_bound(key);
+        if((exp == expected.end()) != (it == tree.end())) {
+            return false;
+        }
+        if(exp != expected.end() && it->first != exp->first) {
+            return false;
+        }
+        bool present = expected.count(key) > 0;
+        if(present != (tree.find(key) != tree.end())) {
+            return false;
+        }
+        if(present && tree[key] != expected.find(key)->second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // every size up to a few full levels, to cover all shapes of the last level
+    bool ok = true;
+    for(int n = 0; n <= 70; n++) {
+        AVLTree<int,int> at;
+        map<int,int> model;
+        for(int i = 0; i < n; i++) {
+            at.insert(make_pair(3 * i, i));
+            model[3 * i] = i;
+        }
+        FrozenTree<int,int> ft = freeze(at);
+        ok = ok && sameContents(ft, model) && sameLookups(ft, model, -2, 3 * n + 2);
+    }
+    cout << "Small sizes match: " << ok << endl;
+
+    AVLTree<int,int> at;
+    map<int,int> model;
+    srand(105);
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 50000;
+        at.insert(make_pair(key, i));
+        model[key] = i;
+    }
+    FrozenTree<int,int> ft = freeze(at);
+    at.clear();
+    cout << "Random contents match: " << sameContents(ft, model) << endl;
+    cout << "Random lookups match: " << sameLookups(ft, model, -1, 50001) << endl;
+
+    try {
+        ft[-1];
+        cout << "Missing key throws: 0" << endl;
+    }
+    catch(const out_of_range&) {
+        cout << "Missing key throws: 1" << endl;
+    }
+
+    AVLTree<string,int> st;
+    map<string,int> smodel;
+    const char* words[] = { "pear", "apple", "fig", "kiwi", "banana", "cherry", "date" };
+    for(int i = 0; i < 7; i++) {
+        st.insert(make_pair(string(words[i]), i));
+        smodel[words[i]] = i;
+    }
+    FrozenTree<string,int> sft = freeze(st);
+    cout << "String keys match: " << (sameContents(sft, smodel) && sft.lower_bound("coconut")->first == "date") << endl;
+    return 0;
+}
@@ -0,0 +1,335 @@
+#ifndef FROZEN_BST_H
+#define FROZEN_BST_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "bst.h"
+
+/*
+  ------------------------------------------------------------
+  Index arithmetic on an Eytzinger array of n keys, where the
+  root is at index 1 and the children of k are at 2k and 2k+1.
+  Index 0 stands for "past the end".
+  ------------------------------------------------------------
+*/
+
+/**
+* Returns the index of the smallest key, the leftmost one.
+*/
+inline size_t eytzingerFirst(size_t n)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    size_t k = 1;
+    while (2 * k <= n)
+    {
+        k = 2 * k;
+    }
+    return k;
+}
+
+/**
+* Returns the index of the in-order successor of k: the leftmost index of
+* the right subtree if there is one, otherwise the ancestor reached by
+* climbing past every ancestor of which we are the right child.
+*/
+inline size_t eytzingerNext(size_t k, size_t n)
+{
+    size_t right = 2 * k + 1;
+    if (right <= n)
+    {
+        while (2 * right <= n)
+        {
+            right = 2 * right;
+        }
+        return right;
+    }
+    // drop the trailing ones (right turns) and then the left turn
+    return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+}
+
+/**
+* Returns the index of the first of keys[1..n] not less than key, or 0
+* if there is none.
+*
+* The loop has no data-dependent branch: each step goes to 2k or 2k+1
+* depending on one comparison. When it falls off the bottom, k encodes
+* the path taken; the answer is the last node where we went left, found
+* by stripping the trailing right turns and that left turn. The loop
+* prefetches the cache line that holds the descendants of k a few levels
+* down, so several misses are in flight at once.
+*/
+template<typename Key>
+size_t eytzingerLowerBound(const Key* keys, size_t n, const Key& key)
+{
+    // keys per cache line. The block descendants of k that are log2(block)
+    // levels down sit next to each other from k * block on, so one prefetch
+    // covers them all: 8k, three levels below k, for 8-byte keys.
+    const size_t block = 64 / sizeof(Key) > 1 ? 64 / sizeof(Key) : 1;
+    size_t k = 1;
+    while (k <= n)
+    {
+        __builtin_prefetch(keys + (k * block <= n ? k * block : 0));
+        k = 2 * k + (keys[k] < key);
+    }
+    return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+}
+
+/**
+* Assigns consecutive ranks to the indices of the subtree at k in-order.
+*/
+inline void eytzingerLayout(size_t k, std::vector<size_t>& order, size_t& rank)
+{
+    if (k >= order.size())
+    {
+        return;
+    }
+    eytzingerLayout(2 * k, order, rank);
+    order[k] = rank++;
+    eytzingerLayout(2 * k + 1, order, rank);
+}
+
+/**
+* Returns order, where order[k] is the rank (position in sorted order)
+* of the key that goes to index k; order[0] is unused.
+*/
+inline std::vector<size_t> eytzingerOrder(size_t n)
+{
+    std::vector<size_t> order(n + 1);
+    size_t rank = 0;
+    eytzingerLayout(1, order, rank);
+    return order;
+}
+
+/**
+* An immutable, pointer-free copy of a search tree for read-only use.
+*
+* The keys are stored in one array in Eytzinger (BFS) order: the root
+* is at index 1 and the children of index k are at 2k and 2k+1. A lookup
+* therefore walks down with index arithmetic instead of loading child
+* pointers, and the top levels of the tree share a few cache lines that
+* stay hot. The descendants of k a few levels down are contiguous, so
+* the search loop prefetches them before it needs them.
+*
+* Keys are kept apart from the items so that the search reads only keys.
+* Both arrays are indexed the same way; ordered iteration walks the
+* implicit tree in-order.
+*/
+template <typename Key, typename Value>
+class FrozenTree
+{
+public:
+    FrozenTree();
+
+    template<typename InputIterator>
+    FrozenTree(InputIterator first, InputIterator last);
+
+    bool empty() const;
+    size_t size() const;
+
+    /**
+    * An iterator for traversing the items in key order.
+    */
+    class iterator
+    {
+    public:
+        iterator();
+
+        const std::pair<const Key, Value>& operator*() const;
+        const std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class FrozenTree<Key, Value>;
+        iterator(const FrozenTree<Key, Value>* tree, size_t index);
+
+        const FrozenTree<Key, Value>* tree_;
+        size_t index_;    // Eytzinger index, 0 at the end
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    Value const & operator[](const Key& key) const;
+
+protected:
+    std::vector<Key> keys_;     // keys_[k] for k in [1, size]; keys_[0] is unused
+    std::vector<std::pair<const Key, Value> > items_;   // items_[k - 1]
+};
+
+/*
+-----------------------------------------------------------
+Begin implementations for the FrozenTree::iterator class.
+-----------------------------------------------------------
+*/
+
+template<typename Key, typename Value>
+FrozenTree<Key, Value>::iterator::iterator() :
+    tree_(nullptr),
+    index_(0)
+{
+
+}
+
+template<typename Key, typename Value>
+FrozenTree<Key, Value>::iterator::iterator(const FrozenTree<Key, Value>* tree, size_t index) :
+    tree_(tree),
+    index_(index)
+{
+
+}
+
+template<typename Key, typename Value>
+const std::pair<const Key, Value>&
+FrozenTree<Key, Value>::iterator::operator*() const
+{
+    return tree_->items_[index_ - 1];
+}
+
+template<typename Key, typename Value>
+const std::pair<const Key, Value>*
+FrozenTree<Key, Value>::iterator::operator->() const
+{
+    return &tree_->items_[index_ - 1];
+}
+
+template<typename Key, typename Value>
+bool FrozenTree<Key, Value>::iterator::operator==(const iterator& rhs) const
+{
+    return index_ == rhs.index_;
+}
+
+template<typename Key, typename Value>
+bool FrozenTree<Key, Value>::iterator::operator!=(const iterator& rhs) const
+{
+    return index_ != rhs.index_;
+}
+
+template<typename Key, typename Value>
+typename FrozenTree<Key, Value>::iterator&
+FrozenTree<Key, Value>::iterator::operator++()
+{
+    index_ = eytzingerNext(index_, tree_->size());
+    return *this;
+}
+
+/*
+---------------------------------------------------------
+End implementations for the FrozenTree::iterator class.
+---------------------------------------------------------
+*/
+
+template<typename Key, typename Value>
+FrozenTree<Key, Value>::FrozenTree()
+{
+
+}
+
+/**
+* Builds the layout from items given in ascending key order without
+* duplicates, such as the range of a tree's iterators.
+*/
+template<typename Key, typename Value>
+template<typename InputIterator>
+FrozenTree<Key, Value>::FrozenTree(InputIterator first, InputIterator last)
+{
+    std::vector<std::pair<Key, Value> > sorted;
+    for (; first != last; ++first)
+    {
+        sorted.push_back(*first);
+    }
+    if (sorted.empty())
+    {
+        return;
+    }
+
+    std::vector<size_t> order = eytzingerOrder(sorted.size());
+
+    keys_.reserve(sorted.size() + 1);
+    items_.reserve(sorted.size());
+    keys_.push_back(sorted[0].first);   // so that Key needs no default constructor
+    for (size_t k = 1; k < order.size(); ++k)
+    {
+        keys_.push_back(sorted[order[k]].first);
+        items_.push_back(sorted[order[k]]);
+    }
+}
+
+template<typename Key, typename Value>
+bool FrozenTree<Key, Value>::empty() const
+{
+    return items_.empty();
+}
+
+template<typename Key, typename Value>
+size_t FrozenTree<Key, Value>::size() const
+{
+    return items_.size();
+}
+
+template<typename Key, typename Value>
+typename FrozenTree<Key, Value>::iterator
+FrozenTree<Key, Value>::begin() const
+{
+    return iterator(this, eytzingerFirst(size()));
+}
+
+template<typename Key, typename Value>
+typename FrozenTree<Key, Value>::iterator
+FrozenTree<Key, Value>::end() const
+{
+    return iterator(this, 0);
+}
+
+template<typename Key, typename Value>
+typename FrozenTree<Key, Value>::iterator
+FrozenTree<Key, Value>::lower_bound(const Key& key) const
+{
+    return iterator(this, eytzingerLowerBound(keys_.data(), size(), key));
+}
+
+template<typename Key, typename Value>
+typename FrozenTree<Key, Value>::iterator
+FrozenTree<Key, Value>::find(const Key& key) const
+{
+    size_t k = eytzingerLowerBound(keys_.data(), size(), key);
+    if (k == 0 || key < keys_[k])
+    {
+        return end();
+    }
+    return iterator(this, k);
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns the value associated with the key
+ */
+template<typename Key, typename Value>
+Value const & FrozenTree<Key, Value>::operator[](const Key& key) const
+{
+    iterator it = find(key);
+    if(it == end()) throw std::out_of_range("Invalid key");
+    return it->second;
+}
+
+/**
+* Returns a frozen copy of tree's current contents. Later changes to
+* tree do not affect the copy. Works for BinarySearchTree and every tree
+* derived from it.
+*/
+template<typename Key, typename Value>
+FrozenTree<Key, Value> freeze(const BinarySearchTree<Key, Value>& tree)
+{
+    return FrozenTree<Key, Value>(tree.begin(), tree.end());
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "interval_tree.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Overlap queries on IntervalTree against the scan they replace: an
+// AVLTree from start to end, walked in start order until starts pass
+// the query. Intervals are short, with an occasional long one.
+//
+// usage: interval-bench [intervals ...]    (default: 1000000)
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    const uint64_t span = 1000000000;
+    for(size_t s = 0; s < sizes.size(); s++) {
+        size_t n = sizes[s];
+        vector<uint64_t> starts = makeUniformKeys<uint64_t>(n, 0, span, 1);
+        vector<uint64_t> lengths = makeUniformKeys<uint64_t>(n, 0, 2 * span / n, 2);
+        for(size_t i = 0; i < n; i += 1000) {
+            lengths[i] = span / 100;
+        }
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(1000, 0, span, 3);
+
+        AVLTree<uint64_t, uint64_t> scanned;
+        IntervalTree<uint64_t, uint64_t> tree;
+        BenchTimer timer;
+        for(size_t i = 0; i < n; i++) {
+            scanned.insert(make_pair(starts[i], starts[i] + lengths[i]));
+        }
+        double scanInsert = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            tree.insert(starts[i], starts[i] + lengths[i], i);
+        }
+        double treeInsert = timer.seconds();
+
+        uint64_t hits = 0;
+        timer.restart();
+        for(size_t q = 0; q < probes.size(); q++) {
+            uint64_t lo = probes[q], hi = probes[q] + span / n;
+            for(AVLTree<uint64_t, uint64_t>::iterator it = scanned.begin(); it != scanned.end() && it->first <= hi; ++it) {
+                hits += it->second >= lo;
+            }
+        }
+        double scanQuery = timer.seconds();
+        uint64_t treeHits = 0;
+        vector<IntervalTree<uint64_t, uint64_t>::iterator> found;
+        timer.restart();
+        for(size_t q = 0; q < probes.size(); q++) {
+            tree.overlapping(probes[q], probes[q] + span / n, found);
+            treeHits += found.size();
+        }
+        double treeQuery = timer.seconds();
+        benchSink(hits + treeHits);
+
+        cout << n << " intervals\tscan\tinsert " << scanInsert << " s\toverlap query "
+             << scanQuery * 1e6 / probes.size() << " us" << endl;
+        cout << n << " intervals\tinterval tree\tinsert " << treeInsert << " s\toverlap query "
+             << treeQuery * 1e6 / probes.size() << " us\tresults/query "
+             << double(treeHits) / probes.size() << (hits == treeHits ? "" : "\tMISMATCH") << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include "interval_tree.h"
+#include "serialize_bst.h"
+
+using namespace std;
+
+// An IntervalTree that can check its AVL balance and subtree ends.
+class CheckedIntervalTree : public IntervalTree<int, int>
+{
+public:
+    bool shapeValid() const
+    {
+        int height;
+        return check(static_cast<IntervalNode<int, int>*>(root_), nullptr, height);
+    }
+
+private:
+    static bool check(IntervalNode<int, int>* node, IntervalNode<int, int>* parent, int& height)
+    {
+        if(node == nullptr) {
+            height = 0;
+            return true;
+        }
+        int lh, rh;
+        bool ok = node->getParent() == parent
+                  && check(node->getLeft(), node, lh) && check(node->getRight(), node, rh);
+        int maxEnd = node->getEnd();
+        if(node->getLeft() != nullptr) {
+            maxEnd = max(maxEnd, node->getLeft()->getMaxEnd());
+        }
+        if(node->getRight() != nullptr) {
+            maxEnd = max(maxEnd, node->getRight()->getMaxEnd());
+        }
+        height = max(lh, rh) + 1;
+        return ok && node->getBalance() == rh - lh && node->getMaxEnd() == maxEnd;
+    }
+};
+
+// Checks an overlap query against a scan of the model.
+bool sameOverlaps(const CheckedIntervalTree& tree, const map<int, IntervalValue<int, int> >& model, int lo, int hi)
+{
+    vector<CheckedIntervalTree::iterator> found;
+    tree.overlapping(lo, hi, found);
+    size_t next = 0;
+    for(map<int, IntervalValue<int, int> >::const_iterator it = model.begin(); it != model.end(); ++it) {
+        if(it->first <= hi && it->second.end >= lo) {
+            if(next == found.size() || found[next]->first != it->first || found[next]->second != it->second) {
+                return false;
+            }
+            next++;
+        }
+    }
+    return next == found.size();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedIntervalTree tree;
+    map<int, IntervalValue<int, int> > model;
+    srand(47);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int start = rand() % 2000;
+        int op = rand() % 3;
+        if(op == 0) {
+            // mostly short intervals, a few very long ones
+            int end = start + (rand() % 20 == 0 ? rand() % 1000 : rand() % 30);
+            tree.insert(start, end, i);
+            model[start] = IntervalValue<int, int>(end, i);
+        }
+        else if(op == 1) {
+            tree.remove(start);
+            model.erase(start);
+        }
+        else {
+            int lo = rand() % 2100 - 50;
+            ok = ok && sameOverlaps(tree, model, lo, lo + rand() % 40);
+        }
+        if(i % 100 == 0) {
+            ok = ok && tree.shapeValid();
+        }
+    }
+    cout << "Random updates and overlaps: " << (ok && tree.shapeValid()) << endl;
+
+    // stabbing queries, including at interval ends
+    ok = true;
+    for(map<int, IntervalValue<int, int> >::iterator it = model.begin(); it != model.end(); ++it) {
+        vector<CheckedIntervalTree::iterator> found;
+        tree.stabbing(it->second.end, found);
+        bool contains = false;
+        for(size_t i = 0; i < found.size(); i++) {
+            contains = contains || found[i]->first == it->first;
+        }
+        ok = ok && contains && sameOverlaps(tree, model, it->second.end, it->second.end);
+    }
+    cout << "Stabbing queries: " << ok << endl;
+
+    // built trees carry correct subtree ends
+    vector<pair<int, IntervalValue<int, int> > > items;
+    model.clear();
+    for(int i = 0; i < 1000; i++) {
+        int end = i * 3 + (i % 17 == 0 ? 500 : 2);
+        items.push_back(make_pair(i * 3, IntervalValue<int, int>(end, i)));
+        model[i * 3] = IntervalValue<int, int>(end, i);
+    }
+    tree.buildSorted(items.begin(), items.size());
+    ok = tree.shapeValid();
+    for(int lo = -10; lo < 3100; lo += 7) {
+        ok = ok && sameOverlaps(tree, model, lo, lo + 5);
+    }
+    cout << "Built trees: " << ok << endl;
+
+    // erase during a scan keeps the subtree ends right
+    ok = true;
+    for(CheckedIntervalTree::iterator it = tree.begin(); it != tree.end(); ) {
+        if(it->first % 2 == 0) {
+            model.erase(it->first);
+            it = tree.erase(it);
+            ok = ok && tree.shapeValid();
+        }
+        else {
+            ++it;
+        }
+    }
+    for(int lo = -10; lo < 3100; lo += 7) {
+        ok = ok && sameOverlaps(tree, model, lo, lo + 5);
+    }
+    cout << "Erase during scan: " << ok << endl;
+
+    // a tree read back through the base-class buildSorted, as readTree
+    // does, still carries correct subtree ends
+    stringstream stream;
+    writeTree(tree, stream);
+    CheckedIntervalTree copy;
+    copy.insert(5000, 9000, 0);
+    BinarySearchTree<int, IntervalValue<int, int> >& base = copy;
+    readTree(stream, base);
+    ok = copy.shapeValid();
+    for(int lo = -10; lo < 3100; lo += 7) {
+        ok = ok && sameOverlaps(copy, model, lo, lo + 5);
+    }
+    cout << "Write and read back: " << ok << endl;
+
+    // so do batch updates made through an AVLTree reference
+    AVLTree<int, IntervalValue<int, int> >& avl = tree;
+    ok = true;
+    for(int round = 0; round < 50; round++) {
+        vector<pair<int, IntervalValue<int, int> > > batch;
+        vector<int> keys;
+        for(int i = 0; i < 40; i++) {
+            int start = rand() % 3000;
+            int end = start + (rand() % 20 == 0 ? rand() % 1000 : rand() % 30);
+            batch.push_back(make_pair(start, IntervalValue<int, int>(end, round)));
+            keys.push_back(rand() % 3000);
+        }
+        avl.insertBatch(batch);
+        for(size_t i = 0; i < batch.size(); i++) {
+            model[batch[i].first] = batch[i].second;
+        }
+        ok = ok && tree.shapeValid();
+        avl.removeBatch(keys);
+        for(size_t i = 0; i < keys.size(); i++) {
+            model.erase(keys[i]);
+        }
+        ok = ok && tree.shapeValid();
+    }
+    for(int lo = -10; lo < 4100; lo += 7) {
+        ok = ok && sameOverlaps(tree, model, lo, lo + 5);
+    }
+    cout << "Batch updates: " << ok << endl;
+
+    // and so does eraseRange, whose splits and join rebuild the spines
+    ok = true;
+    for(int round = 0; round < 50; round++) {
+        int lo = rand() % 3100 - 50;
+        int hi = lo + rand() % 200;
+        avl.eraseRange(lo, hi);
+        model.erase(model.lower_bound(lo), model.lower_bound(hi));
+        ok = ok && tree.shapeValid();
+        for(int i = 0; i < 10; i++) {
+            int start = rand() % 3000;
+            int end = start + (rand() % 10 == 0 ? rand() % 1000 : rand() % 30);
+            tree.insert(start, end, round);
+            model[start] = IntervalValue<int, int>(end, round);
+        }
+    }
+    for(int lo = -10; lo < 4100; lo += 7) {
+        ok = ok && sameOverlaps(tree, model, lo, lo + 5);
+    }
+    cout << "Range erase: " << ok << endl;
+    return 0;
+}
@@ -0,0 +1,332 @@
+#ifndef INTERVAL_TREE_H
+#define INTERVAL_TREE_H
+
+#include <cstddef>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "avlbst.h"
+
+/**
+* What an interval tree maps an interval's start to: its end and the
+* caller's value.
+*/
+template <typename Key, typename Value>
+struct IntervalValue
+{
+    IntervalValue() : end(), value()
+    {
+
+    }
+    IntervalValue(const Key& end, const Value& value) : end(end), value(value)
+    {
+
+    }
+
+    bool operator==(const IntervalValue& rhs) const
+    {
+        return end == rhs.end && value == rhs.value;
+    }
+    bool operator!=(const IntervalValue& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const IntervalValue& interval)
+    {
+        return out << "to " << interval.end << ": " << interval.value;
+    }
+
+    Key end;
+    Value value;
+};
+
+/**
+* A node for an interval tree, for the interval [key, value.end]. It
+* adds the largest end in its subtree.
+*/
+template <typename Key, typename Value>
+class IntervalNode : public AVLNode<Key, IntervalValue<Key, Value> >
+{
+public:
+    IntervalNode(const Key& start, const IntervalValue<Key, Value>& value, IntervalNode<Key, Value>* parent);
+    virtual ~IntervalNode();
+
+    const Key& getEnd() const;
+    const Key& getMaxEnd() const;
+    void setMaxEnd(const Key& maxEnd);
+
+    // Redefined to return IntervalNodes, as in AVLNode.
+    virtual IntervalNode<Key, Value>* getParent() const override;
+    virtual IntervalNode<Key, Value>* getLeft() const override;
+    virtual IntervalNode<Key, Value>* getRight() const override;
+
+protected:
+    Key maxEnd_;
+};
+
+/*
+  -------------------------------------------------
+  Begin implementations for the IntervalNode class.
+  -------------------------------------------------
+*/
+
+template<class Key, class Value>
+IntervalNode<Key, Value>::IntervalNode(const Key& start, const IntervalValue<Key, Value>& value, IntervalNode<Key, Value>* parent) :
+    AVLNode<Key, IntervalValue<Key, Value> >(start, value, parent), maxEnd_(value.end)
+{
+
+}
+
+template<class Key, class Value>
+IntervalNode<Key, Value>::~IntervalNode()
+{
+
+}
+
+template<class Key, class Value>
+const Key& IntervalNode<Key, Value>::getEnd() const
+{
+    return this->getValue().end;
+}
+
+template<class Key, class Value>
+const Key& IntervalNode<Key, Value>::getMaxEnd() const
+{
+    return maxEnd_;
+}
+
+template<class Key, class Value>
+void IntervalNode<Key, Value>::setMaxEnd(const Key& maxEnd)
+{
+    maxEnd_ = maxEnd;
+}
+
+template<class Key, class Value>
+IntervalNode<Key, Value>* IntervalNode<Key, Value>::getParent() const
+{
+    return static_cast<IntervalNode<Key, Value>*>(this->parent_);
+}
+
+template<class Key, class Value>
+IntervalNode<Key, Value>* IntervalNode<Key, Value>::getLeft() const
+{
+    return static_cast<IntervalNode<Key, Value>*>(this->left_);
+}
+
+template<class Key, class Value>
+IntervalNode<Key, Value>* IntervalNode<Key, Value>::getRight() const
+{
+    return static_cast<IntervalNode<Key, Value>*>(this->right_);
+}
+
+/*
+  -----------------------------------------------
+  End implementations for the IntervalNode class.
+  -----------------------------------------------
+*/
+
+/**
+* An AVLTree of closed intervals [start, end], keyed by start, whose
+* values are IntervalValues holding the end and a payload. Like any map
+* it holds one interval per start; inserting at a start already present
+* replaces that interval. Change an interval's end with insert, not through an
+* iterator or operator[], since the tree keeps per-subtree data on it.
+*
+* Every node also records the largest end in its subtree, kept up to
+* date by insert, remove, erase, the rotations and nodeSwap, and by
+* childrenChanged for buildSorted and the batch updates. An overlap query
+* skips any subtree whose largest end is before the query, and stops
+* going right once starts pass the query, so it only enters subtrees
+* that hold an overlapping interval, besides the O(log n) nodes on the
+* two boundary paths.
+*/
+template <class Key, class Value>
+class IntervalTree : public AVLTree<Key, IntervalValue<Key, Value> >
+{
+public:
+    virtual void insert(const std::pair<const Key, IntervalValue<Key, Value> >& new_item) override;
+    void insert(const Key& start, const Key& end, const Value& value);
+    virtual void remove(const Key& start) override;
+
+    typedef typename AVLTree<Key, IntervalValue<Key, Value> >::iterator iterator;
+
+    void overlapping(const Key& lo, const Key& hi, std::vector<iterator>& results) const;
+    void stabbing(const Key& point, std::vector<iterator>& results) const;
+
+protected:
+    virtual void nodeSwap(AVLNode<Key, IntervalValue<Key, Value> >* n1, AVLNode<Key, IntervalValue<Key, Value> >* n2) override;
+    virtual IntervalNode<Key, Value>* createNode(const Key& key, const IntervalValue<Key, Value>& value, AVLNode<Key, IntervalValue<Key, Value> >* parent) override;
+    virtual void rightRotate(AVLNode<Key, IntervalValue<Key, Value> >* node) override;
+    virtual void leftRotate(AVLNode<Key, IntervalValue<Key, Value> >* node) override;
+    virtual void removeNode(Node<Key, IntervalValue<Key, Value> >* node) override;
+    virtual void childrenChanged(Node<Key, IntervalValue<Key, Value> >* node) override;
+
+    static void updateMaxEnd(IntervalNode<Key, Value>* node);
+    static void updatePath(IntervalNode<Key, Value>* node);
+    static void overlapHelper(IntervalNode<Key, Value>* node, const Key& lo, const Key& hi, std::vector<iterator>& results);
+};
+
+/*
+ * Recall: If the start is already in the tree, that interval is replaced.
+ */
+template<class Key, class Value>
+void IntervalTree<Key, Value>::insert(const std::pair<const Key, IntervalValue<Key, Value> >& new_item)
+{
+    AVLTree<Key, IntervalValue<Key, Value> >::insert(new_item);
+    // the rotations on the way left the new node's ancestors to us
+    updatePath(static_cast<IntervalNode<Key, Value>*>(this->internalFind(new_item.first)));
+}
+
+template<class Key, class Value>
+void IntervalTree<Key, Value>::insert(const Key& start, const Key& end, const Value& value)
+{
+    insert(std::make_pair(start, IntervalValue<Key, Value>(end, value)));
+}
+
+template<class Key, class Value>
+void IntervalTree<Key, Value>::remove(const Key& start)
+{
+    Node<Key, IntervalValue<Key, Value> >* node = this->internalFind(start);
+    if (node != nullptr)
+    {
+        removeNode(node);
+    }
+}
+
+/**
+* Removes node as AVLTree does, fixing the ends above it before
+* removeFix rotates there. erase comes through here too.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::removeNode(Node<Key, IntervalValue<Key, Value> >* node)
+{
+    int8_t diff = 0;
+    AVLNode<Key, IntervalValue<Key, Value> >* parent = nullptr;
+    this->unlinkNode(static_cast<AVLNode<Key, IntervalValue<Key, Value> >*>(node), diff, &parent);
+    updatePath(static_cast<IntervalNode<Key, Value>*>(parent));
+    this->removeFix(parent, diff);
+}
+
+/**
+* buildSorted and the batch updates link nodes children first, so the
+* children's ends are already right when node's is recomputed.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::childrenChanged(Node<Key, IntervalValue<Key, Value> >* node)
+{
+    updateMaxEnd(static_cast<IntervalNode<Key, Value>*>(node));
+}
+
+/**
+* Stores in results, in order of start, an iterator to every interval
+* that overlaps [lo, hi], that is, with start <= hi and end >= lo.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::overlapping(const Key& lo, const Key& hi, std::vector<iterator>& results) const
+{
+    results.clear();
+    overlapHelper(static_cast<IntervalNode<Key, Value>*>(this->root_), lo, hi, results);
+}
+
+/**
+* Stores in results, in order of start, an iterator to every interval
+* that contains point.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::stabbing(const Key& point, std::vector<iterator>& results) const
+{
+    overlapping(point, point, results);
+}
+
+template<class Key, class Value>
+void IntervalTree<Key, Value>::overlapHelper(IntervalNode<Key, Value>* node, const Key& lo, const Key& hi, std::vector<iterator>& results)
+{
+    if (node == nullptr || node->getMaxEnd() < lo)
+    {
+        return;
+    }
+    overlapHelper(node->getLeft(), lo, hi, results);
+    if (hi < node->getKey())
+    {
+        return; // this node and everything right of it start too late
+    }
+    if (!(node->getEnd() < lo))
+    {
+        results.push_back(BinarySearchTree<Key, IntervalValue<Key, Value> >::iteratorAt(node));
+    }
+    overlapHelper(node->getRight(), lo, hi, results);
+}
+
+/**
+* Swaps two nodes with the AVL nodeSwap. The subtree ends are swapped
+* back, so each position in the tree keeps its own.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::nodeSwap(AVLNode<Key, IntervalValue<Key, Value> >* n1, AVLNode<Key, IntervalValue<Key, Value> >* n2)
+{
+    AVLTree<Key, IntervalValue<Key, Value> >::nodeSwap(n1, n2);
+    IntervalNode<Key, Value>* i1 = static_cast<IntervalNode<Key, Value>*>(n1);
+    IntervalNode<Key, Value>* i2 = static_cast<IntervalNode<Key, Value>*>(n2);
+    Key temp = i1->getMaxEnd();
+    i1->setMaxEnd(i2->getMaxEnd());
+    i2->setMaxEnd(temp);
+}
+
+template<class Key, class Value>
+IntervalNode<Key, Value>* IntervalTree<Key, Value>::createNode(const Key& key, const IntervalValue<Key, Value>& value, AVLNode<Key, IntervalValue<Key, Value> >* parent)
+{
+    return new IntervalNode<Key, Value>(key, value, static_cast<IntervalNode<Key, Value>*>(parent));
+}
+
+/**
+* After a rotation only the two nodes that traded places have new
+* subtrees: the one moved down first, then the one moved up.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::rightRotate(AVLNode<Key, IntervalValue<Key, Value> >* node)
+{
+    AVLTree<Key, IntervalValue<Key, Value> >::rightRotate(node);
+    updateMaxEnd(static_cast<IntervalNode<Key, Value>*>(node));
+    updateMaxEnd(static_cast<IntervalNode<Key, Value>*>(node->getParent()));
+}
+
+template<class Key, class Value>
+void IntervalTree<Key, Value>::leftRotate(AVLNode<Key, IntervalValue<Key, Value> >* node)
+{
+    AVLTree<Key, IntervalValue<Key, Value> >::leftRotate(node);
+    updateMaxEnd(static_cast<IntervalNode<Key, Value>*>(node));
+    updateMaxEnd(static_cast<IntervalNode<Key, Value>*>(node->getParent()));
+}
+
+/**
+* Recomputes node's subtree end from its own end and its children's.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::updateMaxEnd(IntervalNode<Key, Value>* node)
+{
+    Key maxEnd = node->getEnd();
+    if (node->getLeft() != nullptr && maxEnd < node->getLeft()->getMaxEnd())
+    {
+        maxEnd = node->getLeft()->getMaxEnd();
+    }
+    if (node->getRight() != nullptr && maxEnd < node->getRight()->getMaxEnd())
+    {
+        maxEnd = node->getRight()->getMaxEnd();
+    }
+    node->setMaxEnd(maxEnd);
+}
+
+/**
+* Recomputes the subtree ends from node up to the root.
+*/
+template<class Key, class Value>
+void IntervalTree<Key, Value>::updatePath(IntervalNode<Key, Value>* node)
+{
+    for (; node != nullptr; node = node->getParent())
+    {
+        updateMaxEnd(node);
+    }
+}
+
+#endif
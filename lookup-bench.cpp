@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Point lookup throughput on one AVLTree: find, one key at a time,
+// against findMany, which interleaves the descents of many keys.
+//
+// usage: lookup-bench [keys ...]    (default: 1000000)
+// e.g.   lookup-bench 1000000 10000000 100000000
+
+const size_t probeCount = 2000000;
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1, 2);
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(probeCount, 0, 2 * sizes[s] - 1, 2);
+        AVLTree<uint64_t, uint64_t> tree;
+        for(size_t i = 0; i < keys.size(); i++) {
+            tree.insert(make_pair(keys[i], keys[i]));
+        }
+
+        BenchTimer timer;
+        uint64_t sum = 0;
+        for(size_t i = 0; i < probes.size(); i++) {
+            AVLTree<uint64_t, uint64_t>::iterator it = tree.find(probes[i]);
+            if(it != tree.end()) {
+                sum += it->second;
+            }
+        }
+        double findSeconds = timer.seconds();
+
+        timer.restart();
+        vector<AVLTree<uint64_t, uint64_t>::iterator> results;
+        tree.findMany(probes, results);
+        for(size_t i = 0; i < results.size(); i++) {
+            if(results[i] != tree.end()) {
+                sum += results[i]->second;
+            }
+        }
+        double findManySeconds = timer.seconds();
+        benchSink(sum);
+
+        cout << keys.size() << " keys"
+             << "\tfind " << probes.size() / findSeconds / 1e6 << " M/s"
+             << "\tfindMany " << probes.size() / findManySeconds / 1e6 << " M/s" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "mapped_bst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Startup cost of rebuilding an AVLTree by insert, against opening a
+// file written by writeMapped(), mapped or read, and serving lookups.
+//
+// usage: mapped-bench [keys ...]    (default: 1000000)
+// The file is written to mapped-bench.tmp in the current directory.
+
+template<typename Tree>
+double lookups(const Tree& tree, const vector<uint64_t>& probes)
+{
+    BenchTimer timer;
+    uint64_t sum = 0;
+    for(size_t i = 0; i < probes.size(); i++) {
+        typename Tree::iterator it = tree.find(probes[i]);
+        if(it != tree.end()) {
+            sum += it->second;
+        }
+    }
+    benchSink(sum);
+    return probes.size() / timer.seconds() / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    const char* path = "mapped-bench.tmp";
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1, 2);
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(1000000, 0, 2 * sizes[s] - 1, 2);
+
+        BenchTimer timer;
+        AVLTree<uint64_t, uint64_t> tree;
+        for(size_t i = 0; i < keys.size(); i++) {
+            tree.insert(make_pair(keys[i], keys[i]));
+        }
+        double rebuildSeconds = timer.seconds();
+        timer.restart();
+        writeMapped(tree, path);
+        double writeSeconds = timer.seconds();
+        cout << "AVLTree\t" << keys.size() << "\tstartup " << rebuildSeconds << " s"
+             << "\tlookup " << lookups(tree, probes) << " M/s"
+             << "\t(write file " << writeSeconds << " s)" << endl;
+
+        for(int useMmap = 1; useMmap >= 0; useMmap--) {
+            timer.restart();
+            MappedTree<uint64_t, uint64_t> mapped(path, useMmap);
+            double openSeconds = timer.seconds();
+            cout << (useMmap ? "mmap" : "read") << "\t" << keys.size()
+                 << "\tstartup " << openSeconds << " s"
+                 << "\tlookup " << lookups(mapped, probes) << " M/s" << endl;
+        }
+        remove(path);
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include "avlbst.h"
+#include "mapped_bst.h"
+
+using namespace std;
+
+// Checks that a MappedTree holds exactly the contents of expected.
+bool sameContents(const MappedTree<int, double>& tree, const map<int, double>& expected)
+{
+    map<int, double>::const_iterator exp = expected.begin();
+    for(MappedTree<int, double>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    if(exp != expected.end() || tree.size() != expected.size()) {
+        return false;
+    }
+    for(int key = -1; key <= 10001; key++) {
+        bool present = expected.count(key) > 0;
+        if(present != (tree.find(key) != tree.end())) {
+            return false;
+        }
+        if(present && tree[key] != expected.find(key)->second) {
+            return false;
+        }
+        map<int, double>::const_iterator lb = expected.lower_bound(key);
+        MappedTree<int, double>::iterator mlb = tree.lower_bound(key);
+        if((lb == expected.end()) != (mlb == tree.end()) || (lb != expected.end() && lb->first != mlb->first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char* path = "mapped-test.tmp";
+    AVLTree<int,double> at;
+    map<int,double> model;
+    srand(106);
+    for(int i = 0; i < 3000; i++) {
+        int key = rand() % 10000;
+        at.insert(make_pair(key, i * 0.5));
+        model[key] = i * 0.5;
+    }
+    writeMapped(at, path);
+    at.clear();
+
+    {
+        MappedTree<int,double> mt(path);
+        cout << "Mapped: " << mt.mapped() << " contents match: " << sameContents(mt, model) << endl;
+    }
+    {
+        MappedTree<int,double> rt(path, false);
+        cout << "Read: " << !rt.mapped() << " contents match: " << sameContents(rt, model) << endl;
+    }
+
+    try {
+        MappedTree<long, double> wrong(path);
+        cout << "Wrong key type rejected: 0" << endl;
+    }
+    catch(const runtime_error&) {
+        cout << "Wrong key type rejected: 1" << endl;
+    }
+
+    // cut the file short
+    FILE* f = fopen(path, "r+b");
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fclose(f);
+    if(truncate(path, length - 8) != 0) {
+        cout << "truncate failed" << endl;
+    }
+    try {
+        MappedTree<int, double> cut(path);
+        cout << "Truncated file rejected: 0" << endl;
+    }
+    catch(const runtime_error&) {
+        cout << "Truncated file rejected: 1" << endl;
+    }
+
+    writeMapped(at, path);
+    MappedTree<int,double> none(path);
+    cout << "Empty tree: " << (none.empty() && none.begin() == none.end()) << endl;
+    remove(path);
+    return 0;
+}
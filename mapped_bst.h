@@ -0,0 +1,455 @@
+#ifndef MAPPED_BST_H
+#define MAPPED_BST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bst.h"
+#include "frozen_bst.h"
+
+/**
+* The header at the start of a mapped tree file. All positions in the
+* file are offsets from its start, so the file can be mapped at any
+* address. Numbers are stored in the writer's native byte order.
+*/
+struct MappedHeader
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t keySize_;
+    uint32_t valueSize_;
+    uint32_t itemSize_;
+    uint64_t count_;
+    uint64_t keysOffset_;     // count_ + 1 keys, Eytzinger order, slot 0 unused
+    uint64_t itemsOffset_;    // count_ items, same order
+    uint64_t fileSize_;
+};
+
+static_assert(sizeof(MappedHeader) <= 64, "the header must fit before the key array");
+
+static const char mappedMagic[8] = { 'B', 'S', 'T', 'M', 'A', 'P', '\0', '\0' };
+static const uint32_t mappedVersion = 1;
+
+/**
+* A read-only tree served straight from a file written by writeMapped().
+*
+* The file holds the same Eytzinger layout as FrozenTree: one array of
+* keys for searching and one of items in the same order. By default the
+* file is mmap'ed and queried in place, so opening costs one system call
+* and pages are faulted in as lookups touch them, instead of re-inserting
+* every entry. Passing useMmap = false reads the whole file into memory
+* with plain read() calls instead, for filesystems that cannot be mapped.
+*
+* Only trees whose Key and Value are trivially copyable can be stored,
+* and a file can only be read on a machine with the same byte order and
+* type sizes as the writer's (the sizes are checked against the header).
+*/
+template <typename Key, typename Value>
+class MappedTree
+{
+public:
+    explicit MappedTree(const std::string& path, bool useMmap = true);
+    ~MappedTree();
+
+    bool empty() const;
+    size_t size() const;
+    bool mapped() const;
+
+    /**
+    * An iterator for traversing the items in key order.
+    */
+    class iterator
+    {
+    public:
+        iterator();
+
+        const std::pair<const Key, Value>& operator*() const;
+        const std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class MappedTree<Key, Value>;
+        iterator(const MappedTree<Key, Value>* tree, size_t index);
+
+        const MappedTree<Key, Value>* tree_;
+        size_t index_;    // Eytzinger index, 0 at the end
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    Value const & operator[](const Key& key) const;
+
+private:
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "MappedTree needs trivially copyable keys and values");
+
+    typedef std::pair<const Key, Value> Item;
+
+    MappedTree(const MappedTree&);
+    MappedTree& operator=(const MappedTree&);
+
+    void readAll(int fd, size_t length);
+    void check(size_t length);
+    void release();
+
+    void* base_;        // the mapping or the buffer holding the file
+    size_t length_;
+    bool mapped_;
+    size_t count_;
+    const Key* keys_;
+    const Item* items_;
+};
+
+/*
+-----------------------------------------------------------
+Begin implementations for the MappedTree::iterator class.
+-----------------------------------------------------------
+*/
+
+template<typename Key, typename Value>
+MappedTree<Key, Value>::iterator::iterator() :
+    tree_(nullptr),
+    index_(0)
+{
+
+}
+
+template<typename Key, typename Value>
+MappedTree<Key, Value>::iterator::iterator(const MappedTree<Key, Value>* tree, size_t index) :
+    tree_(tree),
+    index_(index)
+{
+
+}
+
+template<typename Key, typename Value>
+const std::pair<const Key, Value>&
+MappedTree<Key, Value>::iterator::operator*() const
+{
+    return tree_->items_[index_ - 1];
+}
+
+template<typename Key, typename Value>
+const std::pair<const Key, Value>*
+MappedTree<Key, Value>::iterator::operator->() const
+{
+    return &tree_->items_[index_ - 1];
+}
+
+template<typename Key, typename Value>
+bool MappedTree<Key, Value>::iterator::operator==(const iterator& rhs) const
+{
+    return index_ == rhs.index_;
+}
+
+template<typename Key, typename Value>
+bool MappedTree<Key, Value>::iterator::operator!=(const iterator& rhs) const
+{
+    return index_ != rhs.index_;
+}
+
+template<typename Key, typename Value>
+typename MappedTree<Key, Value>::iterator&
+MappedTree<Key, Value>::iterator::operator++()
+{
+    index_ = eytzingerNext(index_, tree_->count_);
+    return *this;
+}
+
+/*
+---------------------------------------------------------
+End implementations for the MappedTree::iterator class.
+---------------------------------------------------------
+*/
+
+/**
+* Opens the file at path. Throws std::runtime_error if it cannot be
+* opened or is not a mapped tree of this Key and Value.
+*/
+template<typename Key, typename Value>
+MappedTree<Key, Value>::MappedTree(const std::string& path, bool useMmap) :
+    base_(nullptr),
+    length_(0),
+    mapped_(false),
+    count_(0),
+    keys_(nullptr),
+    items_(nullptr)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    size_t length = info.st_size;
+    if (length < sizeof(MappedHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a mapped tree: " + path);
+    }
+
+    if (useMmap)
+    {
+        base_ = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base_ == MAP_FAILED)
+        {
+            base_ = nullptr;
+        }
+        else
+        {
+            mapped_ = true;
+            length_ = length;
+        }
+    }
+    try
+    {
+        if (!mapped_)
+        {
+            readAll(fd, length);
+        }
+        check(length);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        release();
+        throw;
+    }
+    ::close(fd);
+}
+
+template<typename Key, typename Value>
+MappedTree<Key, Value>::~MappedTree()
+{
+    release();
+}
+
+/**
+* The fallback: copies the file into a buffer aligned like a mapping's
+* pages would be.
+*/
+template<typename Key, typename Value>
+void MappedTree<Key, Value>::readAll(int fd, size_t length)
+{
+    if (::posix_memalign(&base_, 64, length) != 0)
+    {
+        base_ = nullptr;
+        throw std::bad_alloc();
+    }
+    length_ = length;
+    size_t done = 0;
+    while (done < length)
+    {
+        ssize_t got = ::read(fd, static_cast<char*>(base_) + done, length - done);
+        if (got <= 0)
+        {
+            throw std::runtime_error("Short read of mapped tree");
+        }
+        done += got;
+    }
+}
+
+/**
+* Validates the header against this Key and Value and the file length,
+* and locates the arrays.
+*/
+template<typename Key, typename Value>
+void MappedTree<Key, Value>::check(size_t length)
+{
+    const MappedHeader* header = static_cast<const MappedHeader*>(base_);
+    if (std::memcmp(header->magic_, mappedMagic, sizeof(mappedMagic)) != 0 ||
+        header->version_ != mappedVersion)
+    {
+        throw std::runtime_error("Not a mapped tree");
+    }
+    if (header->keySize_ != sizeof(Key) || header->valueSize_ != sizeof(Value) ||
+        header->itemSize_ != sizeof(Item))
+    {
+        throw std::runtime_error("Mapped tree has different key or value types");
+    }
+    uint64_t count = header->count_;
+    if (header->fileSize_ != length || count > length ||
+        header->keysOffset_ < sizeof(MappedHeader) ||
+        header->keysOffset_ % alignof(Key) != 0 || header->itemsOffset_ % alignof(Item) != 0 ||
+        header->keysOffset_ + (count + 1) * sizeof(Key) > length ||
+        header->itemsOffset_ + count * sizeof(Item) > length)
+    {
+        throw std::runtime_error("Mapped tree is truncated or corrupt");
+    }
+    const char* bytes = static_cast<const char*>(base_);
+    count_ = count;
+    keys_ = reinterpret_cast<const Key*>(bytes + header->keysOffset_);
+    items_ = reinterpret_cast<const Item*>(bytes + header->itemsOffset_);
+}
+
+template<typename Key, typename Value>
+void MappedTree<Key, Value>::release()
+{
+    if (base_ == nullptr)
+    {
+        return;
+    }
+    if (mapped_)
+    {
+        ::munmap(base_, length_);
+    }
+    else
+    {
+        std::free(base_);
+    }
+    base_ = nullptr;
+}
+
+template<typename Key, typename Value>
+bool MappedTree<Key, Value>::empty() const
+{
+    return count_ == 0;
+}
+
+template<typename Key, typename Value>
+size_t MappedTree<Key, Value>::size() const
+{
+    return count_;
+}
+
+/**
+* Returns whether the file is mapped (rather than read into memory).
+*/
+template<typename Key, typename Value>
+bool MappedTree<Key, Value>::mapped() const
+{
+    return mapped_;
+}
+
+template<typename Key, typename Value>
+typename MappedTree<Key, Value>::iterator
+MappedTree<Key, Value>::begin() const
+{
+    return iterator(this, eytzingerFirst(count_));
+}
+
+template<typename Key, typename Value>
+typename MappedTree<Key, Value>::iterator
+MappedTree<Key, Value>::end() const
+{
+    return iterator(this, 0);
+}
+
+template<typename Key, typename Value>
+typename MappedTree<Key, Value>::iterator
+MappedTree<Key, Value>::lower_bound(const Key& key) const
+{
+    return iterator(this, eytzingerLowerBound(keys_, count_, key));
+}
+
+template<typename Key, typename Value>
+typename MappedTree<Key, Value>::iterator
+MappedTree<Key, Value>::find(const Key& key) const
+{
+    size_t k = eytzingerLowerBound(keys_, count_, key);
+    if (k == 0 || key < keys_[k])
+    {
+        return end();
+    }
+    return iterator(this, k);
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns the value associated with the key
+ */
+template<typename Key, typename Value>
+Value const & MappedTree<Key, Value>::operator[](const Key& key) const
+{
+    iterator it = find(key);
+    if(it == end()) throw std::out_of_range("Invalid key");
+    return it->second;
+}
+
+/**
+* Writes tree's contents to path in the format MappedTree reads. The
+* items are collected in one in-order pass and written in Eytzinger order.
+* Throws std::runtime_error if the file cannot be written.
+*/
+template<typename Key, typename Value>
+void writeMapped(const BinarySearchTree<Key, Value>& tree, const std::string& path)
+{
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "writeMapped needs trivially copyable keys and values");
+    typedef std::pair<const Key, Value> Item;
+
+    std::vector<const Item*> sorted;
+    for (typename BinarySearchTree<Key, Value>::iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        sorted.push_back(&(*it));
+    }
+    std::vector<size_t> order = eytzingerOrder(sorted.size());
+
+    // arrays start on cache line boundaries, as a mapping is page aligned
+    MappedHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic_, mappedMagic, sizeof(mappedMagic));
+    header.version_ = mappedVersion;
+    header.keySize_ = sizeof(Key);
+    header.valueSize_ = sizeof(Value);
+    header.itemSize_ = sizeof(Item);
+    header.count_ = sorted.size();
+    header.keysOffset_ = 64;
+    header.itemsOffset_ = (header.keysOffset_ + (sorted.size() + 1) * sizeof(Key) + 63) / 64 * 64;
+    header.fileSize_ = header.itemsOffset_ + sorted.size() * sizeof(Item);
+
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (out == nullptr)
+    {
+        throw std::runtime_error("Cannot create " + path);
+    }
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+
+    const char zeros[64] = { 0 };
+    const std::vector<char> zeroKey(sizeof(Key), 0);
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+              std::fwrite(zeros, header.keysOffset_ - sizeof(header), 1, out) == 1;
+    for (size_t k = 0; ok && k < order.size(); ++k)
+    {
+        // slot 0 is never searched; fill it with zeros
+        const void* key = k == 0 ? static_cast<const void*>(zeroKey.data()) : &sorted[order[k]]->first;
+        ok = std::fwrite(key, sizeof(Key), 1, out) == 1;
+    }
+    size_t padding = header.itemsOffset_ - header.keysOffset_ - (sorted.size() + 1) * sizeof(Key);
+    ok = ok && (padding == 0 || std::fwrite(zeros, padding, 1, out) == 1);
+    for (size_t k = 1; ok && k < order.size(); ++k)
+    {
+        ok = std::fwrite(sorted[order[k]], sizeof(Item), 1, out) == 1;
+    }
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok)
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "avlbst.h"
+#include "avl_multimap.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// AVLMultiMap against the AVLTree<Key, vector<Value>> it replaces and
+// std::multimap: inserting items with duplicate keys, reading every
+// item of each key, and erasing them one at a time.
+//
+// usage: multimap-bench [items ...]    (default: 1000000, 4 per key)
+
+// The per-key vector of the old approach; print() needs it streamable.
+struct Bucket
+{
+    vector<uint64_t> values;
+
+    friend ostream& operator<<(ostream& out, const Bucket& bucket)
+    {
+        return out << bucket.values.size() << " values";
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        size_t n = sizes[s];
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(n / 4, 1);
+        vector<uint64_t> items;
+        for(int copy = 0; copy < 4; copy++) {
+            items.insert(items.end(), keys.begin(), keys.end());
+        }
+        uint64_t sum = 0;
+
+        AVLTree<uint64_t, Bucket> vectors;
+        BenchTimer timer;
+        for(size_t i = 0; i < items.size(); i++) {
+            AVLTree<uint64_t, Bucket>::iterator it = vectors.find(items[i]);
+            if(it == vectors.end()) {
+                Bucket bucket;
+                bucket.values.push_back(i);
+                vectors.insert(make_pair(items[i], bucket));
+            }
+            else {
+                it->second.values.push_back(i);
+            }
+        }
+        double insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < keys.size(); i++) {
+            const vector<uint64_t>& values = vectors.find(keys[i])->second.values;
+            for(size_t j = 0; j < values.size(); j++) {
+                sum += values[j];
+            }
+        }
+        double rangeSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < items.size(); i++) {
+            vector<uint64_t>& values = vectors.find(items[i])->second.values;
+            values.erase(values.begin());
+            if(values.empty()) {
+                vectors.remove(items[i]);
+            }
+        }
+        double eraseSeconds = timer.seconds();
+        cout << items.size() << " items\tavl of vectors\tinsert " << insertSeconds << " s\tequal_range "
+             << rangeSeconds << " s\terase " << eraseSeconds << " s" << endl;
+
+        AVLMultiMap<uint64_t, uint64_t> mm;
+        timer.restart();
+        for(size_t i = 0; i < items.size(); i++) {
+            mm.insert(make_pair(items[i], i));
+        }
+        insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < keys.size(); i++) {
+            pair<AVLMultiMap<uint64_t, uint64_t>::iterator, AVLMultiMap<uint64_t, uint64_t>::iterator> range = mm.equal_range(keys[i]);
+            for(; range.first != range.second; ++range.first) {
+                sum += range.first->second;
+            }
+        }
+        rangeSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < items.size(); i++) {
+            mm.erase(mm.find(items[i]));
+        }
+        eraseSeconds = timer.seconds();
+        cout << items.size() << " items\tavl multimap\tinsert " << insertSeconds << " s\tequal_range "
+             << rangeSeconds << " s\terase " << eraseSeconds << " s" << endl;
+
+        multimap<uint64_t, uint64_t> stdmm;
+        timer.restart();
+        for(size_t i = 0; i < items.size(); i++) {
+            stdmm.insert(make_pair(items[i], i));
+        }
+        insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < keys.size(); i++) {
+            pair<multimap<uint64_t, uint64_t>::iterator, multimap<uint64_t, uint64_t>::iterator> range = stdmm.equal_range(keys[i]);
+            for(; range.first != range.second; ++range.first) {
+                sum += range.first->second;
+            }
+        }
+        rangeSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < items.size(); i++) {
+            stdmm.erase(stdmm.find(items[i]));
+        }
+        eraseSeconds = timer.seconds();
+        cout << items.size() << " items\tstd::multimap\tinsert " << insertSeconds << " s\tequal_range "
+             << rangeSeconds << " s\terase " << eraseSeconds << " s" << endl;
+        benchSink(sum);
+    }
+    return 0;
+}
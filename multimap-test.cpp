@@ -0,0 +1,211 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+#include "avl_multimap.h"
+#include "serialize_bst.h"
+
+using namespace std;
+
+// An AVLMultiMap that can check its AVL balance and parent links.
+class CheckedMultiMap : public AVLMultiMap<int, int>
+{
+public:
+    bool shapeValid() const
+    {
+        int height;
+        return check(static_cast<AVLNode<int, int>*>(root_), nullptr, height);
+    }
+
+private:
+    static bool check(AVLNode<int, int>* node, AVLNode<int, int>* parent, int& height)
+    {
+        if(node == nullptr) {
+            height = 0;
+            return true;
+        }
+        int lh, rh;
+        bool ok = node->getParent() == parent
+                  && check(node->getLeft(), node, lh) && check(node->getRight(), node, rh);
+        height = max(lh, rh) + 1;
+        return ok && node->getBalance() == rh - lh;
+    }
+};
+
+// Checks that a multimap holds exactly the items of expected, in order,
+// equal keys included.
+bool sameContents(const CheckedMultiMap& mm, const multimap<int, int>& expected)
+{
+    multimap<int, int>::const_iterator exp = expected.begin();
+    for(CheckedMultiMap::iterator it = mm.begin(); it != mm.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedMultiMap mm;
+    multimap<int, int> model;
+    srand(48);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 200;
+        int op = rand() % 5;
+        if(op < 3) {
+            mm.insert(make_pair(key, i));
+            model.insert(make_pair(key, i));
+        }
+        else if(op == 3 && model.count(key) > 0) {
+            // erase one duplicate, chosen at random
+            size_t skip = rand() % model.count(key);
+            CheckedMultiMap::iterator it = mm.equal_range(key).first;
+            multimap<int, int>::iterator exp = model.equal_range(key).first;
+            for(size_t j = 0; j < skip; j++) {
+                ++it;
+                ++exp;
+            }
+            CheckedMultiMap::iterator next = mm.erase(it);
+            exp = model.erase(exp);
+            ok = ok && (exp == model.end() ? next == mm.end()
+                                           : (next != mm.end() && next->first == exp->first && next->second == exp->second));
+        }
+        else if(op == 4 && rand() % 10 == 0) {
+            mm.remove(key);
+            model.erase(key);
+        }
+        else {
+            pair<CheckedMultiMap::iterator, CheckedMultiMap::iterator> range = mm.equal_range(key);
+            multimap<int, int>::iterator exp = model.lower_bound(key);
+            for(; range.first != range.second; ++range.first, ++exp) {
+                ok = ok && exp != model.end() && range.first->second == exp->second;
+            }
+            ok = ok && exp == model.upper_bound(key) && mm.count(key) == model.count(key);
+        }
+        if(i % 200 == 0) {
+            ok = ok && sameContents(mm, model) && mm.shapeValid();
+        }
+    }
+    cout << "Random updates match: " << (ok && sameContents(mm, model) && mm.shapeValid()) << endl;
+
+    // find and operator[] give the oldest item of a key
+    CheckedMultiMap small;
+    small.insert(make_pair(5, 1));
+    small.insert(make_pair(3, 2));
+    small.insert(make_pair(5, 3));
+    small.insert(make_pair(5, 4));
+    bool threw = false;
+    try {
+        small[4];
+    }
+    catch(out_of_range&) {
+        threw = true;
+    }
+    cout << "find and operator[]: "
+         << (threw && small.find(5)->second == 1 && small[5] == 1 && small.count(5) == 3
+             && small.find(4) == small.end() && small.lower_bound(4)->first == 5
+             && small.upper_bound(5) == small.end()) << endl;
+
+    // built from sorted items with duplicates
+    vector<pair<int, int> > items;
+    model.clear();
+    for(int i = 0; i < 500; i++) {
+        items.push_back(make_pair(i / 7, i));
+        model.insert(make_pair(i / 7, i));
+    }
+    mm.buildSorted(items.begin(), items.size());
+    ok = mm.shapeValid() && sameContents(mm, model);
+    for(int key = 0; key < 72; key++) {
+        ok = ok && mm.count(key) == model.count(key);
+    }
+    for(int i = 0; i < 500; i++) {
+        mm.insert(make_pair(i % 80, -i));
+        model.insert(make_pair(i % 80, -i));
+    }
+    cout << "Built multimaps: " << (ok && mm.shapeValid() && sameContents(mm, model)) << endl;
+
+    // eraseRange takes every duplicate of the keys in range
+    mm.eraseRange(10, 40);
+    model.erase(model.lower_bound(10), model.lower_bound(40));
+    mm.eraseRange(-5, 3);
+    model.erase(model.begin(), model.lower_bound(3));
+    cout << "Range erase: " << (mm.shapeValid() && sameContents(mm, model) && mm.count(40) == model.count(40)) << endl;
+
+    // reached through its base classes it still keeps every duplicate
+    AVLTree<int, int>& avl = mm;
+    BinarySearchTree<int, int>& bst = mm;
+    ok = true;
+    for(int round = 0; round < 20; round++) {
+        vector<pair<int, int> > batch;
+        vector<int> keys;
+        for(int i = 0; i < 30; i++) {
+            batch.push_back(make_pair(rand() % 100, round * 100 + i));
+            keys.push_back(rand() % 100);
+        }
+        avl.insertBatch(batch);
+        for(size_t i = 0; i < batch.size(); i++) {
+            model.insert(batch[i]);
+        }
+        ok = ok && mm.shapeValid() && sameContents(mm, model);
+        avl.removeBatch(keys);
+        for(size_t i = 0; i < keys.size(); i++) {
+            model.erase(keys[i]);
+        }
+        ok = ok && mm.shapeValid() && sameContents(mm, model);
+    }
+    for(int key = -1; key < 101; key++) {
+        multimap<int, int>::iterator oldest = model.lower_bound(key);
+        if(oldest == model.end() || oldest->first != key) {
+            ok = ok && bst.find(key) == bst.end();
+        }
+        else {
+            ok = ok && bst.find(key)->second == oldest->second && bst[key] == oldest->second;
+        }
+    }
+    cout << "Through base classes: " << ok << endl;
+
+    // the batched lookups return the same oldest item as find
+    CheckedMultiMap dups;
+    vector<int> probes;
+    for(int i = 0; i < 200; i++) {
+        dups.insert(make_pair(i % 5 * 2, i));
+        probes.push_back(i % 13 - 1);
+    }
+    vector<CheckedMultiMap::iterator> found;
+    dups.findMany(probes, found);
+    ok = found.size() == probes.size();
+    for(size_t i = 0; ok && i < probes.size(); i++) {
+        ok = found[i] == dups.find(probes[i]);
+    }
+    cout << "findMany matches find: " << (ok && dups.find(0)->second == 0) << endl;
+
+    // a written multimap reads back with its duplicates in order, while a
+    // tree of unique keys still refuses the stream
+    stringstream stream;
+    writeTree(dups, stream);
+    string bytes = stream.str();
+    CheckedMultiMap loaded;
+    stringstream in(bytes);
+    readTree(in, loaded);
+    multimap<int, int> dupsModel;
+    for(int i = 0; i < 200; i++) {
+        dupsModel.insert(make_pair(i % 5 * 2, i));
+    }
+    AVLTree<int, int> unique;
+    stringstream again(bytes);
+    threw = false;
+    try {
+        readTree(again, unique);
+    }
+    catch(runtime_error&) {
+        threw = true;
+    }
+    cout << "Write and read back: "
+         << (loaded.shapeValid() && sameContents(loaded, dupsModel) && loaded.find(4)->second == 2
+             && threw && unique.empty()) << endl;
+    return 0;
+}
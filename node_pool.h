@@ -0,0 +1,95 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+* A simple free-list allocator for tree nodes of type T.
+*
+* Memory is carved out of slabs of slabSize nodes and recycled through
+* a free list, so a tree that owns a pool stops going through the global
+* heap (and its locks) once it has warmed up. The pool is not thread-safe;
+* it is meant to be owned by one tree and used under that tree's lock.
+* Nodes still allocated when the pool is destroyed are not destructed,
+* so the owner must destroy its nodes first.
+*/
+template <class T, size_t slabSize = 1024>
+class NodePool
+{
+public:
+    NodePool();
+    ~NodePool();
+
+    template<typename... Args>
+    T* create(Args&&... args);
+    void destroy(T* node);
+
+private:
+    NodePool(const NodePool&);
+    NodePool& operator=(const NodePool&);
+
+    union Slot
+    {
+        Slot* next_;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+    };
+
+    Slot* free_;
+    std::vector<Slot*> slabs_;
+};
+
+template<class T, size_t slabSize>
+NodePool<T, slabSize>::NodePool() :
+    free_(nullptr)
+{
+
+}
+
+template<class T, size_t slabSize>
+NodePool<T, slabSize>::~NodePool()
+{
+    for (size_t i = 0; i < slabs_.size(); ++i)
+    {
+        delete [] slabs_[i];
+    }
+}
+
+/**
+* Constructs a T from args in pooled memory.
+*/
+template<class T, size_t slabSize>
+template<typename... Args>
+T* NodePool<T, slabSize>::create(Args&&... args)
+{
+    if (free_ == nullptr)
+    {
+        Slot* slab = new Slot[slabSize];
+        slabs_.push_back(slab);
+        for (size_t i = 0; i < slabSize; ++i)
+        {
+            slab[i].next_ = free_;
+            free_ = &slab[i];
+        }
+    }
+    Slot* slot = free_;
+    free_ = slot->next_;
+    return new (&slot->storage_) T(std::forward<Args>(args)...);
+}
+
+/**
+* Destructs node and returns its memory to the free list.
+*/
+template<class T, size_t slabSize>
+void NodePool<T, slabSize>::destroy(T* node)
+{
+    node->~T();
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next_ = free_;
+    free_ = slot;
+}
+
+#endif
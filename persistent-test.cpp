@@ -0,0 +1,61 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include "persistent_avlbst.h"
+
+using namespace std;
+
+// Checks that a PersistentAVLTree holds exactly the contents of expected.
+template<typename Tree>
+bool sameContents(const Tree& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(typename Tree::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    PersistentAVLTree<int,int> pt;
+    map<int,int> model;
+    srand(104);
+    for(int i = 0; i < 2000; i++) {
+        int key = rand() % 500;
+        pt.insert(make_pair(key, i));
+        model[key] = i;
+    }
+
+    // take a snapshot and keep mutating the original
+    PersistentAVLTree<int,int> snap = pt.snapshot();
+    map<int,int> snapModel = model;
+    PersistentAVLTree<int,int>::iterator held = snap.begin();
+    for(int i = 0; i < 2000; i++) {
+        int key = rand() % 500;
+        if(i % 2) {
+            pt.remove(key);
+            model.erase(key);
+        }
+        else {
+            pt.insert(make_pair(key, -i));
+            model[key] = -i;
+        }
+    }
+
+    cout << "Current version matches: " << sameContents(pt, model) << endl;
+    cout << "Snapshot unchanged: " << sameContents(snap, snapModel) << endl;
+    cout << "Held iterator still valid: " << (held->first == snapModel.begin()->first) << endl;
+
+    bool found = true;
+    for(map<int,int>::iterator it = model.begin(); it != model.end(); ++it) {
+        found = found && pt.find(it->first) != pt.end() && pt[it->first] == it->second;
+    }
+    cout << "Find matches: " << found << endl;
+
+    pt.clear();
+    cout << "Cleared: " << pt.empty() << " snapshot empty: " << snap.empty() << endl;
+    return 0;
+}
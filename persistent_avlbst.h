@@ -0,0 +1,440 @@
+#ifndef PERSISTENT_AVLBST_H
+#define PERSISTENT_AVLBST_H
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+* A persistent (copy-on-write) AVL tree.
+*
+* Nodes are immutable once built and have no parent pointer, so any number
+* of versions can share them. insert and remove copy only the nodes on the
+* path from the root down to the change (plus the few touched by a
+* rotation) and share every other subtree with the previous version.
+* Nodes are reference counted, so a version is freed as soon as the last
+* tree or iterator holding it goes away.
+*
+* snapshot() is O(1) and returns an independent tree that keeps seeing the
+* contents it was taken with. Snapshots may be taken and read by other
+* threads while one writer keeps mutating this tree, but this is not
+* lock-free: every root access goes through std::atomic_load/atomic_store
+* on a shared_ptr, which libstdc++ implements with a small pool of spin
+* locks picked by address. snapshot() can spin briefly while the writer
+* swaps the root in, and a reader of a snapshot, which the writer never
+* touches, can still spin behind any swap that hashes to the same lock.
+* Several writers on the same tree need outside locking.
+*/
+template <class Key, class Value>
+class PersistentAVLTree
+{
+private:
+    struct PNode;
+    typedef std::shared_ptr<const PNode> NodePtr;
+
+    /**
+    * An immutable node. The balance information is the subtree height
+    * rather than a balance factor, since there is no parent to retrace to.
+    */
+    struct PNode
+    {
+        PNode(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right) :
+            item_(item),
+            left_(left),
+            right_(right),
+            height_(std::max(heightOf(left), heightOf(right)) + 1)
+        {
+
+        }
+
+        const std::pair<const Key, Value> item_;
+        const NodePtr left_;
+        const NodePtr right_;
+        const int height_;
+    };
+
+public:
+    PersistentAVLTree();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    bool empty() const;
+    PersistentAVLTree snapshot() const;
+
+    /**
+    * An in-order iterator over one version of the tree. It keeps that
+    * version alive, so it stays valid while the tree keeps changing.
+    */
+    class iterator
+    {
+    public:
+        iterator();
+
+        const std::pair<const Key, Value>& operator*() const;
+        const std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class PersistentAVLTree<Key, Value>;
+        void pushLeft(const PNode* node);
+
+        NodePtr version_;
+        std::vector<const PNode*> path_;    // ancestors still to visit, current on top
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    Value const & operator[](const Key& key) const;
+
+private:
+    static int heightOf(const NodePtr& node);
+    static NodePtr makeNode(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right);
+    static NodePtr rebalance(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right);
+    static NodePtr insertHelper(const NodePtr& cur, const std::pair<const Key, Value>& keyValuePair);
+    static NodePtr removeHelper(const NodePtr& cur, const Key& key, bool& removed);
+    static NodePtr removeMax(const NodePtr& cur, const PNode*& max);
+
+    NodePtr load() const;
+    void store(const NodePtr& root);
+
+    NodePtr root_;
+};
+
+/*
+-----------------------------------------------------------------
+Begin implementations for the PersistentAVLTree::iterator class.
+-----------------------------------------------------------------
+*/
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::iterator::iterator()
+{
+
+}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>&
+PersistentAVLTree<Key, Value>::iterator::operator*() const
+{
+    return path_.back()->item_;
+}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>*
+PersistentAVLTree<Key, Value>::iterator::operator->() const
+{
+    return &(path_.back()->item_);
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::iterator::operator==(const iterator& rhs) const
+{
+    const PNode* lhsNode = path_.empty() ? nullptr : path_.back();
+    const PNode* rhsNode = rhs.path_.empty() ? nullptr : rhs.path_.back();
+    return lhsNode == rhsNode;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::iterator::operator!=(const iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+* Pushes node and its chain of left children, so that the smallest
+* key of the subtree ends up on top of the path.
+*/
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::iterator::pushLeft(const PNode* node)
+{
+    while (node != nullptr)
+    {
+        path_.push_back(node);
+        node = node->left_.get();
+    }
+}
+
+/**
+* Advances the iterator's location using an in-order sequencing
+*/
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator&
+PersistentAVLTree<Key, Value>::iterator::operator++()
+{
+    const PNode* current = path_.back();
+    path_.pop_back();
+    pushLeft(current->right_.get());
+    if (path_.empty())
+    {
+        version_.reset();
+    }
+    return *this;
+}
+
+/*
+---------------------------------------------------------------
+End implementations for the PersistentAVLTree::iterator class.
+---------------------------------------------------------------
+*/
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree()
+{
+
+}
+
+/**
+* The root is read and replaced atomically so that snapshot() can run
+* on another thread while the writer publishes a new version. These are
+* short critical sections under a library spin lock, not lock-free.
+*/
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr PersistentAVLTree<Key, Value>::load() const
+{
+    return std::atomic_load(&root_);
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::store(const NodePtr& root)
+{
+    std::atomic_store(&root_, root);
+}
+
+/**
+* Returns a tree sharing all of this tree's nodes, in O(1).
+*/
+template<class Key, class Value>
+PersistentAVLTree<Key, Value> PersistentAVLTree<Key, Value>::snapshot() const
+{
+    PersistentAVLTree<Key, Value> copy;
+    copy.root_ = load();
+    return copy;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::empty() const
+{
+    return load() == nullptr;
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::clear()
+{
+    store(NodePtr());
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::begin() const
+{
+    iterator it;
+    it.version_ = load();
+    it.pushLeft(it.version_.get());
+    return it;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::end() const
+{
+    return iterator();
+}
+
+/**
+* Returns an iterator to the item with the given key, k
+* or the end iterator if k does not exist in the tree.
+* The path from the root is kept so the iterator can advance.
+*/
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator
+PersistentAVLTree<Key, Value>::find(const Key& key) const
+{
+    iterator it;
+    it.version_ = load();
+    const PNode* cur = it.version_.get();
+    while (cur != nullptr)
+    {
+        if (cur->item_.first == key)
+        {
+            it.path_.push_back(cur);
+            return it;
+        }
+        else if (cur->item_.first > key)
+        {
+            it.path_.push_back(cur);    // cur comes after everything on the left
+            cur = cur->left_.get();
+        }
+        else
+        {
+            cur = cur->right_.get();
+        }
+    }
+    return end();
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns the value associated with the key. The reference stays valid
+ * until this tree is next modified; hold an iterator or a snapshot to
+ * keep a version alive longer.
+ */
+template<class Key, class Value>
+Value const & PersistentAVLTree<Key, Value>::operator[](const Key& key) const
+{
+    const PNode* cur = root_.get();
+    while (cur != nullptr && cur->item_.first != key)
+    {
+        cur = cur->item_.first > key ? cur->left_.get() : cur->right_.get();
+    }
+    if(cur == nullptr) throw std::out_of_range("Invalid key");
+    return cur->item_.second;
+}
+
+template<class Key, class Value>
+int PersistentAVLTree<Key, Value>::heightOf(const NodePtr& node)
+{
+    return node == nullptr ? 0 : node->height_;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::makeNode(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right)
+{
+    return std::make_shared<const PNode>(item, left, right);
+}
+
+/**
+* Builds a new node for item over left and right, rotating if their
+* heights differ by two. This is the copying counterpart of
+* insertFix/removeFix: only new nodes are created, nothing is modified.
+*/
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::rebalance(const std::pair<const Key, Value>& item, const NodePtr& left, const NodePtr& right)
+{
+    int diff = heightOf(right) - heightOf(left);
+    if (diff < -1) // left heavy
+    {
+        if (heightOf(left->left_) >= heightOf(left->right_)) // zig-zig case
+        {
+            return makeNode(left->item_, left->left_, makeNode(item, left->right_, right));
+        }
+        const PNode* grandchild = left->right_.get(); // zig-zag case
+        return makeNode(grandchild->item_,
+            makeNode(left->item_, left->left_, grandchild->left_),
+            makeNode(item, grandchild->right_, right));
+    }
+    else if (diff > 1) // right heavy
+    {
+        if (heightOf(right->right_) >= heightOf(right->left_)) // zig-zig case
+        {
+            return makeNode(right->item_, makeNode(item, left, right->left_), right->right_);
+        }
+        const PNode* grandchild = right->left_.get(); // zig-zag case
+        return makeNode(grandchild->item_,
+            makeNode(item, left, grandchild->left_),
+            makeNode(right->item_, grandchild->right_, right->right_));
+    }
+    return makeNode(item, left, right);
+}
+
+/*
+ * Recall: If key is already in the tree, you should
+ * overwrite the current value with the updated value.
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::insertHelper(const NodePtr& cur, const std::pair<const Key, Value>& keyValuePair)
+{
+    if (cur == nullptr)
+    {
+        return makeNode(keyValuePair, NodePtr(), NodePtr());
+    }
+    else if (cur->item_.first > keyValuePair.first)
+    {
+        return rebalance(cur->item_, insertHelper(cur->left_, keyValuePair), cur->right_);
+    }
+    else if (cur->item_.first < keyValuePair.first)
+    {
+        return rebalance(cur->item_, cur->left_, insertHelper(cur->right_, keyValuePair));
+    }
+    return makeNode(keyValuePair, cur->left_, cur->right_);
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    store(insertHelper(root_, keyValuePair));
+}
+
+/**
+* Returns a copy of cur without its largest node, which is handed back in max.
+*/
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::removeMax(const NodePtr& cur, const PNode*& max)
+{
+    if (cur->right_ == nullptr)
+    {
+        max = cur.get();
+        return cur->left_;
+    }
+    return rebalance(cur->item_, cur->left_, removeMax(cur->right_, max));
+}
+
+/*
+ * Recall: The writeup specifies that if a node has 2 children you
+ * should swap with the predecessor and then remove.
+ */
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::NodePtr
+PersistentAVLTree<Key, Value>::removeHelper(const NodePtr& cur, const Key& key, bool& removed)
+{
+    if (cur == nullptr)
+    {
+        return cur;
+    }
+    else if (cur->item_.first > key)
+    {
+        NodePtr left = removeHelper(cur->left_, key, removed);
+        return removed ? rebalance(cur->item_, left, cur->right_) : cur;
+    }
+    else if (cur->item_.first < key)
+    {
+        NodePtr right = removeHelper(cur->right_, key, removed);
+        return removed ? rebalance(cur->item_, cur->left_, right) : cur;
+    }
+    removed = true;
+    if (cur->left_ == nullptr)
+    {
+        return cur->right_;
+    }
+    else if (cur->right_ == nullptr)
+    {
+        return cur->left_;
+    }
+    const PNode* pred = nullptr;
+    NodePtr left = removeMax(cur->left_, pred);
+    return rebalance(pred->item_, left, cur->right_);
+}
+
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::remove(const Key& key)
+{
+    bool removed = false;
+    NodePtr root = removeHelper(root_, key, removed);
+    if (removed)
+    {
+        store(root);
+    }
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "avlbst.h"
+#include "rbbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// RedBlackTree against AVLTree on operation mixes over a prefilled tree:
+// time per operation and rotations per update.
+//
+// usage: rb-bench [keys ...]    (default: 1000000; the prefilled size)
+
+struct Mix
+{
+    const char* name;
+    int insertPercent;
+    int removePercent;      // the rest are lookups
+};
+
+const Mix mixes[] = {
+    { "insert-heavy", 70, 20 },
+    { "remove-heavy", 20, 70 },
+    { "lookup-heavy", 5, 5 },
+};
+
+template<typename Tree>
+void run(const string& name, const Mix& mix, size_t size)
+{
+    Tree tree;
+    vector<uint64_t> keys = makeShuffledKeys<uint64_t>(size, 1);
+    for(size_t i = 0; i < keys.size(); i++) {
+        tree.insert(make_pair(keys[i], keys[i]));
+    }
+    size_t rotationsBefore = tree.rotations();
+
+    // keys come from twice the prefilled range, so about half of each
+    // kind of operation hits a key that is present
+    size_t ops = size;
+    vector<uint64_t> opKeys = makeUniformKeys<uint64_t>(ops, 0, 2 * size - 1, 2);
+    mt19937 randEngine(3);
+    uniform_int_distribution<int> percent(0, 99);
+    vector<int> kinds(ops);
+    size_t updates = 0;
+    for(size_t i = 0; i < ops; i++) {
+        int p = percent(randEngine);
+        kinds[i] = p < mix.insertPercent ? 0 : p < mix.insertPercent + mix.removePercent ? 1 : 2;
+        updates += kinds[i] != 2;
+    }
+
+    BenchTimer timer;
+    size_t hits = 0;
+    for(size_t i = 0; i < ops; i++) {
+        if(kinds[i] == 0) {
+            tree.insert(make_pair(opKeys[i], opKeys[i]));
+        }
+        else if(kinds[i] == 1) {
+            tree.remove(opKeys[i]);
+        }
+        else {
+            hits += tree.find(opKeys[i]) != tree.end();
+        }
+    }
+    double seconds = timer.seconds();
+    benchSink(hits);
+
+    cout << size << " keys\t" << mix.name << "\t" << name
+         << "\t" << seconds * 1e9 / ops << " ns/op"
+         << "\trotations/update " << double(tree.rotations() - rotationsBefore) / updates << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        for(size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+            run<AVLTree<uint64_t, uint64_t> >("avl", mixes[m], sizes[s]);
+            run<RedBlackTree<uint64_t, uint64_t> >("red-black", mixes[m], sizes[s]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include "rbbst.h"
+
+using namespace std;
+
+// A RedBlackTree that can check the red-black properties and its links.
+class CheckedRedBlackTree : public RedBlackTree<int, int>
+{
+public:
+    bool colorsValid() const
+    {
+        int blackHeight;
+        return check(static_cast<RBNode<int, int>*>(root_), nullptr, blackHeight);
+    }
+
+private:
+    static bool check(RBNode<int, int>* node, RBNode<int, int>* parent, int& blackHeight)
+    {
+        if(node == nullptr) {
+            blackHeight = 1;
+            return true;
+        }
+        int lbh, rbh;
+        bool ok = node->getParent() == parent
+                  && check(node->getLeft(), node, lbh) && check(node->getRight(), node, rbh);
+        blackHeight = lbh + (node->isRed() ? 0 : 1);
+        bool redRule = !node->isRed() || (!isRed(node->getLeft()) && !isRed(node->getRight()));
+        return ok && lbh == rbh && redRule;
+    }
+};
+
+// Checks that a tree holds exactly the contents of expected.
+bool sameContents(const BinarySearchTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(BinarySearchTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedRedBlackTree rt;
+    map<int,int> model;
+    srand(41);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 2000;
+        if(rand() % 2) {
+            rt.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else {
+            rt.remove(key);
+            model.erase(key);
+        }
+        if(i % 50 == 0) {
+            ok = ok && sameContents(rt, model) && rt.colorsValid();
+        }
+    }
+    cout << "Random updates match: " << (ok && sameContents(rt, model) && rt.colorsValid()) << endl;
+
+    for(map<int,int>::iterator it = model.begin(); it != model.end(); ++it) {
+        rt.remove(it->first);
+    }
+    cout << "Remove everything: " << rt.empty() << endl;
+
+    // ascending inserts, then removes from the front
+    for(int i = 0; i < 5000; i++) {
+        rt.insert(make_pair(i, i));
+    }
+    ok = rt.colorsValid();
+    for(int i = 0; i < 4000; i++) {
+        rt.remove(i);
+    }
+    cout << "Ascending inserts and removes: " << (ok && rt.colorsValid()) << endl;
+
+    // trees made by buildSorted are colored and keep working
+    for(int count = 0; count < 40; count++) {
+        vector<pair<int, int> > items;
+        model.clear();
+        for(int i = 0; i < count; i++) {
+            items.push_back(make_pair(i * 2, i));
+            model[i * 2] = i;
+        }
+        rt.buildSorted(items.begin(), items.size());
+        ok = ok && rt.colorsValid();
+        for(int i = 0; i < 20; i++) {
+            int key = rand() % 100;
+            if(i % 2) {
+                rt.remove(key);
+                model.erase(key);
+            }
+            else {
+                rt.insert(make_pair(key, i));
+                model[key] = i;
+            }
+            ok = ok && rt.colorsValid();
+        }
+        ok = ok && sameContents(rt, model);
+    }
+    cout << "Built trees: " << ok << endl;
+
+    // erase during a scan keeps the colors right
+    for(int i = 0; i < 500; i++) {
+        int key = rand() % 1000;
+        rt.insert(make_pair(key, i));
+        model[key] = i;
+    }
+    ok = true;
+    for(CheckedRedBlackTree::iterator it = rt.begin(); it != rt.end(); ) {
+        if(it->first % 2) {
+            model.erase(it->first);
+            it = rt.erase(it);
+            ok = ok && rt.colorsValid();
+        }
+        else {
+            ++it;
+        }
+    }
+    cout << "Erase during scan: " << (ok && sameContents(rt, model)) << endl;
+    return 0;
+}
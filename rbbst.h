@@ -0,0 +1,446 @@
+#ifndef RBBST_H
+#define RBBST_H
+
+#include <cstddef>
+#include <utility>
+#include "bst.h"
+
+/**
+* A node for a red-black tree, which adds its color to Node.
+*/
+template <typename Key, typename Value>
+class RBNode : public Node<Key, Value>
+{
+public:
+    RBNode(const Key& key, const Value& value, RBNode<Key, Value>* parent);
+    virtual ~RBNode();
+
+    bool isRed() const;
+    void setRed(bool red);
+
+    // Redefined to return RBNodes, as in AVLNode.
+    virtual RBNode<Key, Value>* getParent() const override;
+    virtual RBNode<Key, Value>* getLeft() const override;
+    virtual RBNode<Key, Value>* getRight() const override;
+
+protected:
+    bool red_;
+};
+
+/*
+  -------------------------------------------------
+  Begin implementations for the RBNode class.
+  -------------------------------------------------
+*/
+
+/**
+* New nodes are red, as insert wants them.
+*/
+template<class Key, class Value>
+RBNode<Key, Value>::RBNode(const Key& key, const Value& value, RBNode<Key, Value>* parent) :
+    Node<Key, Value>(key, value, parent), red_(true)
+{
+
+}
+
+template<class Key, class Value>
+RBNode<Key, Value>::~RBNode()
+{
+
+}
+
+template<class Key, class Value>
+bool RBNode<Key, Value>::isRed() const
+{
+    return red_;
+}
+
+template<class Key, class Value>
+void RBNode<Key, Value>::setRed(bool red)
+{
+    red_ = red;
+}
+
+template<class Key, class Value>
+RBNode<Key, Value>* RBNode<Key, Value>::getParent() const
+{
+    return static_cast<RBNode<Key, Value>*>(this->parent_);
+}
+
+template<class Key, class Value>
+RBNode<Key, Value>* RBNode<Key, Value>::getLeft() const
+{
+    return static_cast<RBNode<Key, Value>*>(this->left_);
+}
+
+template<class Key, class Value>
+RBNode<Key, Value>* RBNode<Key, Value>::getRight() const
+{
+    return static_cast<RBNode<Key, Value>*>(this->right_);
+}
+
+/*
+  -----------------------------------------------
+  End implementations for the RBNode class.
+  -----------------------------------------------
+*/
+
+/**
+* A red-black tree. Its height is at most twice the minimum, a looser
+* bound than AVLTree's, but an insert rotates at most twice and a remove
+* at most three times; the rest of the fix-up is recoloring. That makes
+* it the cheaper of the two for update-heavy maps.
+*/
+template <class Key, class Value>
+class RedBlackTree : public BinarySearchTree<Key, Value>
+{
+public:
+    RedBlackTree();
+    virtual void insert(const std::pair<const Key, Value>& keyValuePair);
+    virtual void remove(const Key& key);
+    size_t rotations() const;
+
+protected:
+    virtual void nodeSwap(RBNode<Key, Value>* n1, RBNode<Key, Value>* n2);
+    virtual RBNode<Key, Value>* createNode(const Key& key, const Value& value, RBNode<Key, Value>* parent);
+    virtual Node<Key, Value>* createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels) override;
+    virtual void removeNode(Node<Key, Value>* node) override;
+
+    static bool isRed(RBNode<Key, Value>* node);
+    void rightRotate(RBNode<Key, Value>* node);
+    void leftRotate(RBNode<Key, Value>* node);
+    void replaceChild(RBNode<Key, Value>* parent, RBNode<Key, Value>* oldChild, RBNode<Key, Value>* newChild);
+    void insertFix(RBNode<Key, Value>* node);
+    void removeFix(RBNode<Key, Value>* node, RBNode<Key, Value>* parent);
+
+    size_t rotations_;  // single rotations done by insert and remove, for measuring
+};
+
+template<class Key, class Value>
+RedBlackTree<Key, Value>::RedBlackTree() :
+    rotations_(0)
+{
+
+}
+
+/**
+* Returns how many single rotations insert and remove have done so far.
+*/
+template<class Key, class Value>
+size_t RedBlackTree<Key, Value>::rotations() const
+{
+    return rotations_;
+}
+
+/**
+* Swaps two nodes with the base nodeSwap. The colors are swapped back,
+* so each position in the tree keeps its color.
+*/
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::nodeSwap(RBNode<Key, Value>* n1, RBNode<Key, Value>* n2)
+{
+    BinarySearchTree<Key, Value>::nodeSwap(n1, n2);
+    bool tempRed = n1->isRed();
+    n1->setRed(n2->isRed());
+    n2->setRed(tempRed);
+}
+
+template<class Key, class Value>
+RBNode<Key, Value>* RedBlackTree<Key, Value>::createNode(const Key& key, const Value& value, RBNode<Key, Value>* parent)
+{
+    return new RBNode<Key, Value>(key, value, parent);
+}
+
+/**
+* Gives buildSorted nodes from createNode, red on the bottom level and
+* black above it, so every path to a leaf has the same number of black
+* nodes.
+*/
+template<class Key, class Value>
+Node<Key, Value>* RedBlackTree<Key, Value>::createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels)
+{
+    RBNode<Key, Value>* node = createNode(keyValuePair.first, keyValuePair.second, nullptr);
+    node->setRed(levels == 1);
+    return node;
+}
+
+/**
+* Empty subtrees count as black.
+*/
+template<class Key, class Value>
+bool RedBlackTree<Key, Value>::isRed(RBNode<Key, Value>* node)
+{
+    return node != nullptr && node->isRed();
+}
+
+/**
+* Puts newChild where oldChild hangs under parent, or at the root.
+*/
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::replaceChild(RBNode<Key, Value>* parent, RBNode<Key, Value>* oldChild, RBNode<Key, Value>* newChild)
+{
+    if (parent == nullptr)
+    {
+        this->root_ = newChild;
+    }
+    else if (parent->getLeft() == oldChild)
+    {
+        parent->setLeft(newChild);
+    }
+    else
+    {
+        parent->setRight(newChild);
+    }
+    if (newChild != nullptr)
+    {
+        newChild->setParent(parent);
+    }
+}
+
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::rightRotate(RBNode<Key, Value>* node)
+{
+    RBNode<Key, Value>* leftChild = node->getLeft();
+    RBNode<Key, Value>* grandRightChild = leftChild->getRight();
+    ++rotations_;
+    replaceChild(node->getParent(), node, leftChild);
+    node->setLeft(grandRightChild);
+    if (grandRightChild != nullptr)
+    {
+        grandRightChild->setParent(node);
+    }
+    leftChild->setRight(node);
+    node->setParent(leftChild);
+}
+
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::leftRotate(RBNode<Key, Value>* node)
+{
+    RBNode<Key, Value>* rightChild = node->getRight();
+    RBNode<Key, Value>* grandLeftChild = rightChild->getLeft();
+    ++rotations_;
+    replaceChild(node->getParent(), node, rightChild);
+    node->setRight(grandLeftChild);
+    if (grandLeftChild != nullptr)
+    {
+        grandLeftChild->setParent(node);
+    }
+    rightChild->setLeft(node);
+    node->setParent(rightChild);
+}
+
+/*
+ * If key is already in the tree, its value is overwritten.
+ */
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    RBNode<Key, Value>* parent = nullptr;
+    RBNode<Key, Value>* cur = static_cast<RBNode<Key, Value>*>(this->root_);
+    while (cur != nullptr)
+    {
+        if (cur->getKey() == keyValuePair.first)
+        {
+            cur->setValue(keyValuePair.second);
+            return;
+        }
+        parent = cur;
+        cur = cur->getKey() > keyValuePair.first ? cur->getLeft() : cur->getRight();
+    }
+    RBNode<Key, Value>* node = createNode(keyValuePair.first, keyValuePair.second, parent);
+    if (parent == nullptr)
+    {
+        this->root_ = node;
+    }
+    else if (parent->getKey() > keyValuePair.first)
+    {
+        parent->setLeft(node);
+    }
+    else
+    {
+        parent->setRight(node);
+    }
+    insertFix(node);
+}
+
+/**
+* Restores the red-black properties after the red node was linked in.
+* A red uncle is pushed up by recoloring; otherwise one or two rotations
+* finish the job.
+*/
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::insertFix(RBNode<Key, Value>* node)
+{
+    while (isRed(node->getParent()))
+    {
+        RBNode<Key, Value>* parent = node->getParent();
+        RBNode<Key, Value>* grandp = parent->getParent();
+        if (grandp == nullptr) //a red root, which buildSorted can leave
+        {
+            parent->setRed(false);
+            break;
+        }
+        if (grandp->getLeft() == parent)
+        {
+            RBNode<Key, Value>* uncle = grandp->getRight();
+            if (isRed(uncle))
+            {
+                parent->setRed(false);
+                uncle->setRed(false);
+                grandp->setRed(true);
+                node = grandp;
+                continue;
+            }
+            if (parent->getRight() == node) //zig-zag case
+            {
+                leftRotate(parent);
+                parent = node;
+            }
+            parent->setRed(false);
+            grandp->setRed(true);
+            rightRotate(grandp);
+        }
+        else
+        {
+            RBNode<Key, Value>* uncle = grandp->getLeft();
+            if (isRed(uncle))
+            {
+                parent->setRed(false);
+                uncle->setRed(false);
+                grandp->setRed(true);
+                node = grandp;
+                continue;
+            }
+            if (parent->getLeft() == node) //zig-zag case
+            {
+                rightRotate(parent);
+                parent = node;
+            }
+            parent->setRed(false);
+            grandp->setRed(true);
+            leftRotate(grandp);
+        }
+        break;
+    }
+    static_cast<RBNode<Key, Value>*>(this->root_)->setRed(false);
+}
+
+/*
+ * As in the other trees, a node with 2 children is swapped with its
+ * predecessor and then removed.
+ */
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::remove(const Key& key)
+{
+    Node<Key, Value>* node = this->internalFind(key);
+    if (node != nullptr)
+    {
+        removeNode(node);
+    }
+}
+
+/**
+* Unlinks and frees node, then restores the colors.
+*/
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::removeNode(Node<Key, Value>* target)
+{
+    RBNode<Key, Value>* node = static_cast<RBNode<Key, Value>*>(target);
+    if (node->getLeft() != nullptr && node->getRight() != nullptr)
+    {
+        nodeSwap(static_cast<RBNode<Key, Value>*>(this->predecessor(node)), node);
+    }
+    RBNode<Key, Value>* parent = node->getParent();
+    RBNode<Key, Value>* child = node->getLeft() != nullptr ? node->getLeft() : node->getRight();
+    replaceChild(parent, node, child);
+    if (!node->isRed())
+    {
+        if (isRed(child))
+        {
+            child->setRed(false);
+        }
+        else
+        {
+            removeFix(child, parent);
+        }
+    }
+    this->destroyNode(node);
+}
+
+/**
+* Restores the red-black properties after a black node was removed from
+* above node, which is now one black node short. node may be null, so its
+* parent is passed along.
+*/
+template<class Key, class Value>
+void RedBlackTree<Key, Value>::removeFix(RBNode<Key, Value>* node, RBNode<Key, Value>* parent)
+{
+    while (parent != nullptr && !isRed(node))
+    {
+        if (parent->getLeft() == node)
+        {
+            RBNode<Key, Value>* sibling = parent->getRight();
+            if (sibling->isRed())
+            {
+                sibling->setRed(false);
+                parent->setRed(true);
+                leftRotate(parent);
+                sibling = parent->getRight();
+            }
+            if (!isRed(sibling->getLeft()) && !isRed(sibling->getRight()))
+            {
+                sibling->setRed(true);
+                node = parent;
+                parent = node->getParent();
+                continue;
+            }
+            if (!isRed(sibling->getRight()))
+            {
+                sibling->getLeft()->setRed(false);
+                sibling->setRed(true);
+                rightRotate(sibling);
+                sibling = parent->getRight();
+            }
+            sibling->setRed(parent->isRed());
+            parent->setRed(false);
+            sibling->getRight()->setRed(false);
+            leftRotate(parent);
+        }
+        else
+        {
+            RBNode<Key, Value>* sibling = parent->getLeft();
+            if (sibling->isRed())
+            {
+                sibling->setRed(false);
+                parent->setRed(true);
+                rightRotate(parent);
+                sibling = parent->getLeft();
+            }
+            if (!isRed(sibling->getLeft()) && !isRed(sibling->getRight()))
+            {
+                sibling->setRed(true);
+                node = parent;
+                parent = node->getParent();
+                continue;
+            }
+            if (!isRed(sibling->getLeft()))
+            {
+                sibling->getRight()->setRed(false);
+                sibling->setRed(true);
+                leftRotate(sibling);
+                sibling = parent->getLeft();
+            }
+            sibling->setRed(parent->isRed());
+            parent->setRed(false);
+            sibling->getLeft()->setRed(false);
+            rightRotate(parent);
+        }
+        return;
+    }
+    if (node != nullptr)
+    {
+        node->setRed(false);
+    }
+}
+
+#endif
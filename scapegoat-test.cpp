@@ -0,0 +1,138 @@
+#include <iostream>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "balanced_bst.h"
+#include "serialize_bst.h"
+
+using namespace std;
+
+// A ScapegoatTree that can check its shape against the scapegoat bounds.
+class CheckedScapegoatTree : public ScapegoatTree<int, int>
+{
+public:
+    bool shapeValid() const
+    {
+        size_t count;
+        if(!parentsValid(root_, nullptr, count) || count != size()) {
+            return false;
+        }
+        // the height bound that insert enforces, with one level of slack
+        // for removes, which never make the tree deeper
+        return size() == 0 || getHeight(root_) <= log(double(size())) / log(1 / alpha_) + 2;
+    }
+
+private:
+    static bool parentsValid(Node<int, int>* node, Node<int, int>* parent, size_t& count)
+    {
+        if(node == nullptr) {
+            count = 0;
+            return true;
+        }
+        size_t lc, rc;
+        bool ok = node->getParent() == parent
+                  && parentsValid(node->getLeft(), node, lc) && parentsValid(node->getRight(), node, rc);
+        count = lc + rc + 1;
+        return ok;
+    }
+};
+
+// Checks that a tree holds exactly the contents of expected.
+bool sameContents(const BinarySearchTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(BinarySearchTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedScapegoatTree st;
+    map<int,int> model;
+    srand(40);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 3000;
+        if(rand() % 3) {
+            st.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else {
+            st.remove(key);
+            model.erase(key);
+        }
+        if(i % 100 == 0) {
+            ok = ok && sameContents(st, model) && st.shapeValid();
+        }
+    }
+    cout << "Random updates match: " << (ok && sameContents(st, model) && st.shapeValid()) << endl;
+
+    // ascending inserts would make a plain BST a list
+    st.clear();
+    model.clear();
+    for(int i = 0; i < 10000; i++) {
+        st.insert(make_pair(i, i));
+        model[i] = i;
+    }
+    cout << "Ascending inserts stay shallow: " << (sameContents(st, model) && st.shapeValid()) << endl;
+
+    // shrinking far below the peak size triggers whole-tree rebuilds
+    for(int i = 0; i < 9900; i++) {
+        st.remove(i);
+        model.erase(i);
+    }
+    cout << "Mass removal: " << (sameContents(st, model) && st.shapeValid()) << endl;
+
+    // both policies behave as the same map
+    BalancedTree<int, int> eager;
+    BalancedTree<int, int, RelaxedBalance> relaxed;
+    for(int i = 0; i < 5000; i++) {
+        int key = rand() % 1000;
+        if(i % 4 == 3) {
+            eager.remove(key);
+            relaxed.remove(key);
+        }
+        else {
+            eager.insert(make_pair(key, i));
+            relaxed.insert(make_pair(key, i));
+        }
+    }
+    map<int,int> eagerContents;
+    for(BalancedTree<int, int>::iterator it = eager.begin(); it != eager.end(); ++it) {
+        eagerContents[it->first] = it->second;
+    }
+    cout << "Policies agree: " << sameContents(relaxed, eagerContents) << endl;
+    cout << "Eager rotations: " << eager.rotations() << ", relaxed rebuilt nodes: " << relaxed.rebuiltNodes() << endl;
+
+    // erase keeps the size, and so the rebuild trigger, right
+    for(int i = 0; i < 1000; i++) {
+        st.insert(make_pair(i, i));
+        model[i] = i;
+    }
+    CheckedScapegoatTree::iterator from = st.find(100);
+    CheckedScapegoatTree::iterator to = st.find(900);
+    st.erase(from, to);
+    model.erase(model.find(100), model.find(900));
+    cout << "Range erase: " << (sameContents(st, model) && st.shapeValid() && st.size() == model.size()) << endl;
+
+    // clear and buildSorted reached through the base class, as readTree
+    // does, keep the size right
+    stringstream stream;
+    writeTree(st, stream);
+    BinarySearchTree<int, int>& base = st;
+    base.clear();
+    bool cleared = st.size() == 0 && st.shapeValid();
+    for(int i = 0; i < 10; i++) {
+        st.remove(i);
+    }
+    cleared = cleared && st.size() == 0;
+    readTree(stream, base);
+    cout << "Base-class clear and readTree: "
+         << (cleared && sameContents(st, model) && st.shapeValid() && st.size() == model.size()) << endl;
+    return 0;
+}
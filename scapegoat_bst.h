@@ -0,0 +1,279 @@
+#ifndef SCAPEGOAT_BST_H
+#define SCAPEGOAT_BST_H
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "bst.h"
+
+/**
+* A scapegoat tree: a weight-balanced tree that rebalances lazily.
+*
+* Inserts and removes are plain unbalanced BST updates with no rotations
+* and no per-node balance data. Only when an insert lands deeper than
+* log_{1/alpha}(n) is anything restructured: the lowest ancestor with a
+* child holding more than alpha of its nodes (the scapegoat) has its
+* subtree relinked into perfect balance. When removes have shrunk the
+* tree below alpha of its size at the last full rebuild, the whole tree
+* is relinked. Both costs are amortized O(log n) per update, bursts of
+* updates pay for nothing until a bound is crossed, and the height never
+* exceeds log_{1/alpha}(n) + 1.
+*
+* Nodes are relinked, not copied, so pointers to items stay valid.
+*/
+template <typename Key, typename Value>
+class ScapegoatTree : public BinarySearchTree<Key, Value>
+{
+public:
+    ScapegoatTree();
+
+    virtual void insert(const std::pair<const Key, Value>& keyValuePair);
+    virtual void remove(const Key& key);
+
+    size_t size() const;
+    size_t rebuiltNodes() const;
+
+protected:
+    static const double alpha_;
+
+    virtual void removeNode(Node<Key, Value>* node) override;
+    virtual void destroyNode(Node<Key, Value>* node) override;
+    virtual Node<Key, Value>* createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels) override;
+    bool tooDeep(int depth) const;
+    static size_t subtreeSize(Node<Key, Value>* node);
+    void rebuild(Node<Key, Value>* node);
+    static void collect(Node<Key, Value>* node, std::vector<Node<Key, Value>*>& nodes);
+    static Node<Key, Value>* relink(std::vector<Node<Key, Value>*>& nodes, size_t lo, size_t hi, Node<Key, Value>* parent);
+
+    size_t size_;
+    size_t maxSize_;        // the largest size since the last full rebuild
+    size_t rebuiltNodes_;   // nodes relinked by rebuilds, for measuring
+};
+
+template<typename Key, typename Value>
+const double ScapegoatTree<Key, Value>::alpha_ = 0.7;
+
+template<typename Key, typename Value>
+ScapegoatTree<Key, Value>::ScapegoatTree() :
+    size_(0),
+    maxSize_(0),
+    rebuiltNodes_(0)
+{
+
+}
+
+/**
+* Inserts like an unbalanced BST, overwriting the value of an existing
+* key. If the new leaf is too deep, rebuilds the scapegoat's subtree.
+*/
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    Node<Key, Value>* parent = nullptr;
+    Node<Key, Value>* cur = this->root_;
+    int depth = 1;
+    while (cur != nullptr)
+    {
+        if (cur->getKey() == keyValuePair.first)
+        {
+            cur->setValue(keyValuePair.second);
+            return;
+        }
+        parent = cur;
+        cur = cur->getKey() > keyValuePair.first ? cur->getLeft() : cur->getRight();
+        ++depth;
+    }
+    Node<Key, Value>* node = new Node<Key, Value>(keyValuePair.first, keyValuePair.second, parent);
+    if (parent == nullptr)
+    {
+        this->root_ = node;
+    }
+    else if (parent->getKey() > keyValuePair.first)
+    {
+        parent->setLeft(node);
+    }
+    else
+    {
+        parent->setRight(node);
+    }
+    ++size_;
+    maxSize_ = std::max(maxSize_, size_);
+    if (!tooDeep(depth))
+    {
+        return;
+    }
+
+    // climb to the lowest ancestor that is not alpha-weight-balanced
+    cur = node;
+    size_t size = 1;
+    parent = cur->getParent();
+    while (parent != nullptr)
+    {
+        Node<Key, Value>* sibling = parent->getLeft() == cur ? parent->getRight() : parent->getLeft();
+        size_t parentSize = size + 1 + subtreeSize(sibling);
+        if (size > alpha_ * parentSize)
+        {
+            break;
+        }
+        cur = parent;
+        size = parentSize;
+        parent = cur->getParent();
+    }
+    rebuild(parent != nullptr ? parent : cur);
+}
+
+/**
+* Removes like an unbalanced BST. Once the tree has shrunk below alpha
+* of its size at the last full rebuild, the whole tree is rebuilt.
+*/
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::remove(const Key& key)
+{
+    Node<Key, Value>* node = this->internalFind(key);
+    if (node != nullptr)
+    {
+        removeNode(node);
+    }
+}
+
+/**
+* Unlinks node as BinarySearchTree does, then rebuilds the whole tree if
+* it has shrunk past the alpha bound.
+*/
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::removeNode(Node<Key, Value>* node)
+{
+    BinarySearchTree<Key, Value>::removeNode(node);
+    if (size_ < alpha_ * maxSize_)
+    {
+        if (this->root_ != nullptr)
+        {
+            rebuild(this->root_);
+        }
+        maxSize_ = size_;
+    }
+}
+
+/**
+* Every node leaves through here, whether remove, clear or a rebuild from
+* the base class frees it, so size_ is counted down here rather than in
+* each of them. An emptied tree starts its rebuild bound over.
+*/
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::destroyNode(Node<Key, Value>* node)
+{
+    BinarySearchTree<Key, Value>::destroyNode(node);
+    if (--size_ == 0)
+    {
+        maxSize_ = 0;
+    }
+}
+
+/**
+* buildSorted, and so readTree, creates its nodes through here; counting
+* them keeps size_ right however the build was reached.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* ScapegoatTree<Key, Value>::createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels)
+{
+    Node<Key, Value>* node = BinarySearchTree<Key, Value>::createBuiltNode(keyValuePair, balance, levels);
+    ++size_;
+    maxSize_ = std::max(maxSize_, size_);
+    return node;
+}
+
+template<typename Key, typename Value>
+size_t ScapegoatTree<Key, Value>::size() const
+{
+    return size_;
+}
+
+/**
+* Returns how many nodes rebuilds have relinked so far, the scapegoat
+* tree's counterpart to rotations.
+*/
+template<typename Key, typename Value>
+size_t ScapegoatTree<Key, Value>::rebuiltNodes() const
+{
+    return rebuiltNodes_;
+}
+
+/**
+* Returns true if a node at the given depth (the root is depth 1) is
+* deeper than a tree whose subtrees are all alpha-weight-balanced can be.
+*/
+template<typename Key, typename Value>
+bool ScapegoatTree<Key, Value>::tooDeep(int depth) const
+{
+    return depth > std::log(static_cast<double>(size_)) / std::log(1 / alpha_) + 1;
+}
+
+template<typename Key, typename Value>
+size_t ScapegoatTree<Key, Value>::subtreeSize(Node<Key, Value>* node)
+{
+    if (node == nullptr)
+    {
+        return 0;
+    }
+    return subtreeSize(node->getLeft()) + 1 + subtreeSize(node->getRight());
+}
+
+/**
+* Relinks the subtree rooted at node into a perfectly balanced subtree
+* in the same place.
+*/
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::rebuild(Node<Key, Value>* node)
+{
+    Node<Key, Value>* parent = node->getParent();
+    bool isLeft = parent != nullptr && parent->getLeft() == node;
+    std::vector<Node<Key, Value>*> nodes;
+    collect(node, nodes);
+    rebuiltNodes_ += nodes.size();
+    Node<Key, Value>* top = relink(nodes, 0, nodes.size(), parent);
+    if (parent == nullptr)
+    {
+        this->root_ = top;
+    }
+    else if (isLeft)
+    {
+        parent->setLeft(top);
+    }
+    else
+    {
+        parent->setRight(top);
+    }
+}
+
+template<typename Key, typename Value>
+void ScapegoatTree<Key, Value>::collect(Node<Key, Value>* node, std::vector<Node<Key, Value>*>& nodes)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+    collect(node->getLeft(), nodes);
+    nodes.push_back(node);
+    collect(node->getRight(), nodes);
+}
+
+/**
+* Links nodes[lo, hi) into a perfectly balanced subtree and returns its root.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* ScapegoatTree<Key, Value>::relink(std::vector<Node<Key, Value>*>& nodes, size_t lo, size_t hi, Node<Key, Value>* parent)
+{
+    if (lo >= hi)
+    {
+        return nullptr;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    Node<Key, Value>* node = nodes[mid];
+    node->setParent(parent);
+    node->setLeft(relink(nodes, lo, mid, node));
+    node->setRight(relink(nodes, mid + 1, hi, node));
+    return node;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include "avlbst.h"
+#include "serialize_bst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Time to checkpoint an AVLTree to a file with writeTree and to reload it
+// with readTree, against rebuilding it with one insert per key.
+//
+// usage: serialize-bench [keys ...]    (default: 1000000)
+// The file is written to serialize-bench.tmp in the current directory.
+
+int main(int argc, char *argv[])
+{
+    const char* path = "serialize-bench.tmp";
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1);
+
+        BenchTimer timer;
+        AVLTree<uint64_t, uint64_t> tree;
+        for(size_t i = 0; i < keys.size(); i++) {
+            tree.insert(make_pair(keys[i], keys[i]));
+        }
+        double insertSeconds = timer.seconds();
+
+        timer.restart();
+        {
+            ofstream out(path, ios::binary);
+            writeTree(tree, out);
+        }
+        double writeSeconds = timer.seconds();
+
+        timer.restart();
+        AVLTree<uint64_t, uint64_t> loaded;
+        {
+            ifstream in(path, ios::binary);
+            readTree(in, loaded);
+        }
+        double readSeconds = timer.seconds();
+        benchSink(loaded.empty());
+
+        cout << keys.size() << " keys"
+             << "\tinsert " << insertSeconds << " s"
+             << "\twrite " << writeSeconds << " s"
+             << "\tread " << readSeconds << " s" << endl;
+        remove(path);
+    }
+    return 0;
+}
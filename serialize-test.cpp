@@ -0,0 +1,122 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include "avlbst.h"
+#include "serialize_bst.h"
+
+using namespace std;
+
+// Checks that a tree holds exactly the contents of expected.
+template<typename Tree, typename Key, typename Value>
+bool sameContents(const Tree& tree, const map<Key, Value>& expected)
+{
+    typename map<Key, Value>::const_iterator exp = expected.begin();
+    for(typename Tree::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+// Stores ints as decimal text, to exercise a custom codec.
+struct TextCodec
+{
+    static void encode(const int& value, string& out)
+    {
+        ostringstream text;
+        text << value;
+        Codec<string>::encode(text.str(), out);
+    }
+    static bool decode(const char*& data, const char* end, int& value)
+    {
+        string text;
+        if(!Codec<string>::decode(data, end, text)) {
+            return false;
+        }
+        value = atoi(text.c_str());
+        return true;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    bool ok = true;
+    for(int n = 0; n <= 40; n++) {
+        AVLTree<int,int> at;
+        map<int,int> model;
+        for(int i = 0; i < n; i++) {
+            at.insert(make_pair(i, -i));
+            model[i] = -i;
+        }
+        stringstream stream;
+        writeTree(at, stream);
+        AVLTree<int,int> loaded;
+        loaded.insert(make_pair(1000, 1000));
+        readTree(stream, loaded);
+        ok = ok && sameContents(loaded, model) && loaded.isBalanced();
+    }
+    cout << "Small sizes match: " << ok << endl;
+
+    // the loaded tree's balances must be right for later updates
+    AVLTree<int,int> at;
+    map<int,int> model;
+    srand(107);
+    for(int i = 0; i < 5000; i++) {
+        int key = rand() % 20000;
+        at.insert(make_pair(key, i));
+        model[key] = i;
+    }
+    stringstream stream;
+    writeTree(at, stream);
+    AVLTree<int,int> loaded;
+    readTree(stream, loaded);
+    for(int i = 0; i < 5000; i++) {
+        int key = rand() % 20000;
+        if(i % 2) {
+            loaded.remove(key);
+            model.erase(key);
+        }
+        else {
+            loaded.insert(make_pair(key, i));
+            model[key] = i;
+        }
+    }
+    cout << "Updates after load: " << (sameContents(loaded, model) && loaded.isBalanced()) << endl;
+
+    BinarySearchTree<string,string> bt;
+    map<string,string> smodel;
+    const char* words[] = { "pear", "apple", "", "kiwi", "banana", "cherry", "date" };
+    for(int i = 0; i < 7; i++) {
+        bt.insert(make_pair(string(words[i]), string(words[6 - i])));
+        smodel[words[i]] = words[6 - i];
+    }
+    stringstream sstream;
+    writeTree(bt, sstream);
+    BinarySearchTree<string,string> sloaded;
+    readTree(sstream, sloaded);
+    cout << "String codec: " << (sameContents(sloaded, smodel) && sloaded.isBalanced()) << endl;
+
+    stringstream tstream;
+    writeTree<int, int, TextCodec, TextCodec>(at, tstream);
+    AVLTree<int,int> tloaded;
+    readTree<int, int, TextCodec, TextCodec>(tstream, tloaded);
+    map<int,int> amodel;
+    for(AVLTree<int,int>::iterator it = at.begin(); it != at.end(); ++it) {
+        amodel[it->first] = it->second;
+    }
+    cout << "Custom codec: " << sameContents(tloaded, amodel) << endl;
+
+    string cut = tstream.str();
+    stringstream truncated(cut.substr(0, cut.size() / 2));
+    try {
+        readTree<int, int, TextCodec, TextCodec>(truncated, tloaded);
+        cout << "Truncated stream rejected: 0" << endl;
+    }
+    catch(const runtime_error&) {
+        cout << "Truncated stream rejected: " << tloaded.empty() << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+#ifndef SERIALIZE_BST_H
+#define SERIALIZE_BST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "bst.h"
+
+/**
+* Turns values of type T into bytes and back for the record stream.
+*
+* encode appends the bytes of value to out. decode reads one value from
+* the front of [data, end), advances data past it and returns true, or
+* returns false if the bytes are malformed. A decoder must accept exactly
+* what its encoder wrote and may not read past end.
+*
+* The default codec copies the object representation, which suits
+* trivially copyable types; a file written this way can only be read
+* on a machine with the same byte order and type sizes. Specialize
+* Codec, or pass codecs to writeTree/readTree, for other types.
+*/
+template <typename T>
+struct Codec
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "no Codec for this type: specialize Codec<T> or pass one explicitly");
+
+    static void encode(const T& value, std::string& out)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool decode(const char*& data, const char* end, T& value)
+    {
+        if (static_cast<size_t>(end - data) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+};
+
+/**
+* Strings are stored as a 32-bit length followed by their characters.
+*/
+template <>
+struct Codec<std::string>
+{
+    static void encode(const std::string& value, std::string& out)
+    {
+        Codec<uint32_t>::encode(static_cast<uint32_t>(value.size()), out);
+        out.append(value);
+    }
+
+    static bool decode(const char*& data, const char* end, std::string& value)
+    {
+        uint32_t length;
+        if (!Codec<uint32_t>::decode(data, end, length) || static_cast<size_t>(end - data) < length)
+        {
+            return false;
+        }
+        value.assign(data, length);
+        data += length;
+        return true;
+    }
+};
+
+/*
+  ------------------------------------------------------------------
+  The stream is an 8-byte magic, the 64-bit item count, and then one
+  record per item in ascending key order: a 32-bit payload length
+  followed by the encoded key and the encoded value.
+  ------------------------------------------------------------------
+*/
+
+static const char streamMagic[8] = { 'B', 'S', 'T', 'S', 'T', 'R', 'M', '1' };
+static const size_t streamBufferSize = 1 << 20;
+
+/**
+* Writes tree to out as a record stream. The tree does not keep its size,
+* so it is walked twice in order: once to count the items, since the
+* count heads the stream, and once to write them. Records go through a
+* buffer of about a megabyte, so memory use does not grow with the tree.
+* Throws std::runtime_error if out fails.
+*/
+template<typename Key, typename Value, typename KeyCodec = Codec<Key>, typename ValueCodec = Codec<Value> >
+void writeTree(const BinarySearchTree<Key, Value>& tree, std::ostream& out)
+{
+    typedef typename BinarySearchTree<Key, Value>::iterator Iterator;
+
+    // the count goes first, so that the reader can shape the tree up front
+    uint64_t count = 0;
+    for (Iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        ++count;
+    }
+
+    std::string buffer(streamMagic, sizeof(streamMagic));
+    Codec<uint64_t>::encode(count, buffer);
+    std::string payload;
+    for (Iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        payload.clear();
+        KeyCodec::encode(it->first, payload);
+        ValueCodec::encode(it->second, payload);
+        Codec<uint32_t>::encode(static_cast<uint32_t>(payload.size()), buffer);
+        buffer.append(payload);
+        if (buffer.size() >= streamBufferSize)
+        {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write tree stream");
+    }
+}
+
+/**
+* Reads the records of a stream one at a time through a large buffer,
+* so memory use does not grow with the stream. Its iterator feeds the
+* records to buildSorted. Keys must ascend, or only not descend if
+* equalKeys is set. Key and Value must be default constructible.
+*/
+template <typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+class RecordReader
+{
+public:
+    RecordReader(std::istream& in, bool equalKeys);
+    ~RecordReader();
+
+    /**
+    * An input iterator over the records, in stream order.
+    */
+    class iterator
+    {
+    public:
+        explicit iterator(RecordReader* reader) : reader_(reader)
+        {
+
+        }
+
+        const std::pair<const Key, Value>& operator*() const
+        {
+            return *reader_->item_;
+        }
+
+        iterator& operator++()
+        {
+            reader_->next();
+            return *this;
+        }
+
+    private:
+        RecordReader* reader_;
+    };
+
+    uint64_t count() const
+    {
+        return count_;
+    }
+
+    iterator begin()
+    {
+        return iterator(this);
+    }
+
+private:
+    RecordReader(const RecordReader&);
+    RecordReader& operator=(const RecordReader&);
+
+    const char* need(size_t bytes);
+    void next();
+    void readItem();
+
+    std::istream& in_;
+    std::string buffer_;
+    size_t pos_;            // start of the unread bytes in buffer_
+    uint64_t count_;
+    uint64_t read_;         // records read so far
+    bool equalKeys_;        // whether a key may repeat the one before it
+    std::pair<const Key, Value>* item_;
+    typename std::aligned_storage<sizeof(std::pair<const Key, Value>),
+                                  alignof(std::pair<const Key, Value>)>::type storage_;
+};
+
+template<typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+RecordReader<Key, Value, KeyCodec, ValueCodec>::RecordReader(std::istream& in, bool equalKeys) :
+    in_(in),
+    pos_(0),
+    count_(0),
+    read_(0),
+    equalKeys_(equalKeys),
+    item_(nullptr)
+{
+    const char* header = need(sizeof(streamMagic) + sizeof(uint64_t));
+    if (std::memcmp(header, streamMagic, sizeof(streamMagic)) != 0)
+    {
+        throw std::runtime_error("Not a tree stream");
+    }
+    header += sizeof(streamMagic);
+    Codec<uint64_t>::decode(header, header + sizeof(uint64_t), count_);
+    pos_ += sizeof(streamMagic) + sizeof(uint64_t);
+    if (count_ > 0)
+    {
+        readItem();
+    }
+}
+
+template<typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+RecordReader<Key, Value, KeyCodec, ValueCodec>::~RecordReader()
+{
+    if (item_ != nullptr)
+    {
+        item_->~pair();
+    }
+}
+
+/**
+* Returns a pointer to at least bytes unread bytes, topping the buffer
+* up from the stream as needed.
+*/
+template<typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+const char* RecordReader<Key, Value, KeyCodec, ValueCodec>::need(size_t bytes)
+{
+    if (buffer_.size() - pos_ < bytes)
+    {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        size_t have = buffer_.size();
+        size_t want = bytes > streamBufferSize ? bytes : streamBufferSize;
+        buffer_.resize(want);
+        in_.read(&buffer_[have], want - have);
+        buffer_.resize(have + in_.gcount());
+        if (buffer_.size() < bytes)
+        {
+            throw std::runtime_error("Tree stream is truncated");
+        }
+    }
+    return buffer_.data() + pos_;
+}
+
+/**
+* Decodes the next record into item_, checking that keys ascend.
+*/
+template<typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+void RecordReader<Key, Value, KeyCodec, ValueCodec>::readItem()
+{
+    const char* data = need(sizeof(uint32_t));
+    uint32_t length;
+    Codec<uint32_t>::decode(data, data + sizeof(uint32_t), length);
+    pos_ += sizeof(uint32_t);
+
+    data = need(length);
+    const char* end = data + length;
+    Key key;
+    Value value;
+    if (!KeyCodec::decode(data, end, key) || !ValueCodec::decode(data, end, value) || data != end)
+    {
+        throw std::runtime_error("Malformed record in tree stream");
+    }
+    pos_ += length;
+    if (item_ != nullptr)
+    {
+        if (equalKeys_ ? key < item_->first : !(item_->first < key))
+        {
+            throw std::runtime_error("Keys in tree stream are not ascending");
+        }
+        item_->~pair();
+        item_ = nullptr;    // the destructor must not destroy it again if the copy throws
+    }
+    item_ = new (&storage_) std::pair<const Key, Value>(key, value);
+    ++read_;
+}
+
+/**
+* Moves to the next record. Past the last one this does nothing, since
+* buildSorted steps past every item it takes.
+*/
+template<typename Key, typename Value, typename KeyCodec, typename ValueCodec>
+void RecordReader<Key, Value, KeyCodec, ValueCodec>::next()
+{
+    if (read_ < count_)
+    {
+        readItem();
+    }
+}
+
+/**
+* Replaces the contents of tree with a record stream written by
+* writeTree. The tree is built directly in balanced shape as records are
+* read, in time linear in their number and without calling insert.
+* If the tree keeps duplicate keys, as a multimap written by writeTree
+* does, equal keys are accepted and buildSorted keeps them in stream
+* order, so the oldest item of each key is still the first. Throws
+* std::runtime_error on a malformed or truncated stream, leaving tree
+* empty.
+*/
+template<typename Key, typename Value, typename KeyCodec = Codec<Key>, typename ValueCodec = Codec<Value> >
+void readTree(std::istream& in, BinarySearchTree<Key, Value>& tree)
+{
+    tree.clear();
+    RecordReader<Key, Value, KeyCodec, ValueCodec> reader(in, tree.duplicateKeys());
+    tree.buildSorted(reader.begin(), reader.count());
+}
+
+#endif
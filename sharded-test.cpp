@@ -0,0 +1,67 @@
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+#include "sharded_avlbst.h"
+
+using namespace std;
+
+// Checks that in-order iteration over the whole map matches expected.
+template<typename Map>
+bool sameContents(const Map& shardedMap, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(typename Map::iterator it = shardedMap.begin(); it != shardedMap.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    // Hash partitioned, filled from several threads at once
+    ShardedAVLMap<int, int, 8> hashed;
+    map<int, int> model;
+    vector<thread> writers;
+    for(int t = 0; t < 4; t++) {
+        writers.push_back(thread([&hashed, t]() {
+            for(int i = t; i < 4000; i += 4) {
+                hashed.insert(make_pair(i, i * 2));
+            }
+            for(int i = t; i < 4000; i += 12) {
+                hashed.remove(i);
+            }
+        }));
+    }
+    for(size_t t = 0; t < writers.size(); t++) {
+        writers[t].join();
+    }
+    for(int i = 0; i < 4000; i++) {
+        if((i % 4) % 12 != i % 12 || i % 12 >= 4) {
+            model[i] = i * 2;
+        }
+    }
+    cout << "Hash partitioned in order: " << sameContents(hashed, model) << endl;
+    int value = 0;
+    cout << "Find 5: " << hashed.find(5, value) << " " << value << endl;
+    cout << "Find 0 (removed): " << hashed.contains(0) << endl;
+
+    // Range partitioned
+    vector<int> bounds;
+    bounds.push_back(100);
+    bounds.push_back(200);
+    bounds.push_back(300);
+    ShardedAVLMap<int, int, 4, RangePartition<int> > ranged((RangePartition<int>(bounds)));
+    map<int, int> rangeModel;
+    for(int i = 399; i >= 0; i -= 3) {
+        ranged.insert(make_pair(i, -i));
+        rangeModel[i] = -i;
+    }
+    cout << "Range partitioned in order: " << sameContents(ranged, rangeModel) << endl;
+    cout << "Shard of 150: " << ranged.shardOf(150) << endl;
+    ranged.clear();
+    cout << "Cleared: " << ranged.empty() << endl;
+    return 0;
+}
@@ -0,0 +1,353 @@
+#ifndef SHARDED_AVLBST_H
+#define SHARDED_AVLBST_H
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "avlbst.h"
+#include "node_pool.h"
+
+/**
+* Sends each key to a shard by hash. Spreads any key distribution evenly,
+* but keys of one shard are scattered over the whole key range.
+*/
+template <class Key>
+struct HashPartition
+{
+    size_t operator()(const Key& key, size_t shards) const
+    {
+        return std::hash<Key>()(key) % shards;
+    }
+};
+
+/**
+* Sends each key to a shard by range: shard i holds the keys in
+* [bounds[i-1], bounds[i]), with the first and last shards open ended.
+* Needs shards - 1 ascending bounds.
+*/
+template <class Key>
+class RangePartition
+{
+public:
+    RangePartition()
+    {
+
+    }
+
+    explicit RangePartition(const std::vector<Key>& bounds) :
+        bounds_(bounds)
+    {
+
+    }
+
+    size_t operator()(const Key& key, size_t shards) const
+    {
+        size_t shard = std::upper_bound(bounds_.begin(), bounds_.end(), key) - bounds_.begin();
+        return std::min(shard, shards - 1);
+    }
+
+private:
+    std::vector<Key> bounds_;
+};
+
+/**
+* An ordered map split over N independent AVLTrees.
+*
+* Every shard has its own lock and its own node pool, so operations on
+* different shards never contend on a lock or on the allocator. Lookups
+* copy values out, since a reference could be invalidated by another
+* thread as soon as the shard lock is released.
+*
+* Iteration visits all keys in order by k-way merging the shards'
+* iterators through a heap of their current items, whatever the
+* partition; each step costs O(log N) comparisons on top of the shard
+* iterator's own step, even with a RangePartition, whose shards could in
+* principle be walked one after another. Iterating is not synchronized
+* with writers: only iterate while no thread is modifying the map.
+*/
+template <class Key, class Value, size_t N, class Partition = HashPartition<Key> >
+class ShardedAVLMap
+{
+private:
+    /**
+    * An AVLTree that takes its nodes from a pool it owns.
+    */
+    class ShardTree : public AVLTree<Key, Value>
+    {
+    public:
+        ~ShardTree()
+        {
+            // must run while our destroyNode and pool_ still exist
+            this->clear();
+        }
+
+    protected:
+        AVLNode<Key, Value>* createNode(const Key& key, const Value& value, AVLNode<Key, Value>* parent) override
+        {
+            return pool_.create(key, value, parent);
+        }
+        void destroyNode(Node<Key, Value>* node) override
+        {
+            pool_.destroy(static_cast<AVLNode<Key, Value>*>(node));
+        }
+
+    private:
+        NodePool<AVLNode<Key, Value> > pool_;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex lock_;
+        ShardTree tree_;
+    };
+
+    typedef typename AVLTree<Key, Value>::iterator ShardIterator;
+
+public:
+    explicit ShardedAVLMap(const Partition& partition = Partition());
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+    Value operator[](const Key& key) const;
+    bool empty() const;
+    size_t shardOf(const Key& key) const;
+
+    /**
+    * An in-order iterator over all shards.
+    */
+    class iterator
+    {
+    public:
+        iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class ShardedAVLMap;
+
+        // Orders heads so that the smallest key is at the front of the heap.
+        struct LaterHead
+        {
+            bool operator()(const ShardIterator& a, const ShardIterator& b) const
+            {
+                return b->first < a->first;
+            }
+        };
+
+        std::vector<ShardIterator> heads_;   // a min-heap of the shards' current items
+    };
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    Shard& shardFor(const Key& key) const;
+
+    mutable Shard shards_[N];
+    Partition partition_;
+};
+
+/*
+-------------------------------------------------------------
+Begin implementations for the ShardedAVLMap::iterator class.
+-------------------------------------------------------------
+*/
+
+template<class Key, class Value, size_t N, class Partition>
+ShardedAVLMap<Key, Value, N, Partition>::iterator::iterator()
+{
+
+}
+
+template<class Key, class Value, size_t N, class Partition>
+std::pair<const Key, Value>&
+ShardedAVLMap<Key, Value, N, Partition>::iterator::operator*() const
+{
+    return *heads_.front();
+}
+
+template<class Key, class Value, size_t N, class Partition>
+std::pair<const Key, Value>*
+ShardedAVLMap<Key, Value, N, Partition>::iterator::operator->() const
+{
+    return &(*heads_.front());
+}
+
+template<class Key, class Value, size_t N, class Partition>
+bool ShardedAVLMap<Key, Value, N, Partition>::iterator::operator==(const iterator& rhs) const
+{
+    if (heads_.empty() || rhs.heads_.empty())
+    {
+        return heads_.empty() == rhs.heads_.empty();
+    }
+    return heads_.front() == rhs.heads_.front();
+}
+
+template<class Key, class Value, size_t N, class Partition>
+bool ShardedAVLMap<Key, Value, N, Partition>::iterator::operator!=(const iterator& rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+* Advances the shard holding the current item and restores the heap.
+*/
+template<class Key, class Value, size_t N, class Partition>
+typename ShardedAVLMap<Key, Value, N, Partition>::iterator&
+ShardedAVLMap<Key, Value, N, Partition>::iterator::operator++()
+{
+    std::pop_heap(heads_.begin(), heads_.end(), LaterHead());
+    ++heads_.back();
+    if (heads_.back() == ShardIterator())
+    {
+        heads_.pop_back();
+    }
+    else
+    {
+        std::push_heap(heads_.begin(), heads_.end(), LaterHead());
+    }
+    return *this;
+}
+
+/*
+-----------------------------------------------------------
+End implementations for the ShardedAVLMap::iterator class.
+-----------------------------------------------------------
+*/
+
+template<class Key, class Value, size_t N, class Partition>
+ShardedAVLMap<Key, Value, N, Partition>::ShardedAVLMap(const Partition& partition) :
+    partition_(partition)
+{
+
+}
+
+template<class Key, class Value, size_t N, class Partition>
+size_t ShardedAVLMap<Key, Value, N, Partition>::shardOf(const Key& key) const
+{
+    return partition_(key, N);
+}
+
+template<class Key, class Value, size_t N, class Partition>
+typename ShardedAVLMap<Key, Value, N, Partition>::Shard&
+ShardedAVLMap<Key, Value, N, Partition>::shardFor(const Key& key) const
+{
+    return shards_[shardOf(key)];
+}
+
+template<class Key, class Value, size_t N, class Partition>
+void ShardedAVLMap<Key, Value, N, Partition>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    Shard& shard = shardFor(keyValuePair.first);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    shard.tree_.insert(keyValuePair);
+}
+
+template<class Key, class Value, size_t N, class Partition>
+void ShardedAVLMap<Key, Value, N, Partition>::remove(const Key& key)
+{
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    shard.tree_.remove(key);
+}
+
+template<class Key, class Value, size_t N, class Partition>
+void ShardedAVLMap<Key, Value, N, Partition>::clear()
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        shards_[i].tree_.clear();
+    }
+}
+
+/**
+* Copies the value stored under key into value and returns true,
+* or returns false if the key is not in the map.
+*/
+template<class Key, class Value, size_t N, class Partition>
+bool ShardedAVLMap<Key, Value, N, Partition>::find(const Key& key, Value& value) const
+{
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    ShardIterator it = shard.tree_.find(key);
+    if (it == shard.tree_.end())
+    {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+template<class Key, class Value, size_t N, class Partition>
+bool ShardedAVLMap<Key, Value, N, Partition>::contains(const Key& key) const
+{
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    return shard.tree_.find(key) != shard.tree_.end();
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns a copy of the value associated with the key
+ */
+template<class Key, class Value, size_t N, class Partition>
+Value ShardedAVLMap<Key, Value, N, Partition>::operator[](const Key& key) const
+{
+    Value value;
+    if(!find(key, value)) throw std::out_of_range("Invalid key");
+    return value;
+}
+
+template<class Key, class Value, size_t N, class Partition>
+bool ShardedAVLMap<Key, Value, N, Partition>::empty() const
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        if (!shards_[i].tree_.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class Key, class Value, size_t N, class Partition>
+typename ShardedAVLMap<Key, Value, N, Partition>::iterator
+ShardedAVLMap<Key, Value, N, Partition>::begin() const
+{
+    iterator it;
+    for (size_t i = 0; i < N; ++i)
+    {
+        ShardIterator head = shards_[i].tree_.begin();
+        if (head != shards_[i].tree_.end())
+        {
+            it.heads_.push_back(head);
+        }
+    }
+    std::make_heap(it.heads_.begin(), it.heads_.end(), typename iterator::LaterHead());
+    return it;
+}
+
+template<class Key, class Value, size_t N, class Partition>
+typename ShardedAVLMap<Key, Value, N, Partition>::iterator
+ShardedAVLMap<Key, Value, N, Partition>::end() const
+{
+    return iterator();
+}
+
+#endif
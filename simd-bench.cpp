@@ -0,0 +1,95 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <x86intrin.h>
+#include "avlbst.h"
+#include "btree.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Cycles per lookup for each in-node search kernel.
+//   node:  searching one node's key array on its own (always in L1)
+//   tree:  BTree::find with one-line (B=8) and four-line (B=32) nodes,
+//          at each of the given tree sizes
+// AVLTree::find is shown for reference.
+//
+// usage: simd-bench [keys ...]     (default: 10000 1000000)
+
+const size_t PROBES = 1000000;
+
+template<typename Tree>
+double treeCycles(const Tree& tree, const vector<uint64_t>& probes)
+{
+    uint64_t found = 0;
+    uint64_t start = __rdtsc();
+    for(size_t i = 0; i < probes.size(); i++) {
+        found += tree.find(probes[i]) != tree.end();
+    }
+    uint64_t cycles = __rdtsc() - start;
+    benchSink(found);
+    return double(cycles) / probes.size();
+}
+
+double nodeCycles(const vector<uint64_t>& probes)
+{
+    uint64_t keys[8];
+    for(int i = 0; i < 8; i++) {
+        keys[i] = (i + 1) * (probes.size() / 8);
+    }
+    uint64_t sum = 0;
+    uint64_t start = __rdtsc();
+    for(size_t i = 0; i < probes.size(); i++) {
+        sum += KeySearch<uint64_t>::countLess(keys, 8, probes[i]);
+    }
+    uint64_t cycles = __rdtsc() - start;
+    benchSink(sum);
+    return double(cycles) / probes.size();
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(10000);
+        sizes.push_back(1000000);
+    }
+
+    const char* kernelNames[] = { "scalar", "SSE4.2", "AVX2" };
+    SearchKernel kernels[] = { SCALAR_SEARCH, SSE42_SEARCH, AVX2_SEARCH };
+
+    vector<uint64_t> nodeProbes = makeUniformKeys<uint64_t>(PROBES, 0, PROBES, 3);
+    cout << "node search (8 x uint64_t)" << endl;
+    for(int k = 0; k < 3; k++) {
+        if(KeySearch<uint64_t>::setKernel(kernels[k])) {
+            cout << "  " << kernelNames[k] << "\t" << nodeCycles(nodeProbes) << " cycles" << endl;
+        }
+    }
+
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1, 2);
+        vector<uint64_t> probes = makeUniformKeys<uint64_t>(PROBES, 0, 2 * sizes[s] - 1, 4);
+        cout << "tree lookup, " << sizes[s] << " keys" << endl;
+
+        BTree<uint64_t, uint64_t> wide;
+        BTree<uint64_t, uint64_t, 32> wider;
+        AVLTree<uint64_t, uint64_t> avl;
+        for(size_t i = 0; i < keys.size(); i++) {
+            wide.insert(make_pair(keys[i], keys[i]));
+            wider.insert(make_pair(keys[i], keys[i]));
+            avl.insert(make_pair(keys[i], keys[i]));
+        }
+        for(int k = 0; k < 3; k++) {
+            if(KeySearch<uint64_t>::setKernel(kernels[k])) {
+                cout << "  BTree B=8 " << kernelNames[k] << "\t" << treeCycles(wide, probes) << " cycles" << endl;
+                cout << "  BTree B=32 " << kernelNames[k] << "\t" << treeCycles(wider, probes) << " cycles" << endl;
+            }
+        }
+        cout << "  AVLTree\t" << treeCycles(avl, probes) << " cycles" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+#ifndef SIMD_SEARCH_H
+#define SIMD_SEARCH_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SEARCH_X86 1
+#endif
+
+/**
+* Searching within the sorted key array of one wide node.
+*
+* countLess returns how many keys are less than key (where key would be
+* inserted) and countLessEqual how many are less than or equal to it
+* (which child an inner node routes key to). Both use only the key's
+* operator<, so any ordered key type works with the scalar loops below.
+*/
+template <typename Key>
+struct KeySearch
+{
+    static int countLess(const Key* keys, int count, const Key& key)
+    {
+        int i = 0;
+        while (i < count && keys[i] < key)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    static int countLessEqual(const Key* keys, int count, const Key& key)
+    {
+        int i = 0;
+        while (i < count && !(key < keys[i]))
+        {
+            ++i;
+        }
+        return i;
+    }
+};
+
+/**
+* The in-node search kernels available for integer keys.
+*/
+enum SearchKernel
+{
+    SCALAR_SEARCH,
+    SSE42_SEARCH,
+    AVX2_SEARCH
+};
+
+/**
+* Branch-free compare-and-count kernels for uint32_t and uint64_t keys.
+* The key is broadcast into a vector register, compared against a whole
+* vector of node keys at once, and the matching lanes are counted with a
+* movemask and popcount. Since the keys are sorted the count is the
+* position, so no per-key branch is needed. The SIMD compares are signed,
+* so both sides get their sign bit flipped first.
+*
+* The best kernel the CPU supports is picked on first use; setKernel()
+* can force another one, e.g. for benchmarking.
+*/
+template <typename T>
+class IntKeySearch
+{
+public:
+    static int countLess(const T* keys, int count, const T& key)
+    {
+        return kernels().less_(keys, count, key);
+    }
+
+    static int countLessEqual(const T* keys, int count, const T& key)
+    {
+        return count - kernels().greater_(keys, count, key);
+    }
+
+    static SearchKernel kernel()
+    {
+        return kernels().kind_;
+    }
+
+    static bool supports(SearchKernel kind);
+    static bool setKernel(SearchKernel kind);
+
+private:
+    typedef int (*CountFn)(const T* keys, int count, T key);
+
+    struct Kernels
+    {
+        CountFn less_;
+        CountFn greater_;
+        SearchKernel kind_;
+    };
+
+    static Kernels& kernels()
+    {
+        static Kernels selected = pick(supports(AVX2_SEARCH) ? AVX2_SEARCH :
+            supports(SSE42_SEARCH) ? SSE42_SEARCH : SCALAR_SEARCH);
+        return selected;
+    }
+
+    static Kernels pick(SearchKernel kind);
+
+    static int lessScalar(const T* keys, int count, T key);
+    static int greaterScalar(const T* keys, int count, T key);
+#ifdef SIMD_SEARCH_X86
+    static int lessSse42(const T* keys, int count, T key);
+    static int greaterSse42(const T* keys, int count, T key);
+    static int lessAvx2(const T* keys, int count, T key);
+    static int greaterAvx2(const T* keys, int count, T key);
+#endif
+};
+
+template <>
+struct KeySearch<uint32_t> : public IntKeySearch<uint32_t>
+{
+};
+
+template <>
+struct KeySearch<uint64_t> : public IntKeySearch<uint64_t>
+{
+};
+
+template<typename T>
+bool IntKeySearch<T>::supports(SearchKernel kind)
+{
+#ifdef SIMD_SEARCH_X86
+    if (kind == AVX2_SEARCH)
+    {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    }
+    if (kind == SSE42_SEARCH)
+    {
+        return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+    }
+#endif
+    return kind == SCALAR_SEARCH;
+}
+
+/**
+* Switches to the given kernel. Returns false, leaving the current
+* kernel in place, if the CPU does not support it.
+*/
+template<typename T>
+bool IntKeySearch<T>::setKernel(SearchKernel kind)
+{
+    if (!supports(kind))
+    {
+        return false;
+    }
+    kernels() = pick(kind);
+    return true;
+}
+
+template<typename T>
+typename IntKeySearch<T>::Kernels IntKeySearch<T>::pick(SearchKernel kind)
+{
+    Kernels chosen = { &lessScalar, &greaterScalar, SCALAR_SEARCH };
+#ifdef SIMD_SEARCH_X86
+    if (kind == AVX2_SEARCH)
+    {
+        chosen.less_ = &lessAvx2;
+        chosen.greater_ = &greaterAvx2;
+        chosen.kind_ = AVX2_SEARCH;
+    }
+    else if (kind == SSE42_SEARCH)
+    {
+        chosen.less_ = &lessSse42;
+        chosen.greater_ = &greaterSse42;
+        chosen.kind_ = SSE42_SEARCH;
+    }
+#endif
+    return chosen;
+}
+
+template<typename T>
+int IntKeySearch<T>::lessScalar(const T* keys, int count, T key)
+{
+    int n = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        n += keys[i] < key;
+    }
+    return n;
+}
+
+template<typename T>
+int IntKeySearch<T>::greaterScalar(const T* keys, int count, T key)
+{
+    int n = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        n += keys[i] > key;
+    }
+    return n;
+}
+
+#ifdef SIMD_SEARCH_X86
+
+/*
+  ------------------------------------------
+  Vector kernels, one pair per key width.
+  Any tail shorter than a vector is scalar.
+  ------------------------------------------
+*/
+
+template<>
+__attribute__((target("sse4.2,popcnt")))
+inline int IntKeySearch<uint64_t>::lessSse42(const uint64_t* keys, int count, uint64_t key)
+{
+    const __m128i flip = _mm_set1_epi64x(INT64_MIN);
+    const __m128i probe = _mm_xor_si128(_mm_set1_epi64x(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(probe, v))));
+    }
+    return n + lessScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("sse4.2,popcnt")))
+inline int IntKeySearch<uint64_t>::greaterSse42(const uint64_t* keys, int count, uint64_t key)
+{
+    const __m128i flip = _mm_set1_epi64x(INT64_MIN);
+    const __m128i probe = _mm_xor_si128(_mm_set1_epi64x(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(v, probe))));
+    }
+    return n + greaterScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("avx2,popcnt")))
+inline int IntKeySearch<uint64_t>::lessAvx2(const uint64_t* keys, int count, uint64_t key)
+{
+    const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i probe = _mm256_xor_si256(_mm256_set1_epi64x(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(probe, v))));
+    }
+    return n + lessScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("avx2,popcnt")))
+inline int IntKeySearch<uint64_t>::greaterAvx2(const uint64_t* keys, int count, uint64_t key)
+{
+    const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i probe = _mm256_xor_si256(_mm256_set1_epi64x(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, probe))));
+    }
+    return n + greaterScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("sse4.2,popcnt")))
+inline int IntKeySearch<uint32_t>::lessSse42(const uint32_t* keys, int count, uint32_t key)
+{
+    const __m128i flip = _mm_set1_epi32(INT32_MIN);
+    const __m128i probe = _mm_xor_si128(_mm_set1_epi32(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(probe, v))));
+    }
+    return n + lessScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("sse4.2,popcnt")))
+inline int IntKeySearch<uint32_t>::greaterSse42(const uint32_t* keys, int count, uint32_t key)
+{
+    const __m128i flip = _mm_set1_epi32(INT32_MIN);
+    const __m128i probe = _mm_xor_si128(_mm_set1_epi32(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, probe))));
+    }
+    return n + greaterScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("avx2,popcnt")))
+inline int IntKeySearch<uint32_t>::lessAvx2(const uint32_t* keys, int count, uint32_t key)
+{
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+    const __m256i probe = _mm256_xor_si256(_mm256_set1_epi32(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(probe, v))));
+    }
+    return n + lessScalar(keys + i, count - i, key);
+}
+
+template<>
+__attribute__((target("avx2,popcnt")))
+inline int IntKeySearch<uint32_t>::greaterAvx2(const uint32_t* keys, int count, uint32_t key)
+{
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+    const __m256i probe = _mm256_xor_si256(_mm256_set1_epi32(key), flip);
+    int n = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+        n += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, probe))));
+    }
+    return n + greaterScalar(keys + i, count - i, key);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+#include "skiplist_map.h"
+
+using namespace std;
+
+// Checks that a map holds exactly the contents of expected, in order.
+template<typename Map>
+bool sameContents(const Map& sl, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(typename Map::iterator it = sl.begin(); it != sl.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    SkipListMap<int, int> sl;
+    map<int,int> model;
+    srand(44);
+    bool ok = sl.empty() && sl.begin() == sl.end();
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 2000;
+        int op = rand() % 3;
+        if(op == 0) {
+            sl.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else if(op == 1) {
+            sl.remove(key);
+            model.erase(key);
+        }
+        else {
+            int value = -1;
+            bool found = sl.find(key, value);
+            ok = ok && found == (model.count(key) > 0) && (!found || value == model[key]);
+            ok = ok && (sl.find(key) != sl.end()) == found && sl.contains(key) == found;
+        }
+        if(i % 500 == 0) {
+            ok = ok && sameContents(sl, model);
+        }
+    }
+    cout << "Single-threaded updates match: " << (ok && sameContents(sl, model)) << endl;
+
+    int missing = -1;
+    while(model.count(missing)) {
+        missing--;
+    }
+    bool threw = false;
+    try {
+        sl[missing];
+    }
+    catch(out_of_range&) {
+        threw = true;
+    }
+    map<int,int>::iterator mid = model.lower_bound(1000);
+    cout << "operator[] and lower_bound: "
+         << (threw && sl[model.begin()->first] == model.begin()->second
+             && sl.lower_bound(1000)->first == mid->first) << endl;
+
+    // strings exercise values that are not trivially copyable
+    SkipListMap<string, string> names;
+    names.insert(make_pair(string("b"), string("two")));
+    names.insert(make_pair(string("a"), string("one")));
+    names.insert(make_pair(string("b"), string("deux")));
+    names.remove("a");
+    cout << "String values: " << (names["b"] == "deux" && !names.contains("a")) << endl;
+
+    // writers on disjoint key ranges, with readers running alongside
+    SkipListMap<int, int> shared;
+    const int writers = 4;
+    const int perWriter = 20000;
+    vector<thread> threads;
+    for(int t = 0; t < writers; t++) {
+        threads.push_back(thread([&shared, t]() {
+            for(int i = 0; i < perWriter; i++) {
+                shared.insert(make_pair(i * writers + t, i));
+            }
+            // remove the odd i and overwrite the rest
+            for(int i = 1; i < perWriter; i += 2) {
+                shared.remove(i * writers + t);
+            }
+            for(int i = 0; i < perWriter; i += 2) {
+                shared.insert(make_pair(i * writers + t, -i));
+            }
+        }));
+    }
+    bool readersOk = true;
+    threads.push_back(thread([&shared, &readersOk]() {
+        for(int round = 0; round < 20; round++) {
+            int last = -1;
+            for(SkipListMap<int, int>::iterator it = shared.begin(); it != shared.end(); ++it) {
+                if(it->first <= last) {
+                    readersOk = false;
+                }
+                last = it->first;
+            }
+        }
+    }));
+    for(size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    map<int,int> expected;
+    for(int t = 0; t < writers; t++) {
+        for(int i = 0; i < perWriter; i += 2) {
+            expected[i * writers + t] = -i;
+        }
+    }
+    cout << "Concurrent writers: " << (readersOk && sameContents(shared, expected)) << endl;
+
+    // writers racing on the same keys must leave a consistent map
+    SkipListMap<int, int> contended;
+    threads.clear();
+    for(int t = 0; t < writers; t++) {
+        threads.push_back(thread([&contended, t]() {
+            unsigned seed = t;
+            for(int i = 0; i < 50000; i++) {
+                int key = rand_r(&seed) % 64;
+                if(rand_r(&seed) % 2) {
+                    contended.insert(make_pair(key, key));
+                }
+                else {
+                    contended.remove(key);
+                }
+            }
+        }));
+    }
+    for(size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    ok = true;
+    int last = -1;
+    for(SkipListMap<int, int>::iterator it = contended.begin(); it != contended.end(); ++it) {
+        ok = ok && it->first > last && it->second == it->first && contended.contains(it->first);
+        last = it->first;
+    }
+    for(int key = 0; key < 64; key++) {
+        contended.remove(key);
+    }
+    cout << "Contended keys: " << (ok && contended.empty()) << endl;
+
+    // overwrites racing removes of the same few keys; readers must only
+    // ever see a value written for the key they look up
+    SkipListMap<int, string> churn;
+    atomic<bool> churning(true);
+    bool churnReadOk = true;
+    threads.clear();
+    for(int t = 0; t < writers; t++) {
+        threads.push_back(thread([&churn, t]() {
+            unsigned seed = 44 + t;
+            for(int i = 0; i < 50000; i++) {
+                int key = rand_r(&seed) % 8;
+                if(rand_r(&seed) % 3) {
+                    churn.insert(make_pair(key, string(40, 'a' + key) + to_string(i)));
+                }
+                else {
+                    churn.remove(key);
+                }
+            }
+        }));
+    }
+    thread reader([&churn, &churning, &churnReadOk]() {
+        unsigned seed = 144;
+        while(churning.load()) {
+            int key = rand_r(&seed) % 8;
+            string value;
+            if(churn.find(key, value) && value.compare(0, 40, string(40, 'a' + key)) != 0) {
+                churnReadOk = false;
+            }
+        }
+    });
+    for(size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    churning.store(false);
+    reader.join();
+    ok = churnReadOk;
+    for(SkipListMap<int, string>::iterator it = churn.begin(); it != churn.end(); ++it) {
+        ok = ok && it->second.compare(0, 40, string(40, 'a' + it->first)) == 0;
+    }
+    cout << "Overwrites racing removes: " << ok << endl;
+    return 0;
+}
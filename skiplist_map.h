@@ -0,0 +1,603 @@
+#ifndef SKIPLIST_MAP_H
+#define SKIPLIST_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "epoch.h"
+
+/**
+* A lock-free ordered map for many concurrent writers, built as a skip
+* list.
+*
+* Every level is a sorted linked list. A node is linked in at level 0
+* first, which is the moment it enters the map, and then at its upper
+* levels. Removal marks the node's upper next pointers, top level
+* first, then swaps a removed marker into its value, which is the moment
+* the key leaves, and marks level 0 last. Searches unlink marked nodes
+* as they pass them, and readers pass over a node holding the marker. Each of these steps is a single
+* compare-and-swap on one pointer, so there is nothing to lock and no
+* operation waits for another. Unlike a rotation in a balanced tree,
+* each step touches only one link, which is what makes the structure
+* workable without locks.
+*
+* Unlinked nodes go to the EpochManager, and every operation runs inside
+* an EpochGuard, so no thread touches freed memory. A value is stored
+* behind its own pointer; overwriting a key swaps the pointer in with a
+* compare-and-swap, which fails once the removed marker is there, and
+* retires the old value, so readers always copy a whole value and an
+* overwrite never lands on a key that has already left.
+*
+* Lookups copy the value out. Iterators hold a copy of the item they are
+* at, and ++ looks up the next larger key, so iterating while others
+* write is safe; it sees each key that stays in the map throughout.
+*/
+template <class Key, class Value>
+class SkipListMap
+{
+public:
+    SkipListMap();
+    ~SkipListMap();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+    Value operator[](const Key& key) const;
+    bool empty() const;
+
+    /**
+    * A forward iterator over a snapshot of one item at a time.
+    */
+    class iterator
+    {
+    public:
+        iterator() : map_(nullptr)
+        {
+
+        }
+
+        const std::pair<const Key, Value>& operator*() const
+        {
+            return *item_;
+        }
+        const std::pair<const Key, Value>* operator->() const
+        {
+            return item_.get();
+        }
+
+        bool operator==(const iterator& rhs) const
+        {
+            if (item_ == nullptr || rhs.item_ == nullptr)
+            {
+                return item_ == rhs.item_;
+            }
+            return !(item_->first < rhs.item_->first) && !(rhs.item_->first < item_->first);
+        }
+        bool operator!=(const iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        iterator& operator++()
+        {
+            item_ = map_->firstItem(&item_->first, true);
+            return *this;
+        }
+
+    private:
+        friend class SkipListMap<Key, Value>;
+        iterator(const SkipListMap* map, std::shared_ptr<const std::pair<const Key, Value> > item) :
+            map_(map), item_(item)
+        {
+
+        }
+
+        const SkipListMap* map_;
+        std::shared_ptr<const std::pair<const Key, Value> > item_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+
+private:
+    static const int maxLevel_ = 16;
+
+    /**
+    * A node with its tower of next pointers allocated right behind it.
+    * The low bit of a next pointer marks the node as removed at that
+    * level.
+    */
+    struct SkipNode
+    {
+        static SkipNode* create(const Key& key, const Value& value, int height);
+        static void destroy(void* node);
+
+        Key key_;
+        std::atomic<Value*> value_;
+        int height_;
+        std::atomic<int> owners_;           // the inserter, and a remover once marked
+        std::atomic<uintptr_t> next_[1];    // really height_ entries
+
+    private:
+        SkipNode(const Key& key, Value* value, int height);
+        ~SkipNode();
+    };
+
+    static SkipNode* pointer(uintptr_t link)
+    {
+        return reinterpret_cast<SkipNode*>(link & ~uintptr_t(1));
+    }
+    static bool marked(uintptr_t link)
+    {
+        return (link & 1) != 0;
+    }
+    static uintptr_t link(SkipNode* node)
+    {
+        return reinterpret_cast<uintptr_t>(node);
+    }
+    /**
+    * The value pointer a remover swaps in: never dereferenced, only
+    * compared against.
+    */
+    static Value* removedValue()
+    {
+        static char marker;
+        return reinterpret_cast<Value*>(&marker);
+    }
+
+    static int randomLevel();
+    std::atomic<uintptr_t>& nextOf(SkipNode* pred, int level) const;
+    bool search(const Key& key, SkipNode** preds, SkipNode** succs);
+    SkipNode* readOnlySearch(const Key& key, bool strictlyGreater, Value*& value) const;
+    std::shared_ptr<const std::pair<const Key, Value> > firstItem(const Key* key, bool strictlyGreater) const;
+    void release(SkipNode* node);
+
+    SkipListMap(const SkipListMap&);
+    SkipListMap& operator=(const SkipListMap&);
+
+    mutable std::atomic<uintptr_t> head_[maxLevel_];
+};
+
+template<class Key, class Value>
+SkipListMap<Key, Value>::SkipNode::SkipNode(const Key& key, Value* value, int height) :
+    key_(key),
+    value_(value),
+    height_(height),
+    owners_(2)
+{
+    for (int i = 0; i < height; ++i)
+    {
+        new (&next_[i]) std::atomic<uintptr_t>(0);
+    }
+}
+
+template<class Key, class Value>
+SkipListMap<Key, Value>::SkipNode::~SkipNode()
+{
+    Value* value = value_.load();
+    if (value != removedValue())
+    {
+        delete value;
+    }
+}
+
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::SkipNode* SkipListMap<Key, Value>::SkipNode::create(const Key& key, const Value& value, int height)
+{
+    void* memory = ::operator new(sizeof(SkipNode) + (height - 1) * sizeof(std::atomic<uintptr_t>));
+    Value* boxed = nullptr;
+    try
+    {
+        boxed = new Value(value);
+        return new (memory) SkipNode(key, boxed, height);
+    }
+    catch (...)
+    {
+        delete boxed;
+        ::operator delete(memory);
+        throw;
+    }
+}
+
+template<class Key, class Value>
+void SkipListMap<Key, Value>::SkipNode::destroy(void* node)
+{
+    static_cast<SkipNode*>(node)->~SkipNode();
+    ::operator delete(node);
+}
+
+template<class Key, class Value>
+SkipListMap<Key, Value>::SkipListMap()
+{
+    for (int i = 0; i < maxLevel_; ++i)
+    {
+        head_[i].store(0);
+    }
+}
+
+/**
+* Frees every node. No other thread may be using the map by now.
+*/
+template<class Key, class Value>
+SkipListMap<Key, Value>::~SkipListMap()
+{
+    SkipNode* node = pointer(head_[0].load());
+    while (node != nullptr)
+    {
+        SkipNode* next = pointer(node->next_[0].load());
+        SkipNode::destroy(node);
+        node = next;
+    }
+}
+
+/**
+* Draws a tower height: each level above the first is kept with
+* probability 1/4.
+*/
+template<class Key, class Value>
+int SkipListMap<Key, Value>::randomLevel()
+{
+    static thread_local uint32_t seed = 2463534242u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&seed));
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    int level = 1;
+    for (uint32_t bits = seed; level < maxLevel_ && (bits & 3) == 0; bits >>= 2)
+    {
+        ++level;
+    }
+    return level;
+}
+
+/**
+* The level-th next pointer of pred, where a null pred is the head.
+*/
+template<class Key, class Value>
+std::atomic<uintptr_t>& SkipListMap<Key, Value>::nextOf(SkipNode* pred, int level) const
+{
+    return pred == nullptr ? head_[level] : pred->next_[level];
+}
+
+/**
+* Finds, on every level, the last node with a key below key (preds, null
+* for the head) and the node after it (succs), unlinking marked nodes on
+* the way. Returns whether succs[0] holds key.
+*/
+template<class Key, class Value>
+bool SkipListMap<Key, Value>::search(const Key& key, SkipNode** preds, SkipNode** succs)
+{
+retry:
+    SkipNode* pred = nullptr;
+    for (int level = maxLevel_ - 1; level >= 0; --level)
+    {
+        SkipNode* cur = pointer(nextOf(pred, level).load());
+        while (cur != nullptr)
+        {
+            uintptr_t succ = cur->next_[level].load();
+            while (marked(succ))
+            {
+                uintptr_t expected = link(cur);
+                if (!nextOf(pred, level).compare_exchange_strong(expected, link(pointer(succ))))
+                {
+                    goto retry;
+                }
+                cur = pointer(succ);
+                if (cur == nullptr)
+                {
+                    break;
+                }
+                succ = cur->next_[level].load();
+            }
+            if (cur == nullptr || !(cur->key_ < key))
+            {
+                break;
+            }
+            pred = cur;
+            cur = pointer(succ);
+        }
+        preds[level] = pred;
+        succs[level] = cur;
+    }
+    return succs[0] != nullptr && !(key < succs[0]->key_);
+}
+
+/**
+* Returns the first node still in the map with a key at least key (or
+* greater than key), without changing anything, and its value pointer,
+* read once, in value. The value stays valid for the caller's guard.
+*/
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::SkipNode* SkipListMap<Key, Value>::readOnlySearch(const Key& key, bool strictlyGreater, Value*& value) const
+{
+    SkipNode* pred = nullptr;
+    SkipNode* cur = nullptr;
+    for (int level = maxLevel_ - 1; level >= 0; --level)
+    {
+        cur = pointer(nextOf(pred, level).load(std::memory_order_acquire));
+        while (cur != nullptr)
+        {
+            uintptr_t succ = cur->next_[level].load(std::memory_order_acquire);
+            bool before = strictlyGreater ? !(key < cur->key_) : cur->key_ < key;
+            if (!marked(succ) && !before)
+            {
+                if (level > 0)
+                {
+                    break;
+                }
+                value = cur->value_.load(std::memory_order_acquire);
+                if (value != removedValue())
+                {
+                    break;
+                }
+            }
+            if (!marked(succ))
+            {
+                pred = cur;
+            }
+            cur = pointer(succ);
+        }
+    }
+    return cur;
+}
+
+/**
+* Drops one claim on a node; the last claim retires it. The inserter
+* holds one until it is done linking the upper levels, and the remover
+* that swaps in the removed marker holds the other until its cleanup
+* search is done,
+* so a node is retired only once nobody can link it in again.
+*/
+template<class Key, class Value>
+void SkipListMap<Key, Value>::release(SkipNode* node)
+{
+    if (node->owners_.fetch_sub(1) == 1)
+    {
+        EpochManager::instance().retire(node, &SkipNode::destroy);
+    }
+}
+
+/**
+* Inserts a key, or overwrites its value if it is already in the map.
+*/
+template<class Key, class Value>
+void SkipListMap<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    EpochGuard guard;
+    SkipNode* preds[maxLevel_];
+    SkipNode* succs[maxLevel_];
+    int height = randomLevel();
+    while (true)
+    {
+        if (search(keyValuePair.first, preds, succs))
+        {
+            Value* fresh = new Value(keyValuePair.second);
+            Value* old = succs[0]->value_.load();
+            while (old != removedValue() && !succs[0]->value_.compare_exchange_weak(old, fresh))
+            {
+
+            }
+            if (old != removedValue())
+            {
+                EpochManager::instance().retire(old);
+                return;
+            }
+            // the key has left; help mark level 0 so the next search
+            // unlinks the node, then insert afresh
+            delete fresh;
+            succs[0]->next_[0].fetch_or(1);
+            continue;
+        }
+        SkipNode* node = SkipNode::create(keyValuePair.first, keyValuePair.second, height);
+        for (int level = 0; level < height; ++level)
+        {
+            node->next_[level].store(link(succs[level]), std::memory_order_relaxed);
+        }
+        uintptr_t expected = link(succs[0]);
+        if (!nextOf(preds[0], 0).compare_exchange_strong(expected, link(node)))
+        {
+            SkipNode::destroy(node);    // never visible to anyone
+            continue;
+        }
+
+        // the key is in; the upper levels only speed up searches
+        for (int level = 1; level < height; ++level)
+        {
+            while (true)
+            {
+                uintptr_t next = node->next_[level].load();
+                if (marked(next))
+                {
+                    goto linked;    // being removed: stop building the tower
+                }
+                if (pointer(next) != succs[level] &&
+                    !node->next_[level].compare_exchange_strong(next, link(succs[level])))
+                {
+                    continue;
+                }
+                expected = link(succs[level]);
+                if (nextOf(preds[level], level).compare_exchange_strong(expected, link(node)))
+                {
+                    break;
+                }
+                search(keyValuePair.first, preds, succs);
+                if (succs[0] != node)
+                {
+                    goto linked;
+                }
+            }
+        }
+    linked:
+        if (marked(node->next_[0].load()))
+        {
+            // removed while linking; make sure no level still reaches it
+            search(keyValuePair.first, preds, succs);
+        }
+        release(node);
+        return;
+    }
+}
+
+template<class Key, class Value>
+void SkipListMap<Key, Value>::remove(const Key& key)
+{
+    EpochGuard guard;
+    SkipNode* preds[maxLevel_];
+    SkipNode* succs[maxLevel_];
+    if (!search(key, preds, succs))
+    {
+        return;
+    }
+    SkipNode* node = succs[0];
+    for (int level = node->height_ - 1; level >= 1; --level)
+    {
+        uintptr_t next = node->next_[level].load();
+        while (!marked(next) && !node->next_[level].compare_exchange_weak(next, next | 1))
+        {
+
+        }
+    }
+    Value* old = node->value_.exchange(removedValue());
+    if (old == removedValue())
+    {
+        return;     // another remover got there first
+    }
+    EpochManager::instance().retire(old);
+    node->next_[0].fetch_or(1);     // an inserter may have helped already
+    search(key, preds, succs);
+    release(node);
+}
+
+/**
+* Copies the value stored under key into value and returns true,
+* or returns false if the key is not in the map.
+*/
+template<class Key, class Value>
+bool SkipListMap<Key, Value>::find(const Key& key, Value& value) const
+{
+    EpochGuard guard;
+    Value* found = nullptr;
+    SkipNode* node = readOnlySearch(key, false, found);
+    if (node == nullptr || key < node->key_)
+    {
+        return false;
+    }
+    value = *found;
+    return true;
+}
+
+template<class Key, class Value>
+bool SkipListMap<Key, Value>::contains(const Key& key) const
+{
+    EpochGuard guard;
+    Value* found = nullptr;
+    SkipNode* node = readOnlySearch(key, false, found);
+    return node != nullptr && !(key < node->key_);
+}
+
+/**
+ * @precondition The key exists in the map
+ * Returns a copy of the value associated with the key
+ */
+template<class Key, class Value>
+Value SkipListMap<Key, Value>::operator[](const Key& key) const
+{
+    EpochGuard guard;
+    Value* found = nullptr;
+    SkipNode* node = readOnlySearch(key, false, found);
+    if (node == nullptr || key < node->key_) throw std::out_of_range("Invalid key");
+    return *found;
+}
+
+template<class Key, class Value>
+bool SkipListMap<Key, Value>::empty() const
+{
+    EpochGuard guard;
+    for (SkipNode* node = pointer(head_[0].load()); node != nullptr; node = pointer(node->next_[0].load()))
+    {
+        if (!marked(node->next_[0].load()) && node->value_.load() != removedValue())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* Returns a copy of the first item with a key at least *key (or greater
+* than *key), or of the very first item if key is null; null past the end.
+*/
+template<class Key, class Value>
+std::shared_ptr<const std::pair<const Key, Value> > SkipListMap<Key, Value>::firstItem(const Key* key, bool strictlyGreater) const
+{
+    EpochGuard guard;
+    SkipNode* node;
+    Value* value = nullptr;
+    if (key != nullptr)
+    {
+        node = readOnlySearch(*key, strictlyGreater, value);
+    }
+    else
+    {
+        for (node = pointer(head_[0].load()); node != nullptr; node = pointer(node->next_[0].load()))
+        {
+            if (!marked(node->next_[0].load()))
+            {
+                value = node->value_.load(std::memory_order_acquire);
+                if (value != removedValue())
+                {
+                    break;
+                }
+            }
+        }
+    }
+    if (node == nullptr)
+    {
+        return std::shared_ptr<const std::pair<const Key, Value> >();
+    }
+    return std::make_shared<const std::pair<const Key, Value> >(node->key_, *value);
+}
+
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::iterator SkipListMap<Key, Value>::begin() const
+{
+    return iterator(this, firstItem(nullptr, false));
+}
+
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::iterator SkipListMap<Key, Value>::end() const
+{
+    return iterator(this, std::shared_ptr<const std::pair<const Key, Value> >());
+}
+
+/**
+* Returns an iterator to the item with the given key, or end().
+*/
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::iterator SkipListMap<Key, Value>::find(const Key& key) const
+{
+    iterator it = lower_bound(key);
+    if (it != end() && key < it->first)
+    {
+        return end();
+    }
+    return it;
+}
+
+/**
+* Returns an iterator to the first item whose key is not less than key.
+*/
+template<class Key, class Value>
+typename SkipListMap<Key, Value>::iterator SkipListMap<Key, Value>::lower_bound(const Key& key) const
+{
+    return iterator(this, firstItem(&key, false));
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "avlbst.h"
+#include "rbbst.h"
+#include "splay_bst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Lookups of Zipf-distributed keys in a SplayTree against AVLTree and
+// RedBlackTree. Skew 0 is uniform; around 1 is typical of real traffic.
+//
+// usage: splay-bench [keys ...]    (default: 1000000)
+
+const double skews[] = { 0, 0.8, 0.99, 1.2 };
+
+template<typename Tree>
+double timeLookups(Tree& tree, const vector<uint64_t>& keys, const vector<uint64_t>& lookups)
+{
+    for(size_t i = 0; i < keys.size(); i++) {
+        tree.insert(make_pair(keys[i], keys[i]));
+    }
+    BenchTimer timer;
+    uint64_t sum = 0;
+    for(size_t i = 0; i < lookups.size(); i++) {
+        sum += tree.find(lookups[i])->second;
+    }
+    double seconds = timer.seconds();
+    benchSink(sum);
+    return seconds;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        // a shuffled key list turns ranks into keys, so the hot keys are
+        // spread over the key space instead of all being the smallest
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1);
+        for(size_t k = 0; k < sizeof(skews) / sizeof(skews[0]); k++) {
+            vector<uint64_t> lookups = makeZipfKeys<uint64_t>(sizes[s], sizes[s], skews[k], 2);
+            for(size_t i = 0; i < lookups.size(); i++) {
+                lookups[i] = keys[lookups[i]];
+            }
+            AVLTree<uint64_t, uint64_t> avl;
+            RedBlackTree<uint64_t, uint64_t> rb;
+            SplayTree<uint64_t, uint64_t> splay;
+            double avlSeconds = timeLookups(avl, keys, lookups);
+            double rbSeconds = timeLookups(rb, keys, lookups);
+            double splaySeconds = timeLookups(splay, keys, lookups);
+            cout << keys.size() << " keys\tskew " << skews[k]
+                 << "\tavl " << avlSeconds << " s"
+                 << "\tred-black " << rbSeconds << " s"
+                 << "\tsplay " << splaySeconds << " s" << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include "splay_bst.h"
+
+using namespace std;
+
+// A SplayTree that exposes its root and can check its links.
+class CheckedSplayTree : public SplayTree<int, int>
+{
+public:
+    bool linksValid() const
+    {
+        return check(root_, nullptr);
+    }
+
+    bool atRoot(int key) const
+    {
+        return root_ != nullptr && root_->getKey() == key;
+    }
+
+private:
+    static bool check(Node<int, int>* node, Node<int, int>* parent)
+    {
+        if(node == nullptr) {
+            return true;
+        }
+        return node->getParent() == parent
+               && (node->getLeft() == nullptr || node->getLeft()->getKey() < node->getKey())
+               && (node->getRight() == nullptr || node->getKey() < node->getRight()->getKey())
+               && check(node->getLeft(), node) && check(node->getRight(), node);
+    }
+};
+
+// Checks that a tree holds exactly the contents of expected.
+bool sameContents(const BinarySearchTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(BinarySearchTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedSplayTree st;
+    map<int,int> model;
+    srand(42);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 2000;
+        int op = rand() % 3;
+        if(op == 0) {
+            st.insert(make_pair(key, i));
+            model[key] = i;
+            ok = ok && st.atRoot(key);
+        }
+        else if(op == 1) {
+            st.remove(key);
+            model.erase(key);
+        }
+        else {
+            SplayTree<int, int>::iterator it = st.find(key);
+            bool present = model.count(key) > 0;
+            ok = ok && (it != st.end()) == present;
+            ok = ok && (!present || (it->second == model[key] && st.atRoot(key)));
+        }
+        if(i % 100 == 0) {
+            ok = ok && sameContents(st, model) && st.linksValid();
+        }
+    }
+    cout << "Random updates match: " << (ok && sameContents(st, model) && st.linksValid()) << endl;
+
+    // operator[] splays too; through a const reference nothing moves
+    int hot = model.begin()->first;
+    st[hot] = -1;
+    model[hot] = -1;
+    const SplayTree<int, int>& constTree = st;
+    int other = model.rbegin()->first;
+    bool constOk = constTree.find(other)->second == model[other] && constTree[other] == model[other];
+    cout << "operator[]: " << (st.atRoot(hot) && constOk && sameContents(st, model)) << endl;
+
+    // ascending inserts make a path; lookups must still work and reshape it
+    st.clear();
+    for(int i = 0; i < 3000; i++) {
+        st.insert(make_pair(i, i));
+    }
+    ok = true;
+    for(int i = 0; i < 3000; i += 7) {
+        ok = ok && st.find(i)->second == i && st.atRoot(i);
+    }
+    cout << "Ascending inserts: " << (ok && st.linksValid()) << endl;
+
+    for(int i = 0; i < 3000; i++) {
+        st.remove(i);
+    }
+    cout << "Remove everything: " << st.empty() << endl;
+
+    // a million ascending inserts leave a chain a million nodes deep; the
+    // const lookup of its far end and destroying it must not recurse
+    bool chainOk;
+    {
+        SplayTree<int, int> chain;
+        for(int i = 0; i < 1000000; i++) {
+            chain.insert(make_pair(i, i));
+        }
+        const SplayTree<int, int>& constChain = chain;
+        chainOk = constChain.find(0) != constChain.end() && constChain[0] == 0
+                  && constChain.find(-1) == constChain.end();
+    }
+    cout << "Million-node chain: " << chainOk << endl;
+    return 0;
+}
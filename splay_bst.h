@@ -0,0 +1,253 @@
+#ifndef SPLAY_BST_H
+#define SPLAY_BST_H
+
+#include <stdexcept>
+#include <utility>
+#include "bst.h"
+
+/**
+* A splay tree: every access moves the node it reaches to the root by a
+* series of rotations. Nothing bounds the height, but any sequence of
+* operations costs O(log n) amortized each, and a small set of hot keys
+* stays near the root, where looking them up costs close to O(1).
+*
+* Lookups through a non-const tree splay. Through a const tree, find and
+* operator[] are the plain BinarySearchTree lookups and change nothing.
+*/
+template <typename Key, typename Value>
+class SplayTree : public BinarySearchTree<Key, Value>
+{
+public:
+    typedef typename BinarySearchTree<Key, Value>::iterator iterator;
+    using BinarySearchTree<Key, Value>::find;
+    using BinarySearchTree<Key, Value>::operator[];
+
+    virtual void insert(const std::pair<const Key, Value>& keyValuePair);
+    virtual void remove(const Key& key);
+    iterator find(const Key& key);
+    Value& operator[](const Key& key);
+
+protected:
+    virtual void removeNode(Node<Key, Value>* node) override;
+    Node<Key, Value>* splayFind(const Key& key);
+    void rotateUp(Node<Key, Value>* node);
+    void splay(Node<Key, Value>* node);
+};
+
+/**
+* Rotates node above its parent.
+*/
+template<typename Key, typename Value>
+void SplayTree<Key, Value>::rotateUp(Node<Key, Value>* node)
+{
+    Node<Key, Value>* parent = node->getParent();
+    Node<Key, Value>* grandp = parent->getParent();
+    if (parent->getLeft() == node)
+    {
+        Node<Key, Value>* middle = node->getRight();
+        parent->setLeft(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(parent);
+        }
+        node->setRight(parent);
+    }
+    else
+    {
+        Node<Key, Value>* middle = node->getLeft();
+        parent->setRight(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(parent);
+        }
+        node->setLeft(parent);
+    }
+    parent->setParent(node);
+    node->setParent(grandp);
+    if (grandp == nullptr)
+    {
+        this->root_ = node;
+    }
+    else if (grandp->getLeft() == parent)
+    {
+        grandp->setLeft(node);
+    }
+    else
+    {
+        grandp->setRight(node);
+    }
+}
+
+/**
+* Moves node to the root. A node on the same side of its parent as the
+* parent is of the grandparent (zig-zig) rotates the parent first; that
+* is what roughly halves the depth of every node on the path.
+*/
+template<typename Key, typename Value>
+void SplayTree<Key, Value>::splay(Node<Key, Value>* node)
+{
+    while (node->getParent() != nullptr)
+    {
+        Node<Key, Value>* parent = node->getParent();
+        Node<Key, Value>* grandp = parent->getParent();
+        if (grandp == nullptr) //zig
+        {
+            rotateUp(node);
+        }
+        else if ((grandp->getLeft() == parent) == (parent->getLeft() == node)) //zig-zig
+        {
+            rotateUp(parent);
+            rotateUp(node);
+        }
+        else //zig-zag
+        {
+            rotateUp(node);
+            rotateUp(node);
+        }
+    }
+}
+
+/**
+* Looks up key and splays the node where the search ended, found or not,
+* so that misses pay for their path too. Returns the node with key, or
+* nullptr.
+*/
+template<typename Key, typename Value>
+Node<Key, Value>* SplayTree<Key, Value>::splayFind(const Key& key)
+{
+    Node<Key, Value>* last = nullptr;
+    Node<Key, Value>* cur = this->root_;
+    while (cur != nullptr)
+    {
+        last = cur;
+        if (cur->getKey() == key)
+        {
+            break;
+        }
+        cur = cur->getKey() > key ? cur->getLeft() : cur->getRight();
+    }
+    if (last != nullptr)
+    {
+        splay(last);
+    }
+    return cur;
+}
+
+/**
+* Returns an iterator to the item with the given key, or end(), and
+* brings the item to the root.
+*/
+template<typename Key, typename Value>
+typename SplayTree<Key, Value>::iterator SplayTree<Key, Value>::find(const Key& key)
+{
+    if (splayFind(key) == nullptr)
+    {
+        return this->end();
+    }
+    // the item is now at the root, so the plain lookup stops right there
+    return BinarySearchTree<Key, Value>::find(key);
+}
+
+/**
+* @precondition The key exists in the map
+* Returns the value associated with the key and brings it to the root.
+*/
+template<typename Key, typename Value>
+Value& SplayTree<Key, Value>::operator[](const Key& key)
+{
+    Node<Key, Value>* node = splayFind(key);
+    if (node == nullptr)
+    {
+        throw std::out_of_range("Invalid key");
+    }
+    return node->getValue();
+}
+
+/*
+ * If key is already in the tree, its value is overwritten. Either way
+ * the item ends up at the root.
+ */
+template<typename Key, typename Value>
+void SplayTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    Node<Key, Value>* parent = nullptr;
+    Node<Key, Value>* cur = this->root_;
+    while (cur != nullptr)
+    {
+        if (cur->getKey() == keyValuePair.first)
+        {
+            cur->setValue(keyValuePair.second);
+            splay(cur);
+            return;
+        }
+        parent = cur;
+        cur = cur->getKey() > keyValuePair.first ? cur->getLeft() : cur->getRight();
+    }
+    Node<Key, Value>* node = new Node<Key, Value>(keyValuePair.first, keyValuePair.second, parent);
+    if (parent == nullptr)
+    {
+        this->root_ = node;
+        return;
+    }
+    if (parent->getKey() > keyValuePair.first)
+    {
+        parent->setLeft(node);
+    }
+    else
+    {
+        parent->setRight(node);
+    }
+    splay(node);
+}
+
+/**
+* Splays the node to the root and removes it, then splays the largest
+* node of the left subtree to the top of that subtree, where it has no
+* right child, and hangs the right subtree there.
+*/
+template<typename Key, typename Value>
+void SplayTree<Key, Value>::remove(const Key& key)
+{
+    Node<Key, Value>* node = splayFind(key);
+    if (node != nullptr)
+    {
+        removeNode(node);
+    }
+}
+
+/**
+* Splays node to the root, frees it, and joins its two subtrees under
+* the largest node of the left one.
+*/
+template<typename Key, typename Value>
+void SplayTree<Key, Value>::removeNode(Node<Key, Value>* node)
+{
+    splay(node);
+    Node<Key, Value>* left = node->getLeft();
+    Node<Key, Value>* right = node->getRight();
+    this->destroyNode(node);
+    if (right != nullptr)
+    {
+        right->setParent(nullptr);
+    }
+    if (left == nullptr)
+    {
+        this->root_ = right;
+        return;
+    }
+    left->setParent(nullptr);
+    this->root_ = left;
+    Node<Key, Value>* largest = left;
+    while (largest->getRight() != nullptr)
+    {
+        largest = largest->getRight();
+    }
+    splay(largest);
+    largest->setRight(right);
+    if (right != nullptr)
+    {
+        right->setParent(largest);
+    }
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "avlbst.h"
+#include "rbbst.h"
+#include "treap_bst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Treap against AVLTree and RedBlackTree on random inserts, lookups and
+// removes, and the cost of splitting a treap in half and merging it back.
+//
+// usage: treap-bench [keys ...]    (default: 1000000)
+
+template<typename Tree>
+void run(const string& name, const vector<uint64_t>& keys)
+{
+    Tree tree;
+    BenchTimer timer;
+    for(size_t i = 0; i < keys.size(); i++) {
+        tree.insert(make_pair(keys[i], keys[i]));
+    }
+    double insertSeconds = timer.seconds();
+    timer.restart();
+    uint64_t sum = 0;
+    for(size_t i = 0; i < keys.size(); i++) {
+        sum += tree.find(keys[i])->second;
+    }
+    double findSeconds = timer.seconds();
+    benchSink(sum);
+    timer.restart();
+    for(size_t i = 0; i < keys.size(); i++) {
+        tree.remove(keys[i]);
+    }
+    double removeSeconds = timer.seconds();
+
+    cout << keys.size() << " keys\t" << name
+         << "\tinsert " << insertSeconds << " s"
+         << "\tfind " << findSeconds << " s"
+         << "\tremove " << removeSeconds << " s"
+         << "\trotations/update " << double(tree.rotations()) / (2 * keys.size()) << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        vector<uint64_t> keys = makeShuffledKeys<uint64_t>(sizes[s], 1);
+        run<AVLTree<uint64_t, uint64_t> >("avl", keys);
+        run<RedBlackTree<uint64_t, uint64_t> >("red-black", keys);
+        run<Treap<uint64_t, uint64_t> >("treap", keys);
+
+        Treap<uint64_t, uint64_t> treap;
+        for(size_t i = 0; i < keys.size(); i++) {
+            treap.insert(make_pair(keys[i], keys[i]));
+        }
+        const int rounds = 1000;
+        BenchTimer timer;
+        for(int r = 0; r < rounds; r++) {
+            Treap<uint64_t, uint64_t> upper;
+            treap.split(keys[r], upper);
+            treap.merge(upper);
+        }
+        cout << keys.size() << " keys\ttreap split + merge " << timer.seconds() * 1e6 / rounds << " us" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+#include "treap_bst.h"
+
+using namespace std;
+
+// A Treap that can check its search, heap and parent invariants.
+class CheckedTreap : public Treap<int, int>
+{
+public:
+    bool shapeValid() const
+    {
+        return check(static_cast<TreapNode<int, int>*>(root_), nullptr);
+    }
+
+private:
+    static bool check(TreapNode<int, int>* node, TreapNode<int, int>* parent)
+    {
+        if(node == nullptr) {
+            return true;
+        }
+        TreapNode<int, int>* left = node->getLeft();
+        TreapNode<int, int>* right = node->getRight();
+        return node->getParent() == parent
+               && (left == nullptr || (left->getKey() < node->getKey() && left->getPriority() <= node->getPriority()))
+               && (right == nullptr || (node->getKey() < right->getKey() && right->getPriority() <= node->getPriority()))
+               && check(left, node) && check(right, node);
+    }
+};
+
+// Checks that a tree holds exactly the contents of expected.
+bool sameContents(const BinarySearchTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(BinarySearchTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+int main(int argc, char *argv[])
+{
+    CheckedTreap tt;
+    map<int,int> model;
+    srand(43);
+    bool ok = true;
+    for(int i = 0; i < 20000; i++) {
+        int key = rand() % 2000;
+        if(rand() % 2) {
+            tt.insert(make_pair(key, i));
+            model[key] = i;
+        }
+        else {
+            tt.remove(key);
+            model.erase(key);
+        }
+        if(i % 100 == 0) {
+            ok = ok && sameContents(tt, model) && tt.shapeValid();
+        }
+    }
+    cout << "Random updates match: " << (ok && sameContents(tt, model) && tt.shapeValid()) << endl;
+
+    // split at several points and merge back
+    ok = true;
+    for(int round = 0; round < 50; round++) {
+        int at = rand() % 2200 - 100;
+        CheckedTreap upper;
+        tt.split(at, upper);
+        map<int,int> lowerModel(model.begin(), model.lower_bound(at));
+        map<int,int> upperModel(model.lower_bound(at), model.end());
+        ok = ok && sameContents(tt, lowerModel) && sameContents(upper, upperModel)
+                && tt.shapeValid() && upper.shapeValid();
+        tt.merge(upper);
+        ok = ok && upper.empty() && sameContents(tt, model) && tt.shapeValid();
+    }
+    cout << "Split and merge: " << ok << endl;
+
+    // merging overlapping treaps is refused
+    CheckedTreap overlapping;
+    overlapping.insert(make_pair(model.begin()->first, 0));
+    bool threw = false;
+    try {
+        tt.merge(overlapping);
+    }
+    catch(invalid_argument&) {
+        threw = true;
+    }
+    cout << "Overlapping merge throws: " << (threw && sameContents(tt, model) && !overlapping.empty()) << endl;
+
+    // splitting a treap into itself is refused too
+    threw = false;
+    try {
+        tt.split(model.begin()->first, tt);
+    }
+    catch(invalid_argument&) {
+        threw = true;
+    }
+    cout << "Self split throws: " << (threw && sameContents(tt, model) && tt.shapeValid()) << endl;
+
+    // built treaps are heap ordered and keep working
+    ok = true;
+    for(int count = 0; count < 100; count += 7) {
+        vector<pair<int, int> > items;
+        model.clear();
+        for(int i = 0; i < count; i++) {
+            items.push_back(make_pair(i * 2, i));
+            model[i * 2] = i;
+        }
+        tt.buildSorted(items.begin(), items.size());
+        ok = ok && tt.shapeValid();
+        for(int i = 0; i < 50; i++) {
+            int key = rand() % 200;
+            if(i % 2) {
+                tt.remove(key);
+                model.erase(key);
+            }
+            else {
+                tt.insert(make_pair(key, i));
+                model[key] = i;
+            }
+        }
+        ok = ok && tt.shapeValid() && sameContents(tt, model);
+    }
+    cout << "Built treaps: " << ok << endl;
+
+    // erase during a scan keeps the heap order
+    ok = true;
+    for(CheckedTreap::iterator it = tt.begin(); it != tt.end(); ) {
+        if(it->first % 3 == 0) {
+            model.erase(it->first);
+            it = tt.erase(it);
+            ok = ok && tt.shapeValid();
+        }
+        else {
+            ++it;
+        }
+    }
+    cout << "Erase during scan: " << (ok && sameContents(tt, model)) << endl;
+    return 0;
+}
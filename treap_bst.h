@@ -0,0 +1,413 @@
+#ifndef TREAP_BST_H
+#define TREAP_BST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "bst.h"
+
+/**
+* A node for a treap, which adds a random priority to Node.
+*/
+template <typename Key, typename Value>
+class TreapNode : public Node<Key, Value>
+{
+public:
+    TreapNode(const Key& key, const Value& value, TreapNode<Key, Value>* parent, uint32_t priority);
+    virtual ~TreapNode();
+
+    uint32_t getPriority() const;
+
+    // Redefined to return TreapNodes, as in AVLNode.
+    virtual TreapNode<Key, Value>* getParent() const override;
+    virtual TreapNode<Key, Value>* getLeft() const override;
+    virtual TreapNode<Key, Value>* getRight() const override;
+
+protected:
+    uint32_t priority_;
+};
+
+template<class Key, class Value>
+TreapNode<Key, Value>::TreapNode(const Key& key, const Value& value, TreapNode<Key, Value>* parent, uint32_t priority) :
+    Node<Key, Value>(key, value, parent), priority_(priority)
+{
+
+}
+
+template<class Key, class Value>
+TreapNode<Key, Value>::~TreapNode()
+{
+
+}
+
+template<class Key, class Value>
+uint32_t TreapNode<Key, Value>::getPriority() const
+{
+    return priority_;
+}
+
+template<class Key, class Value>
+TreapNode<Key, Value>* TreapNode<Key, Value>::getParent() const
+{
+    return static_cast<TreapNode<Key, Value>*>(this->parent_);
+}
+
+template<class Key, class Value>
+TreapNode<Key, Value>* TreapNode<Key, Value>::getLeft() const
+{
+    return static_cast<TreapNode<Key, Value>*>(this->left_);
+}
+
+template<class Key, class Value>
+TreapNode<Key, Value>* TreapNode<Key, Value>::getRight() const
+{
+    return static_cast<TreapNode<Key, Value>*>(this->right_);
+}
+
+/**
+* A treap: a search tree on the keys that is also a max-heap on random
+* priorities, which makes its shape that of a tree built by inserting
+* the keys in random order. The expected depth is O(log n) whatever the
+* update order, and an insert or remove does fewer than two rotations on
+* average.
+*
+* split and merge cut a treap at a key and join two treaps in expected
+* O(log n), without touching the items in between.
+*/
+template <class Key, class Value>
+class Treap : public BinarySearchTree<Key, Value>
+{
+public:
+    Treap();
+    virtual void insert(const std::pair<const Key, Value>& keyValuePair);
+    virtual void remove(const Key& key);
+    void split(const Key& key, Treap<Key, Value>& greater);
+    void merge(Treap<Key, Value>& greater);
+    size_t rotations() const;
+
+protected:
+    virtual TreapNode<Key, Value>* createNode(const Key& key, const Value& value, TreapNode<Key, Value>* parent, uint32_t priority);
+    virtual Node<Key, Value>* createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels) override;
+    virtual void removeNode(Node<Key, Value>* node) override;
+
+    uint32_t nextPriority();
+    void rotateUp(TreapNode<Key, Value>* node);
+    static void splitHelper(TreapNode<Key, Value>* node, const Key& key, TreapNode<Key, Value>*& less, TreapNode<Key, Value>*& greater);
+    static TreapNode<Key, Value>* mergeHelper(TreapNode<Key, Value>* less, TreapNode<Key, Value>* greater);
+
+    uint32_t seed_;     // xorshift state for priorities
+    size_t rotations_;  // single rotations done by insert and remove, for measuring
+};
+
+template<class Key, class Value>
+Treap<Key, Value>::Treap() :
+    seed_(2463534242u),
+    rotations_(0)
+{
+
+}
+
+/**
+* Returns how many single rotations insert and remove have done so far.
+*/
+template<class Key, class Value>
+size_t Treap<Key, Value>::rotations() const
+{
+    return rotations_;
+}
+
+/**
+* Returns the next pseudo-random priority. xorshift is plenty here: the
+* priorities only need to look independent of the keys.
+*/
+template<class Key, class Value>
+uint32_t Treap<Key, Value>::nextPriority()
+{
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
+template<class Key, class Value>
+TreapNode<Key, Value>* Treap<Key, Value>::createNode(const Key& key, const Value& value, TreapNode<Key, Value>* parent, uint32_t priority)
+{
+    return new TreapNode<Key, Value>(key, value, parent, priority);
+}
+
+/**
+* Gives buildSorted nodes from createNode. A node levels above the bottom
+* gets a random priority from [1 - 2^(1-levels), 1 - 2^-levels) of the
+* range: every node outranks its children, and the share of nodes in each
+* band is the share a random priority lands in, so later inserts settle
+* as deep as they would in a treap built by inserts.
+*/
+template<class Key, class Value>
+Node<Key, Value>* Treap<Key, Value>::createBuiltNode(const std::pair<const Key, Value>& keyValuePair, int balance, int levels)
+{
+    uint32_t priority;
+    if (levels >= 32)
+    {
+        priority = UINT32_MAX;
+    }
+    else
+    {
+        uint32_t band = static_cast<uint32_t>(UINT64_C(1) << (32 - levels));
+        priority = static_cast<uint32_t>((UINT64_C(1) << 32) - 2 * static_cast<uint64_t>(band)) + nextPriority() % band;
+    }
+    return createNode(keyValuePair.first, keyValuePair.second, nullptr, priority);
+}
+
+/**
+* Rotates node above its parent.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::rotateUp(TreapNode<Key, Value>* node)
+{
+    TreapNode<Key, Value>* parent = node->getParent();
+    TreapNode<Key, Value>* grandp = parent->getParent();
+    ++rotations_;
+    if (parent->getLeft() == node)
+    {
+        TreapNode<Key, Value>* middle = node->getRight();
+        parent->setLeft(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(parent);
+        }
+        node->setRight(parent);
+    }
+    else
+    {
+        TreapNode<Key, Value>* middle = node->getLeft();
+        parent->setRight(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(parent);
+        }
+        node->setLeft(parent);
+    }
+    parent->setParent(node);
+    node->setParent(grandp);
+    if (grandp == nullptr)
+    {
+        this->root_ = node;
+    }
+    else if (grandp->getLeft() == parent)
+    {
+        grandp->setLeft(node);
+    }
+    else
+    {
+        grandp->setRight(node);
+    }
+}
+
+/*
+ * If key is already in the tree, its value is overwritten. A new node
+ * goes in as a leaf and rotates up past parents of lower priority.
+ */
+template<class Key, class Value>
+void Treap<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    TreapNode<Key, Value>* parent = nullptr;
+    TreapNode<Key, Value>* cur = static_cast<TreapNode<Key, Value>*>(this->root_);
+    while (cur != nullptr)
+    {
+        if (cur->getKey() == keyValuePair.first)
+        {
+            cur->setValue(keyValuePair.second);
+            return;
+        }
+        parent = cur;
+        cur = cur->getKey() > keyValuePair.first ? cur->getLeft() : cur->getRight();
+    }
+    TreapNode<Key, Value>* node = createNode(keyValuePair.first, keyValuePair.second, parent, nextPriority());
+    if (parent == nullptr)
+    {
+        this->root_ = node;
+        return;
+    }
+    if (parent->getKey() > keyValuePair.first)
+    {
+        parent->setLeft(node);
+    }
+    else
+    {
+        parent->setRight(node);
+    }
+    while (node->getParent() != nullptr && node->getParent()->getPriority() < node->getPriority())
+    {
+        rotateUp(node);
+    }
+}
+
+/**
+* Rotates the node down, always lifting the child of higher priority,
+* until it is a leaf or has one child, and then unlinks it.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::remove(const Key& key)
+{
+    Node<Key, Value>* node = this->internalFind(key);
+    if (node != nullptr)
+    {
+        removeNode(node);
+    }
+}
+
+/**
+* Rotates node down until it has at most one child, then unlinks and
+* frees it.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::removeNode(Node<Key, Value>* target)
+{
+    TreapNode<Key, Value>* node = static_cast<TreapNode<Key, Value>*>(target);
+    while (node->getLeft() != nullptr && node->getRight() != nullptr)
+    {
+        if (node->getLeft()->getPriority() > node->getRight()->getPriority())
+        {
+            rotateUp(node->getLeft());
+        }
+        else
+        {
+            rotateUp(node->getRight());
+        }
+    }
+    TreapNode<Key, Value>* parent = node->getParent();
+    TreapNode<Key, Value>* child = node->getLeft() != nullptr ? node->getLeft() : node->getRight();
+    if (parent == nullptr)
+    {
+        this->root_ = child;
+    }
+    else if (parent->getLeft() == node)
+    {
+        parent->setLeft(child);
+    }
+    else
+    {
+        parent->setRight(child);
+    }
+    if (child != nullptr)
+    {
+        child->setParent(parent);
+    }
+    this->destroyNode(node);
+}
+
+/**
+* Moves every item with a key greater than or equal to key into greater,
+* whose previous contents are cleared. Splitting a treap into itself
+* throws std::invalid_argument and leaves it unchanged.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::split(const Key& key, Treap<Key, Value>& greater)
+{
+    if (&greater == this)
+    {
+        throw std::invalid_argument("Cannot split a treap into itself");
+    }
+    greater.clear();
+    TreapNode<Key, Value>* less = nullptr;
+    TreapNode<Key, Value>* more = nullptr;
+    splitHelper(static_cast<TreapNode<Key, Value>*>(this->root_), key, less, more);
+    this->root_ = less;
+    greater.root_ = more;
+}
+
+/**
+* Moves every item of greater to the end of this treap, leaving greater
+* empty. Every key in greater must be larger than every key here;
+* otherwise std::invalid_argument is thrown and neither treap changes.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::merge(Treap<Key, Value>& greater)
+{
+    if (this->root_ != nullptr && greater.root_ != nullptr)
+    {
+        Node<Key, Value>* largest = this->root_;
+        while (largest->getRight() != nullptr)
+        {
+            largest = largest->getRight();
+        }
+        if (!(largest->getKey() < greater.getSmallestNode()->getKey()))
+        {
+            throw std::invalid_argument("Keys of merged treaps overlap");
+        }
+    }
+    this->root_ = mergeHelper(static_cast<TreapNode<Key, Value>*>(this->root_),
+                              static_cast<TreapNode<Key, Value>*>(greater.root_));
+    greater.root_ = nullptr;
+}
+
+/**
+* Splits the subtree at node into the treap of keys below key and the
+* treap of the rest. The results' roots get a null parent.
+*/
+template<class Key, class Value>
+void Treap<Key, Value>::splitHelper(TreapNode<Key, Value>* node, const Key& key, TreapNode<Key, Value>*& less, TreapNode<Key, Value>*& greater)
+{
+    if (node == nullptr)
+    {
+        less = nullptr;
+        greater = nullptr;
+        return;
+    }
+    node->setParent(nullptr);
+    if (node->getKey() < key)
+    {
+        TreapNode<Key, Value>* middle;
+        splitHelper(node->getRight(), key, middle, greater);
+        node->setRight(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(node);
+        }
+        less = node;
+    }
+    else
+    {
+        TreapNode<Key, Value>* middle;
+        splitHelper(node->getLeft(), key, less, middle);
+        node->setLeft(middle);
+        if (middle != nullptr)
+        {
+            middle->setParent(node);
+        }
+        greater = node;
+    }
+}
+
+/**
+* Joins two treaps whose keys do not interleave, keeping the root of
+* higher priority on top, and returns the root of the result.
+*/
+template<class Key, class Value>
+TreapNode<Key, Value>* Treap<Key, Value>::mergeHelper(TreapNode<Key, Value>* less, TreapNode<Key, Value>* greater)
+{
+    if (less == nullptr)
+    {
+        return greater;
+    }
+    if (greater == nullptr)
+    {
+        return less;
+    }
+    if (less->getPriority() > greater->getPriority())
+    {
+        TreapNode<Key, Value>* right = mergeHelper(less->getRight(), greater);
+        less->setRight(right);
+        right->setParent(less);
+        less->setParent(nullptr);
+        return less;
+    }
+    TreapNode<Key, Value>* left = mergeHelper(less, greater->getLeft());
+    greater->setLeft(left);
+    left->setParent(greater);
+    greater->setParent(nullptr);
+    return greater;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "avlbst.h"
+#include "veb_set.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// VebSet against AVLTree and std::set on 32-bit keys: inserts, lookups,
+// successor queries from stored keys (AVLTree: find then ++), predecessor
+// and successor queries from arbitrary keys (std::set: lower_bound and
+// upper_bound), and removes.
+//
+// usage: veb-bench [keys ...]    (default: 1000000)
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes;
+    for(int i = 1; i < argc; i++) {
+        sizes.push_back(strtoull(argv[i], NULL, 10));
+    }
+    if(sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    for(size_t s = 0; s < sizes.size(); s++) {
+        size_t n = sizes[s];
+        vector<uint32_t> keys = makeUniformKeys<uint32_t>(n, 0, UINT32_MAX, 1);
+        vector<uint32_t> probes = makeUniformKeys<uint32_t>(n, 0, UINT32_MAX, 2);
+        uint64_t sum = 0;
+
+        AVLTree<uint32_t, uint32_t> avl;
+        BenchTimer timer;
+        for(size_t i = 0; i < n; i++) {
+            avl.insert(make_pair(keys[i], keys[i]));
+        }
+        double insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            sum += avl.find(keys[i]) != avl.end();
+        }
+        double findSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            AVLTree<uint32_t, uint32_t>::iterator it = avl.find(keys[i]);
+            ++it;
+            sum += it != avl.end() ? it->first : 0;
+        }
+        double nextSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            avl.remove(keys[i]);
+        }
+        double removeSeconds = timer.seconds();
+        cout << n << " keys\tavl\tinsert " << insertSeconds << " s\tfind " << findSeconds
+             << " s\tfind+next " << nextSeconds << " s\tremove " << removeSeconds << " s" << endl;
+
+        set<uint32_t> tree;
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            tree.insert(keys[i]);
+        }
+        insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            sum += tree.count(keys[i]);
+        }
+        findSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            set<uint32_t>::iterator it = tree.upper_bound(probes[i]);
+            sum += it != tree.end() ? *it : 0;
+            it = tree.lower_bound(probes[i]);
+            sum += it != tree.begin() ? *--it : 0;
+        }
+        double boundSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            tree.erase(keys[i]);
+        }
+        removeSeconds = timer.seconds();
+        cout << n << " keys\tstd::set\tinsert " << insertSeconds << " s\tfind " << findSeconds
+             << " s\tsucc+pred " << boundSeconds << " s\tremove " << removeSeconds << " s" << endl;
+
+        VebSet<uint32_t> veb;
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            veb.insert(keys[i]);
+        }
+        insertSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            sum += veb.contains(keys[i]);
+        }
+        findSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            VebSet<uint32_t>::iterator it = veb.successor(keys[i]);
+            sum += it != veb.end() ? *it : 0;
+        }
+        nextSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            VebSet<uint32_t>::iterator it = veb.successor(probes[i]);
+            sum += it != veb.end() ? *it : 0;
+            it = veb.predecessor(probes[i]);
+            sum += it != veb.end() ? *it : 0;
+        }
+        boundSeconds = timer.seconds();
+        timer.restart();
+        for(size_t i = 0; i < n; i++) {
+            veb.remove(keys[i]);
+        }
+        removeSeconds = timer.seconds();
+        cout << n << " keys\tveb\tinsert " << insertSeconds << " s\tfind " << findSeconds
+             << " s\tnext " << nextSeconds << " s\tsucc+pred " << boundSeconds
+             << " s\tremove " << removeSeconds << " s" << endl;
+        benchSink(sum);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <set>
+#include <cstdlib>
+#include <cstdint>
+#include "veb_set.h"
+
+using namespace std;
+
+// Checks that a set holds exactly the contents of expected, in order,
+// both forwards and backwards.
+template<typename UInt>
+bool sameContents(const VebSet<UInt>& veb, const set<UInt>& expected)
+{
+    typename set<UInt>::const_iterator exp = expected.begin();
+    for(typename VebSet<UInt>::iterator it = veb.begin(); it != veb.end(); ++it, ++exp) {
+        if(exp == expected.end() || *it != *exp) {
+            return false;
+        }
+    }
+    typename set<UInt>::const_reverse_iterator rexp = expected.rbegin();
+    typename VebSet<UInt>::iterator it = veb.end();
+    for(size_t i = 0; i < expected.size(); i++, ++rexp) {
+        if(*--it != *rexp) {
+            return false;
+        }
+    }
+    return exp == expected.end() && veb.size() == expected.size();
+}
+
+// Checks every query for key against the model.
+template<typename UInt>
+bool sameQueries(const VebSet<UInt>& veb, const set<UInt>& expected, UInt key)
+{
+    typename set<UInt>::const_iterator after = expected.upper_bound(key);
+    typename set<UInt>::const_iterator atLeast = expected.lower_bound(key);
+    typename VebSet<UInt>::iterator succ = veb.successor(key);
+    typename VebSet<UInt>::iterator pred = veb.predecessor(key);
+    typename VebSet<UInt>::iterator lb = veb.lower_bound(key);
+    bool ok = after == expected.end() ? succ == veb.end() : (succ != veb.end() && *succ == *after);
+    ok = ok && (atLeast == expected.end() ? lb == veb.end() : (lb != veb.end() && *lb == *atLeast));
+    ok = ok && (atLeast == expected.begin() ? pred == veb.end() : (pred != veb.end() && *pred == *--atLeast));
+    return ok && veb.contains(key) == (expected.count(key) > 0)
+              && (veb.find(key) != veb.end()) == veb.contains(key);
+}
+
+// Random updates and queries with keys drawn by makeKey.
+template<typename UInt>
+bool randomUpdates(UInt (*makeKey)(), unsigned seed)
+{
+    VebSet<UInt> veb;
+    set<UInt> model;
+    srand(seed);
+    bool ok = veb.empty() && veb.begin() == veb.end();
+    for(int i = 0; i < 50000; i++) {
+        UInt key = makeKey();
+        int op = rand() % 3;
+        if(op == 0) {
+            ok = ok && veb.insert(key) == model.insert(key).second;
+        }
+        else if(op == 1) {
+            ok = ok && veb.remove(key) == (model.erase(key) > 0);
+        }
+        else {
+            ok = ok && sameQueries(veb, model, key);
+        }
+        if(i % 2000 == 0) {
+            ok = ok && sameContents(veb, model);
+        }
+    }
+    ok = ok && sameContents(veb, model);
+    while(!model.empty()) {
+        ok = ok && veb.remove(*model.begin());
+        model.erase(model.begin());
+    }
+    return ok && veb.empty() && veb.begin() == veb.end() && veb.last() == veb.end();
+}
+
+uint32_t sparseKey()
+{
+    // a few dense clusters spread over the whole 32-bit range
+    return (uint32_t(rand() % 8) << 29) | uint32_t(rand() % 3000) << (rand() % 2 ? 0 : 12);
+}
+
+uint32_t denseKey()
+{
+    return rand() % 1000;
+}
+
+uint16_t shortKey()
+{
+    return rand() % 70000;
+}
+
+uint8_t byteKey()
+{
+    return rand();
+}
+
+int main(int argc, char *argv[])
+{
+    cout << "Sparse 32-bit keys match: " << randomUpdates<uint32_t>(sparseKey, 46) << endl;
+    cout << "Dense 32-bit keys match: " << randomUpdates<uint32_t>(denseKey, 47) << endl;
+    cout << "16-bit keys match: " << randomUpdates<uint16_t>(shortKey, 48) << endl;
+    cout << "8-bit keys match: " << randomUpdates<uint8_t>(byteKey, 49) << endl;
+
+    VebSet<uint32_t> ends;
+    ends.insert(0);
+    ends.insert(UINT32_MAX);
+    cout << "Universe ends: "
+         << (*ends.begin() == 0 && *ends.successor(0) == UINT32_MAX
+             && ends.successor(UINT32_MAX) == ends.end() && ends.predecessor(0) == ends.end()
+             && *ends.predecessor(UINT32_MAX) == 0 && *--ends.end() == UINT32_MAX) << endl;
+    return 0;
+}
@@ -0,0 +1,519 @@
+#ifndef VEB_SET_H
+#define VEB_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+* One level of a van Emde Boas tree over Bits-bit values.
+*
+* A value is split into a high half, which picks a cluster, and a low
+* half, which is stored in that cluster; a summary level records which
+* clusters are non-empty. The minimum is kept here and not in any
+* cluster, so inserting into an empty cluster is O(1) and each operation
+* recurses into only one half-width level: O(log Bits) steps in all.
+* Clusters are allocated when they get their first value and freed when
+* they lose their last.
+*/
+template <int Bits>
+class VebLevel
+{
+public:
+    static const int LowBits = Bits / 2;
+    static const int HighBits = Bits - LowBits;
+    typedef VebLevel<LowBits> Cluster;
+    typedef VebLevel<HighBits> Summary;
+
+    VebLevel() : min_(1), max_(0), clusters_(nullptr)
+    {
+
+    }
+
+    ~VebLevel()
+    {
+        if (clusters_ != nullptr)
+        {
+            for (uint32_t h = 0; h < (uint32_t(1) << HighBits); ++h)
+            {
+                delete clusters_[h];
+            }
+            delete [] clusters_;
+        }
+    }
+
+    bool empty() const
+    {
+        return min_ > max_;
+    }
+    uint32_t min() const
+    {
+        return min_;
+    }
+    uint32_t max() const
+    {
+        return max_;
+    }
+
+    bool contains(uint32_t x) const;
+    bool insert(uint32_t x);
+    bool remove(uint32_t x);
+    bool successor(uint32_t x, uint32_t& next) const;
+    bool predecessor(uint32_t x, uint32_t& prev) const;
+
+private:
+    static uint32_t high(uint32_t x)
+    {
+        return x >> LowBits;
+    }
+    static uint32_t low(uint32_t x)
+    {
+        return x & ((uint32_t(1) << LowBits) - 1);
+    }
+    static uint32_t index(uint32_t h, uint32_t l)
+    {
+        return (h << LowBits) | l;
+    }
+    Cluster* cluster(uint32_t h) const
+    {
+        return clusters_ != nullptr ? clusters_[h] : nullptr;
+    }
+
+    VebLevel(const VebLevel&);
+    VebLevel& operator=(const VebLevel&);
+
+    uint32_t min_;          // min_ > max_ means empty
+    uint32_t max_;
+    Summary summary_;
+    Cluster** clusters_;    // 2^HighBits slots, allocated on first use
+};
+
+/**
+* The bottom level: 256 values as a bitmap, where every operation is a
+* few word scans.
+*/
+template <>
+class VebLevel<8>
+{
+public:
+    VebLevel()
+    {
+        std::memset(bits_, 0, sizeof(bits_));
+    }
+
+    bool empty() const
+    {
+        return (bits_[0] | bits_[1] | bits_[2] | bits_[3]) == 0;
+    }
+    uint32_t min() const
+    {
+        uint32_t next = 0;
+        scanUp(0, next);
+        return next;
+    }
+    uint32_t max() const
+    {
+        uint32_t prev = 0;
+        scanDown(255, prev);
+        return prev;
+    }
+
+    bool contains(uint32_t x) const
+    {
+        return (bits_[x >> 6] >> (x & 63)) & 1;
+    }
+    bool insert(uint32_t x)
+    {
+        bool added = !contains(x);
+        bits_[x >> 6] |= uint64_t(1) << (x & 63);
+        return added;
+    }
+    bool remove(uint32_t x)
+    {
+        bool removed = contains(x);
+        bits_[x >> 6] &= ~(uint64_t(1) << (x & 63));
+        return removed;
+    }
+    bool successor(uint32_t x, uint32_t& next) const
+    {
+        return x < 255 && scanUp(x + 1, next);
+    }
+    bool predecessor(uint32_t x, uint32_t& prev) const
+    {
+        return x > 0 && scanDown(x - 1, prev);
+    }
+
+private:
+    // the first value >= from
+    bool scanUp(uint32_t from, uint32_t& next) const
+    {
+        uint32_t word = from >> 6;
+        uint64_t bits = bits_[word] & (~uint64_t(0) << (from & 63));
+        while (bits == 0)
+        {
+            if (++word == 4)
+            {
+                return false;
+            }
+            bits = bits_[word];
+        }
+        next = (word << 6) | __builtin_ctzll(bits);
+        return true;
+    }
+    // the last value <= from
+    bool scanDown(uint32_t from, uint32_t& prev) const
+    {
+        int word = from >> 6;
+        uint64_t bits = bits_[word] & (~uint64_t(0) >> (63 - (from & 63)));
+        while (bits == 0)
+        {
+            if (--word < 0)
+            {
+                return false;
+            }
+            bits = bits_[word];
+        }
+        prev = (word << 6) | (63 - __builtin_clzll(bits));
+        return true;
+    }
+
+    VebLevel(const VebLevel&);
+    VebLevel& operator=(const VebLevel&);
+
+    uint64_t bits_[4];
+};
+
+template<int Bits>
+bool VebLevel<Bits>::contains(uint32_t x) const
+{
+    if (empty())
+    {
+        return false;
+    }
+    if (x == min_ || x == max_)
+    {
+        return true;
+    }
+    Cluster* c = cluster(high(x));
+    return c != nullptr && c->contains(low(x));
+}
+
+/*
+ * Returns false if x was already present.
+ */
+template<int Bits>
+bool VebLevel<Bits>::insert(uint32_t x)
+{
+    if (empty())
+    {
+        min_ = max_ = x;
+        return true;
+    }
+    if (x == min_)
+    {
+        return false;
+    }
+    if (x < min_)
+    {
+        // x becomes the minimum and the old minimum goes into a cluster
+        uint32_t old = min_;
+        min_ = x;
+        x = old;
+    }
+    if (clusters_ == nullptr)
+    {
+        clusters_ = new Cluster*[uint32_t(1) << HighBits]();
+    }
+    uint32_t h = high(x);
+    Cluster*& c = clusters_[h];
+    if (c == nullptr)
+    {
+        c = new Cluster();
+        summary_.insert(h);
+    }
+    if (!c->insert(low(x)))
+    {
+        return false;
+    }
+    if (x > max_)
+    {
+        max_ = x;
+    }
+    return true;
+}
+
+/*
+ * Returns false if x was not present.
+ */
+template<int Bits>
+bool VebLevel<Bits>::remove(uint32_t x)
+{
+    if (empty())
+    {
+        return false;
+    }
+    if (min_ == max_)
+    {
+        if (x != min_)
+        {
+            return false;
+        }
+        min_ = 1;
+        max_ = 0;
+        return true;
+    }
+    if (x == min_)
+    {
+        // pull the smallest clustered value up to be the new minimum
+        uint32_t h = summary_.min();
+        x = index(h, clusters_[h]->min());
+        min_ = x;
+    }
+    uint32_t h = high(x);
+    Cluster* c = cluster(h);
+    if (c == nullptr || !c->remove(low(x)))
+    {
+        return false;
+    }
+    if (c->empty())
+    {
+        delete c;
+        clusters_[h] = nullptr;
+        summary_.remove(h);
+    }
+    if (x == max_)
+    {
+        if (summary_.empty())
+        {
+            max_ = min_;
+        }
+        else
+        {
+            uint32_t last = summary_.max();
+            max_ = index(last, clusters_[last]->max());
+        }
+    }
+    return true;
+}
+
+/**
+* Finds the smallest value greater than x.
+*/
+template<int Bits>
+bool VebLevel<Bits>::successor(uint32_t x, uint32_t& next) const
+{
+    if (empty() || x >= max_)
+    {
+        return false;
+    }
+    if (x < min_)
+    {
+        next = min_;
+        return true;
+    }
+    uint32_t h = high(x);
+    Cluster* c = cluster(h);
+    uint32_t l = 0;
+    if (c != nullptr && low(x) < c->max())
+    {
+        c->successor(low(x), l);
+        next = index(h, l);
+        return true;
+    }
+    // x < max_, so some later cluster is non-empty
+    summary_.successor(h, h);
+    next = index(h, clusters_[h]->min());
+    return true;
+}
+
+/**
+* Finds the largest value less than x.
+*/
+template<int Bits>
+bool VebLevel<Bits>::predecessor(uint32_t x, uint32_t& prev) const
+{
+    if (empty() || x <= min_)
+    {
+        return false;
+    }
+    if (x > max_)
+    {
+        prev = max_;
+        return true;
+    }
+    uint32_t h = high(x);
+    Cluster* c = cluster(h);
+    uint32_t l = 0;
+    if (c != nullptr && !c->empty() && low(x) > c->min())
+    {
+        c->predecessor(low(x), l);
+        prev = index(h, l);
+        return true;
+    }
+    uint32_t before = 0;
+    if (summary_.predecessor(h, before))
+    {
+        prev = index(before, clusters_[before]->max());
+        return true;
+    }
+    prev = min_;
+    return true;
+}
+
+/**
+* An ordered set of unsigned integers of up to 32 bits, stored as a van
+* Emde Boas tree. find, insert, remove, successor and predecessor take
+* O(log log U) steps, where U is the size of the key universe (5 steps
+* for 32-bit keys), regardless of how many keys are stored.
+*
+* Iterators hold a key rather than a node, so ++ and -- are successor and
+* predecessor queries; an iterator stays valid while its key is present.
+*/
+template <typename UInt = uint32_t>
+class VebSet
+{
+public:
+    static_assert(std::is_unsigned<UInt>::value && sizeof(UInt) <= 4,
+                  "VebSet holds unsigned integers of at most 32 bits");
+
+    VebSet() : size_(0)
+    {
+
+    }
+
+    /**
+    * An iterator over the keys in ascending order.
+    */
+    class iterator
+    {
+    public:
+        iterator() : set_(nullptr), key_(0), end_(true)
+        {
+
+        }
+
+        const UInt& operator*() const
+        {
+            return key_;
+        }
+        const UInt* operator->() const
+        {
+            return &key_;
+        }
+
+        bool operator==(const iterator& rhs) const
+        {
+            return end_ == rhs.end_ && (end_ || key_ == rhs.key_);
+        }
+        bool operator!=(const iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        iterator& operator++()
+        {
+            *this = set_->successor(key_);
+            return *this;
+        }
+        /**
+        * Decrementing end() gives the largest key.
+        */
+        iterator& operator--()
+        {
+            *this = end_ ? set_->last() : set_->predecessor(key_);
+            return *this;
+        }
+
+    private:
+        friend class VebSet<UInt>;
+        iterator(const VebSet* set, UInt key, bool end) : set_(set), key_(key), end_(end)
+        {
+
+        }
+
+        const VebSet* set_;
+        UInt key_;
+        bool end_;
+    };
+
+    bool insert(UInt key)
+    {
+        bool added = levels_.insert(key);
+        size_ += added;
+        return added;
+    }
+    bool remove(UInt key)
+    {
+        bool removed = levels_.remove(key);
+        size_ -= removed;
+        return removed;
+    }
+    bool contains(UInt key) const
+    {
+        return levels_.contains(key);
+    }
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+    size_t size() const
+    {
+        return size_;
+    }
+
+    iterator begin() const
+    {
+        return empty() ? end() : at(levels_.min());
+    }
+    iterator end() const
+    {
+        return iterator(this, 0, true);
+    }
+    iterator last() const
+    {
+        return empty() ? end() : at(levels_.max());
+    }
+    iterator find(UInt key) const
+    {
+        return contains(key) ? at(key) : end();
+    }
+
+    /**
+    * Returns an iterator to the smallest key greater than key, or end().
+    */
+    iterator successor(UInt key) const
+    {
+        uint32_t next = 0;
+        return levels_.successor(key, next) ? at(next) : end();
+    }
+    /**
+    * Returns an iterator to the largest key less than key, or end().
+    */
+    iterator predecessor(UInt key) const
+    {
+        uint32_t prev = 0;
+        return levels_.predecessor(key, prev) ? at(prev) : end();
+    }
+    /**
+    * Returns an iterator to the first key not less than key.
+    */
+    iterator lower_bound(UInt key) const
+    {
+        return contains(key) ? at(key) : successor(key);
+    }
+
+private:
+    iterator at(uint32_t key) const
+    {
+        return iterator(this, static_cast<UInt>(key), false);
+    }
+
+    VebSet(const VebSet&);
+    VebSet& operator=(const VebSet&);
+
+    VebLevel<sizeof(UInt) * 8> levels_;
+    size_t size_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "wal_avlbst.h"
+#include "bench_utils.h"
+
+using namespace std;
+
+// Durable insert throughput when every insert is committed, by thread
+// count (group commit lets threads share fdatasyncs), and the time to
+// recover a tree from its log against inserting the same keys.
+//
+// usage: wal-bench [keys]    (default: 1000000)
+// Files are written to wal-bench.tmp.* in the current directory.
+
+void removeFiles(const string& path)
+{
+    remove((path + ".wal").c_str());
+    remove((path + ".ckpt").c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    const string path = "wal-bench.tmp";
+    size_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+
+    const int commitsPerThread = 2000;
+    for(int threads = 1; threads <= 8; threads *= 2) {
+        removeFiles(path);
+        DurableAVLTree<uint64_t, uint64_t> tree(path);
+        BenchTimer timer;
+        vector<thread> workers;
+        for(int t = 0; t < threads; t++) {
+            workers.push_back(thread([&tree, t]() {
+                for(uint64_t i = 0; i < commitsPerThread; i++) {
+                    tree.insert(make_pair(t * commitsPerThread + i, i));
+                    tree.commit();
+                }
+            }));
+        }
+        for(size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        double seconds = timer.seconds();
+        cout << threads << " threads\t" << threads * commitsPerThread / seconds << " committed inserts/s" << endl;
+    }
+
+    removeFiles(path);
+    vector<uint64_t> keys = makeShuffledKeys<uint64_t>(count, 1);
+    double insertSeconds;
+    {
+        // no checkpoint, so that everything has to come from the log
+        DurableAVLTree<uint64_t, uint64_t> tree(path, SIZE_MAX);
+        BenchTimer timer;
+        for(size_t i = 0; i < keys.size(); i++) {
+            tree.insert(make_pair(keys[i], keys[i]));
+        }
+        insertSeconds = timer.seconds();
+    }
+    BenchTimer timer;
+    DurableAVLTree<uint64_t, uint64_t> recovered(path);
+    double recoverSeconds = timer.seconds();
+    benchSink(recovered.empty());
+    cout << count << " keys\tlogged insert " << insertSeconds << " s"
+         << "\trecover from log " << recoverSeconds << " s" << endl;
+    removeFiles(path);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "wal_avlbst.h"
+
+using namespace std;
+
+// Checks that a DurableAVLTree holds exactly the contents of expected.
+bool sameContents(const DurableAVLTree<int, int>& tree, const map<int, int>& expected)
+{
+    map<int, int>::const_iterator exp = expected.begin();
+    for(DurableAVLTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it, ++exp) {
+        if(exp == expected.end() || it->first != exp->first || it->second != exp->second) {
+            return false;
+        }
+    }
+    return exp == expected.end();
+}
+
+void removeFiles(const string& path)
+{
+    remove((path + ".wal").c_str());
+    remove((path + ".ckpt").c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    const string path = "wal-test.tmp";
+    removeFiles(path);
+    map<int,int> model;
+    srand(108);
+    {
+        DurableAVLTree<int,int> dt(path);
+        for(int i = 0; i < 3000; i++) {
+            int key = rand() % 1000;
+            if(i % 3 == 0) {
+                dt.remove(key);
+                model.erase(key);
+            }
+            else {
+                dt.insert(make_pair(key, i));
+                model[key] = i;
+            }
+            if(i % 100 == 0) {
+                dt.commit();
+            }
+        }
+    }
+    {
+        DurableAVLTree<int,int> dt(path);
+        cout << "Log replay matches: " << sameContents(dt, model) << endl;
+    }
+
+    // a record torn by a crash is dropped, and later records still work
+    {
+        ofstream log((path + ".wal").c_str(), ios::binary | ios::app);
+        log.write("\x20\x00\x00\x00I\x01", 6);
+    }
+    {
+        DurableAVLTree<int,int> dt(path);
+        bool same = sameContents(dt, model);
+        dt.insert(make_pair(-5, 5));
+        model[-5] = 5;
+        dt.commit();
+        cout << "Torn record ignored: " << same << endl;
+    }
+    {
+        DurableAVLTree<int,int> dt(path);
+        cout << "Appends after repair: " << sameContents(dt, model) << endl;
+    }
+
+    // a tiny threshold forces a checkpoint every few commits
+    {
+        DurableAVLTree<int,int> dt(path, 256);
+        for(int i = 0; i < 2000; i++) {
+            int key = rand() % 1000;
+            dt.insert(make_pair(key, -i));
+            model[key] = -i;
+            if(i % 10 == 0) {
+                dt.commit();
+            }
+        }
+        dt.checkpoint();
+        dt.remove(model.begin()->first);
+        model.erase(model.begin());
+    }
+    {
+        DurableAVLTree<int,int> dt(path);
+        cout << "Checkpoint and log match: " << sameContents(dt, model) << endl;
+    }
+
+    // group commit from several threads
+    removeFiles(path);
+    {
+        DurableAVLTree<int,int> dt(path);
+        vector<thread> threads;
+        for(int t = 0; t < 4; t++) {
+            threads.push_back(thread([&dt, t]() {
+                for(int i = 0; i < 200; i++) {
+                    dt.insert(make_pair(t * 1000 + i, i));
+                    dt.commit();
+                }
+            }));
+        }
+        for(size_t t = 0; t < threads.size(); t++) {
+            threads[t].join();
+        }
+    }
+    {
+        DurableAVLTree<int,int> dt(path);
+        int count = 0;
+        for(DurableAVLTree<int,int>::iterator it = dt.begin(); it != dt.end(); ++it) {
+            count++;
+        }
+        cout << "Concurrent commits kept: " << (count == 800 && dt[3199] == 199) << endl;
+    }
+    removeFiles(path);
+    return 0;
+}
@@ -0,0 +1,531 @@
+#ifndef WAL_AVLBST_H
+#define WAL_AVLBST_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "avlbst.h"
+#include "serialize_bst.h"
+
+/**
+* An AVLTree whose mutations are recorded in a write-ahead log, so that
+* its contents survive a crash.
+*
+* State lives in two files next to path: path.ckpt, a checkpoint of the
+* whole tree in the writeTree format, and path.wal, the log of every
+* insert and remove since. Each mutation appends a checksummed record to
+* an in-memory log buffer and then applies it to the tree. commit() makes
+* everything done so far durable; concurrent callers share one write and
+* one fdatasync (group commit), and the thread that finds no flush in
+* progress does it for everyone waiting. Nothing is durable until a
+* commit covers it.
+*
+* When the log outgrows checkpointBytes, a commit writes a new checkpoint
+* and empties the log. Opening the tree recovers its state: the
+* checkpoint is loaded with readTree, the log's operations are sorted
+* (the last one per key wins), and both are merged into one buildSorted,
+* so replay costs a sort and a linear build rather than an insert per
+* record. A record torn by a crash ends the replay.
+*
+* All operations are safe to call from several threads. Iterating is not
+* synchronized with writers: only iterate while no thread is modifying
+* the tree.
+*/
+template <class Key, class Value, class KeyCodec = Codec<Key>, class ValueCodec = Codec<Value> >
+class DurableAVLTree
+{
+public:
+    explicit DurableAVLTree(const std::string& path, size_t checkpointBytes = 64 << 20);
+    ~DurableAVLTree();
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void commit();
+    void checkpoint();
+
+    bool find(const Key& key, Value& value) const;
+    bool contains(const Key& key) const;
+    Value operator[](const Key& key) const;
+    bool empty() const;
+
+    typedef typename AVLTree<Key, Value>::iterator iterator;
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    enum RecordType { INSERT_RECORD = 'I', REMOVE_RECORD = 'R' };
+
+    struct Operation
+    {
+        Key key_;
+        Value value_;
+        bool insert_;
+    };
+
+    DurableAVLTree(const DurableAVLTree&);
+    DurableAVLTree& operator=(const DurableAVLTree&);
+
+    static uint32_t checksum(const char* data, size_t length);
+    static bool earlierKey(const Operation& a, const Operation& b);
+
+    void append(char type, const Key& key, const Value* value);
+    bool writeLog(const std::string& batch, size_t goodBytes);
+    void syncDirectory();
+    void recover();
+    void replay(std::vector<Operation>& log);
+    void writeCheckpoint();
+
+    std::string path_;
+    size_t checkpointBytes_;
+    int fd_;
+
+    mutable std::mutex lock_;           // guards everything below
+    std::condition_variable flushed_;
+    AVLTree<Key, Value> tree_;
+    std::string pending_;               // log records not yet written
+    uint64_t appended_;                 // records appended so far
+    uint64_t durable_;                  // records known to be on disk
+    bool flushing_;
+    size_t logBytes_;                   // size of the log file
+    bool logTorn_;                      // a failed write may have left bytes past logBytes_
+};
+
+/**
+* Opens (creating if needed) the tree stored at path and recovers its
+* contents. Throws std::runtime_error if the files cannot be used.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::DurableAVLTree(const std::string& path, size_t checkpointBytes) :
+    path_(path),
+    checkpointBytes_(checkpointBytes),
+    fd_(-1),
+    appended_(0),
+    durable_(0),
+    flushing_(false),
+    logBytes_(0),
+    logTorn_(false)
+{
+    recover();
+    fd_ = ::open((path_ + ".wal").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0)
+    {
+        throw std::runtime_error("Cannot open " + path_ + ".wal");
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) == 0)
+    {
+        logBytes_ = info.st_size;
+    }
+}
+
+/**
+* Commits whatever is still pending before closing the log.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::~DurableAVLTree()
+{
+    try
+    {
+        commit();
+    }
+    catch (...)
+    {
+        // the records are lost, as in a crash
+    }
+    ::close(fd_);
+}
+
+/**
+* FNV-1a, to recognize a record torn by a crash.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+uint32_t DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::checksum(const char* data, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+* Appends one record to pending_: a 32-bit body length, the body (type,
+* key and, for inserts, value) and a checksum of the body.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::append(char type, const Key& key, const Value* value)
+{
+    size_t start = pending_.size();
+    Codec<uint32_t>::encode(0, pending_);
+    pending_.push_back(type);
+    KeyCodec::encode(key, pending_);
+    if (value != nullptr)
+    {
+        ValueCodec::encode(*value, pending_);
+    }
+    size_t body = start + sizeof(uint32_t);
+    uint32_t length = static_cast<uint32_t>(pending_.size() - body);
+    std::memcpy(&pending_[start], &length, sizeof(length));
+    Codec<uint32_t>::encode(checksum(pending_.data() + body, length), pending_);
+    ++appended_;
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::insert(const std::pair<const Key, Value>& keyValuePair)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    append(INSERT_RECORD, keyValuePair.first, &keyValuePair.second);
+    tree_.insert(keyValuePair);
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::remove(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    append(REMOVE_RECORD, key, nullptr);
+    tree_.remove(key);
+}
+
+/**
+* Returns once every mutation made before the call is on disk. One caller
+* at a time writes out all pending records with a single write and
+* fdatasync; callers arriving meanwhile wait for it and are usually
+* covered by its flush or the next one. Throws std::runtime_error if
+* the log cannot be written.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::commit()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    uint64_t target = appended_;
+    while (durable_ < target)
+    {
+        if (flushing_)
+        {
+            flushed_.wait(lock);
+            continue;
+        }
+        flushing_ = true;
+        std::string batch;
+        batch.swap(pending_);
+        uint64_t upTo = appended_;
+        lock.unlock();
+
+        bool ok = writeLog(batch, logBytes_);
+
+        lock.lock();
+        flushing_ = false;
+        flushed_.notify_all();
+        if (!ok)
+        {
+            // keep the records for the next attempt
+            pending_.insert(0, batch);
+            throw std::runtime_error("Cannot write " + path_ + ".wal");
+        }
+        durable_ = upTo;
+        logBytes_ += batch.size();
+    }
+    if (logBytes_ > checkpointBytes_ && !flushing_)
+    {
+        writeCheckpoint();
+    }
+}
+
+/**
+* Appends batch to the log and syncs it. Called by the one thread that is
+* flushing, so nobody else touches the log meanwhile; goodBytes is the
+* log's length before the batch. A failed or short write may leave part
+* of the batch behind, which replay would take for a torn record and
+* stop at, hiding whatever comes after. So on failure the log is cut
+* back to goodBytes, and if even that fails the next call tries again
+* before writing anything. Returns whether the batch is durable.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+bool DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::writeLog(const std::string& batch, size_t goodBytes)
+{
+    if (logTorn_)
+    {
+        if (::ftruncate(fd_, goodBytes) != 0)
+        {
+            return false;
+        }
+        logTorn_ = false;
+    }
+    bool ok = true;
+    for (size_t done = 0; ok && done < batch.size(); )
+    {
+        ssize_t wrote = ::write(fd_, batch.data() + done, batch.size() - done);
+        ok = wrote > 0;
+        done += ok ? wrote : 0;
+    }
+    ok = ok && ::fdatasync(fd_) == 0;
+    if (!ok)
+    {
+        logTorn_ = ::ftruncate(fd_, goodBytes) != 0;
+    }
+    return ok;
+}
+
+/**
+* Makes a rename in the directory holding path_ durable.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::syncDirectory()
+{
+    size_t slash = path_.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : path_.substr(0, slash + 1);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    bool ok = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    if (!ok)
+    {
+        throw std::runtime_error("Cannot sync the directory of " + path_);
+    }
+}
+
+/**
+* Writes a checkpoint of the current contents and empties the log.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::checkpoint()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    while (flushing_)
+    {
+        flushed_.wait(lock);
+    }
+    writeCheckpoint();
+}
+
+/**
+* Called with lock_ held and no flush running. Pending records are
+* written to the log first, so that the log holds every mutation the
+* checkpoint covers. The checkpoint is then written to a temporary file,
+* synced, renamed over the old one and the rename synced, so a crash
+* leaves either checkpoint intact. Only after that is the log emptied.
+* If we crash before it is, replay applies the whole log again on top of
+* a checkpoint that already holds its effects; since the log is complete,
+* the last record of every key it names matches the checkpoint, which
+* gives the same result.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::writeCheckpoint()
+{
+    if (!pending_.empty())
+    {
+        if (!writeLog(pending_, logBytes_))
+        {
+            throw std::runtime_error("Cannot write " + path_ + ".wal");
+        }
+        logBytes_ += pending_.size();
+        pending_.clear();
+    }
+    durable_ = appended_;
+    flushed_.notify_all();
+
+    std::string temporary = path_ + ".ckpt.tmp";
+    {
+        std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        writeTree<Key, Value, KeyCodec, ValueCodec>(tree_, out);
+    }
+    int fd = ::open(temporary.c_str(), O_RDONLY);
+    bool ok = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    ok = ok && std::rename(temporary.c_str(), (path_ + ".ckpt").c_str()) == 0;
+    if (!ok)
+    {
+        throw std::runtime_error("Cannot write checkpoint " + path_ + ".ckpt");
+    }
+    syncDirectory();
+    if (::ftruncate(fd_, 0) != 0 || ::fdatasync(fd_) != 0)
+    {
+        throw std::runtime_error("Cannot empty " + path_ + ".wal");
+    }
+    logBytes_ = 0;
+    logTorn_ = false;
+}
+
+/**
+* Loads the checkpoint and replays the log over it.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::recover()
+{
+    std::ifstream checkpointFile((path_ + ".ckpt").c_str(), std::ios::binary);
+    if (checkpointFile)
+    {
+        readTree<Key, Value, KeyCodec, ValueCodec>(checkpointFile, tree_);
+    }
+
+    std::ifstream logFile((path_ + ".wal").c_str(), std::ios::binary);
+    if (!logFile)
+    {
+        return;
+    }
+    std::string log((std::istreambuf_iterator<char>(logFile)), std::istreambuf_iterator<char>());
+    std::vector<Operation> operations;
+    size_t pos = 0;
+    while (log.size() - pos >= 2 * sizeof(uint32_t) + 1)
+    {
+        const char* data = log.data() + pos;
+        uint32_t length;
+        Codec<uint32_t>::decode(data, data + sizeof(uint32_t), length);
+        if (length == 0 || log.size() - pos - 2 * sizeof(uint32_t) < length)
+        {
+            break;
+        }
+        const char* end = data + length;
+        uint32_t sum;
+        const char* sumData = end;
+        Codec<uint32_t>::decode(sumData, sumData + sizeof(uint32_t), sum);
+        if (sum != checksum(data, length))
+        {
+            break;
+        }
+        Operation operation;
+        operation.insert_ = *data++ == INSERT_RECORD;
+        if (!KeyCodec::decode(data, end, operation.key_) ||
+            (operation.insert_ && !ValueCodec::decode(data, end, operation.value_)) ||
+            data != end)
+        {
+            break;
+        }
+        operations.push_back(operation);
+        pos += 2 * sizeof(uint32_t) + length;
+    }
+    if (pos != log.size())
+    {
+        // drop the torn tail, so that new records follow the last good one
+        if (::truncate((path_ + ".wal").c_str(), pos) != 0)
+        {
+            throw std::runtime_error("Cannot repair " + path_ + ".wal");
+        }
+    }
+    replay(operations);
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+bool DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::earlierKey(const Operation& a, const Operation& b)
+{
+    return a.key_ < b.key_;
+}
+
+/**
+* Merges the logged operations into the tree. Sorting is stable, so the
+* last operation of each run of equal keys is the one that counts.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+void DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::replay(std::vector<Operation>& log)
+{
+    if (log.empty())
+    {
+        return;
+    }
+    std::stable_sort(log.begin(), log.end(), &earlierKey);
+
+    std::vector<std::pair<Key, Value> > merged;
+    typename AVLTree<Key, Value>::iterator it = tree_.begin();
+    for (size_t i = 0; i < log.size(); ++i)
+    {
+        if (i + 1 < log.size() && !(log[i].key_ < log[i + 1].key_))
+        {
+            continue;
+        }
+        for (; it != tree_.end() && it->first < log[i].key_; ++it)
+        {
+            merged.push_back(*it);
+        }
+        if (it != tree_.end() && !(log[i].key_ < it->first))
+        {
+            ++it;
+        }
+        if (log[i].insert_)
+        {
+            merged.push_back(std::make_pair(log[i].key_, log[i].value_));
+        }
+    }
+    for (; it != tree_.end(); ++it)
+    {
+        merged.push_back(*it);
+    }
+    tree_.buildSorted(merged.begin(), merged.size());
+}
+
+/**
+* Copies the value stored under key into value and returns true,
+* or returns false if the key is not in the tree.
+*/
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+bool DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::find(const Key& key, Value& value) const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    iterator it = tree_.find(key);
+    if (it == tree_.end())
+    {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+bool DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::contains(const Key& key) const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return tree_.find(key) != tree_.end();
+}
+
+/**
+ * @precondition The key exists in the tree
+ * Returns a copy of the value associated with the key
+ */
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+Value DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::operator[](const Key& key) const
+{
+    Value value;
+    if(!find(key, value)) throw std::out_of_range("Invalid key");
+    return value;
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+bool DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::empty() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return tree_.empty();
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+typename DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::iterator
+DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::begin() const
+{
+    return tree_.begin();
+}
+
+template<class Key, class Value, class KeyCodec, class ValueCodec>
+typename DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::iterator
+DurableAVLTree<Key, Value, KeyCodec, ValueCodec>::end() const
+{
+    return tree_.end();
+}
+
+#endif